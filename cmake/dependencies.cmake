@@ -18,3 +18,6 @@ endif()
 
 hunter_add_package(fmt)
 find_package(fmt CONFIG REQUIRED)
+
+hunter_add_package(ZLIB)
+find_package(ZLIB REQUIRED)
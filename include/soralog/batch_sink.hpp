@@ -0,0 +1,209 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/flush_combiner.hpp>
+#include <soralog/redactor.hpp>
+#include <soralog/sink.hpp>
+#include <soralog/sink_scheduler.hpp>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace soralog {
+
+  /**
+   * @class BatchSink
+   * Base class of sinks, which write events out by batches.
+   * It owns worker thread, scheduling of flushes and batching, so derived
+   * class has just to write out provided batch of events.
+   * Derived class must call start() at the end of its constructor and stop()
+   * at the beginning of its destructor, because worker calls its methods.
+   * If sink is created as worker-only, events are written by worker only:
+   * other threads calling flush just wake it up and wait for it.
+   * Idle worker sleeps without deadline; the first event pushed after that
+   * wakes it up and arms deadline of flush.
+   * If sink is created as polled, it has no worker at all: events are
+   * written by application calling poll() (e.g. from its event loop).
+   * If sink is created while executor is set (see Executor::Scope), flushes
+   * are scheduled on that executor instead of own worker thread.
+   */
+  class BatchSink : public Sink {
+   public:
+    using EventRef = CircularBuffer<Event>::NodeRef;
+
+    /**
+     * Read-only view of captured events; it's valid during write() only.
+     * Events are in order they are captured, i.e. the same as with
+     * one-by-one processing
+     */
+    class Batch final {
+     public:
+      Batch(const EventRef *begin, const EventRef *end) noexcept
+          : begin_(begin), end_(end) {}
+
+      const EventRef *begin() const noexcept {
+        return begin_;
+      }
+      const EventRef *end() const noexcept {
+        return end_;
+      }
+      size_t size() const noexcept {
+        return end_ - begin_;
+      }
+      bool empty() const noexcept {
+        return begin_ == end_;
+      }
+      const EventRef &operator[](size_t index) const noexcept {
+        return begin_[index];  // NOLINT
+      }
+
+     private:
+      const EventRef *begin_;
+      const EventRef *end_;
+    };
+
+    /// Rendered record of event except message itself is not longer than it
+    static constexpr size_t max_record_overhead = 256;
+
+    BatchSink() = delete;
+    BatchSink(BatchSink &&) noexcept = delete;
+    BatchSink(const BatchSink &) = delete;
+    BatchSink &operator=(BatchSink &&) noexcept = delete;
+    BatchSink &operator=(const BatchSink &) = delete;
+    ~BatchSink() override;
+
+    BatchSink(std::string name,
+              Level level,
+              ThreadInfoType thread_info_type,
+              size_t max_events,
+              size_t max_message_length,
+              size_t max_buffer_size,
+              size_t latency,
+              bool with_sequence,
+              size_t shards = default_shards,
+              bool worker_only = false,
+              bool polled = false);
+
+    void flush() noexcept final;
+
+    /**
+     * Writes out up to {@param budget} events, if sink is polled and flush
+     * is due: deadline armed by the first event after idle has passed, or
+     * flush is requested (by urgent event, filled buffer, rotation, etc.).
+     * Doesn't wait for other thread writing out events of this sink
+     * @returns number of written events
+     */
+    size_t poll(size_t budget) noexcept final;
+
+    void rotate() noexcept final;
+
+    /**
+     * Sets {@param redactor} masking secrets in messages before they are
+     * written out; it's applied since next batch. Empty pointer disables it
+     */
+    void setRedactor(std::shared_ptr<const Redactor> redactor) noexcept;
+
+   protected:
+    void async_flush() noexcept final;
+
+    void wakeUp() noexcept final;
+
+    /**
+     * Starts worker (if sink is asynchronous), or takes current executor
+     */
+    void start();
+
+    /**
+     * Writes out all remaining events and stops worker
+     */
+    void stop() noexcept;
+
+    /**
+     * @returns redactor for current batch, if any. Valid during write() only
+     */
+    const Redactor *redactor() const noexcept {
+      return batch_redactor_.get();
+    }
+
+    /**
+     * Masks secrets in rendered message from {@param begin} to {@param end},
+     * if redactor is set
+     */
+    void redact(char *begin, char *end) const noexcept {
+      if (batch_redactor_) {
+        batch_redactor_->redact(begin, end);
+      }
+    }
+
+    /**
+     * Writes out {@param events}. Rendered records of all of them are fit
+     * into {@param buffer} (its size is at least number of events multiplied
+     * by max_message_length_ + max_record_overhead).
+     * Called by one thread at once
+     */
+    virtual void write(const Batch &events, std::vector<char> &buffer) = 0;
+
+    /**
+     * Pushes written data to destination when flush is requested explicitly
+     */
+    virtual void sync() noexcept {}
+
+    /**
+     * Does actions to rotate destination (e.g. reopen file)
+     */
+    virtual void reopen() noexcept {}
+
+   private:
+    /**
+     * Requests flush from worker and waits for it to finish one
+     */
+    void flushByWorker() noexcept;
+
+    /**
+     * Writes out up to {@param budget} events by batches. Called by one
+     * thread at once (see combiner_)
+     * @returns number of written events
+     */
+    size_t drain(size_t budget) noexcept;
+
+    /**
+     * @returns time of next flush by worker; sink without events parks
+     */
+    std::chrono::steady_clock::time_point nextFlush() noexcept;
+
+    const size_t max_batch_size_;
+    const bool worker_only_;
+    const bool polled_;
+
+    // Worker, or tasks of executor, which flush events in background
+    SinkScheduler scheduler_;
+
+    std::vector<char> buff_;
+    std::vector<EventRef> batch_;
+
+    // Accessed by std::atomic_load/std::atomic_store
+    std::shared_ptr<const Redactor> redactor_;
+    std::shared_ptr<const Redactor> batch_redactor_;
+
+    std::atomic_bool need_to_flush_ = false;
+    std::atomic_bool need_to_rotate_ = false;
+    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
+        std::chrono::steady_clock::time_point();
+    FlushCombiner combiner_;
+
+    // Threads waiting for flush by worker (see flushByWorker())
+    std::mutex flushes_mutex_;
+    std::condition_variable flushes_condvar_;
+    uint64_t flushes_ = 0;           // guarded by flushes_mutex_
+    bool need_to_finalize_ = false;  // guarded by flushes_mutex_
+  };
+
+}  // namespace soralog
@@ -0,0 +1,284 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/circular_buffer.hpp>
+
+#include <memory>
+
+namespace soralog {
+
+  /**
+   * @class BroadcastBuffer
+   * Circular buffer with several independent consumers. Each item is put
+   * once, and each consumer reads all of them by own cursor. Place of item
+   * is reclaimed when the slowest consumer releases it.
+   */
+  template <typename T>
+  class BroadcastBuffer final {
+   public:
+    using Node = typename CircularBuffer<T>::Node;
+    using NodeRef = typename CircularBuffer<T>::NodeRef;
+
+    /**
+     * Behaviour of producer when the slowest consumer does not release place
+     * for new item yet
+     */
+    enum class LagPolicy : uint8_t {
+      BLOCK,   //!< Wait for consumer
+      DROP,    //!< Drop new item
+      DETACH,  //!< Detach lagging consumer; it doesn't get items anymore
+    };
+
+    BroadcastBuffer() = delete;
+    BroadcastBuffer(BroadcastBuffer &&) noexcept = delete;
+    BroadcastBuffer(const BroadcastBuffer &) = delete;
+    ~BroadcastBuffer() = default;
+    BroadcastBuffer &operator=(BroadcastBuffer &&) noexcept = delete;
+    BroadcastBuffer &operator=(const BroadcastBuffer &) = delete;
+
+    BroadcastBuffer(size_t capacity,
+                    size_t padding,
+                    size_t consumers,
+                    LagPolicy policy)
+        : capacity_(capacity),
+          element_size_([&] {
+            const auto alignment = std::alignment_of_v<Node>;
+            if (auto offset = padding % alignment) {
+              padding += alignment - offset;
+            }
+            return sizeof(Node) + padding;
+          }()),
+          policy_(policy),
+          raw_data_(capacity_ * element_size_),
+          // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+          published_(std::make_unique<std::atomic<uint64_t>[]>(capacity_)),
+          consumers_(consumers) {
+      for (auto index = 0; index < capacity; ++index) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        new (raw_data_.data() + element_size_ * index) Node;
+      }
+    }
+
+    size_t capacity() const noexcept {
+      return capacity_;
+    }
+
+    LagPolicy policy() const noexcept {
+      return policy_;
+    }
+
+    /**
+     * @returns number of consumers (including detached ones)
+     */
+    size_t consumers() const noexcept {
+      return consumers_.size();
+    }
+
+    /**
+     * @returns sequence number of last put item, i.e. total number of them
+     */
+    uint64_t lastSequence() const noexcept {
+      lock();
+      auto ret = push_position_;
+      unlock();
+      return ret;
+    }
+
+    /**
+     * @returns number of items dropped due to lagging consumer
+     */
+    size_t dropped() const noexcept {
+      return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @returns number of items which are put, but not read by the slowest
+     * attached consumer yet
+     */
+    size_t size() const noexcept {
+      lock();
+      size_t ret = 0;
+      for (const auto &consumer : consumers_) {
+        if (not consumer.detached) {
+          ret = std::max<size_t>(ret, push_position_ - consumer.position);
+        }
+      }
+      unlock();
+      return ret;
+    }
+
+    /**
+     * @returns number of items which are not read by {@param consumer} yet
+     */
+    size_t pending(size_t consumer) const noexcept(IF_RELEASE) {
+      assert(consumer < consumers_.size());
+      lock();
+      const auto &cursor = consumers_[consumer];
+      auto ret = cursor.detached ? 0 : push_position_ - cursor.position;
+      unlock();
+      return ret;
+    }
+
+    /**
+     * @returns true if {@param consumer} was detached due to lagging
+     */
+    bool isDetached(size_t consumer) const noexcept(IF_RELEASE) {
+      assert(consumer < consumers_.size());
+      lock();
+      auto ret = consumers_[consumer].detached;
+      unlock();
+      return ret;
+    }
+
+    /**
+     * Detaches {@param consumer}; it doesn't get items anymore and doesn't
+     * hold place of them
+     */
+    void detach(size_t consumer) noexcept(IF_RELEASE) {
+      assert(consumer < consumers_.size());
+      lock();
+      auto &cursor = consumers_[consumer];
+      if (not cursor.detached) {
+        for (auto i = cursor.position; i < push_position_; ++i) {
+          nodeAt(i).release();
+        }
+        cursor.detached = true;
+        --attached_;
+      }
+      unlock();
+    }
+
+    /**
+     * Puts new item. Producer holds it until returned reference is released.
+     * @returns empty reference if there is no place (accordingly policy)
+     */
+    template <typename... Args>
+    [[nodiscard]] NodeRef put(Args &&...args) noexcept(IF_RELEASE) {
+      lock();
+
+      auto &node = nodeAt(push_position_);
+
+      // Reclaim place held by lagging consumers
+      if (node.holders.load(std::memory_order_acquire) != 0
+          and policy_ == LagPolicy::DETACH and push_position_ >= capacity_) {
+        detachLagging(push_position_ - capacity_);
+      }
+
+      uint32_t free = 0;
+      if (not node.holders.compare_exchange_strong(
+              free,
+              attached_ + 1,  // producer is holding until item is emplaced
+              std::memory_order_acquire,
+              std::memory_order_relaxed)) {
+        unlock();
+        if (policy_ == LagPolicy::DROP) {
+          dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        return {};
+      }
+
+      // Claim index of item is its number as well
+      const auto position = push_position_++;
+      node.sequence = position + 1;
+
+      unlock();
+
+      // Emplace item and publish it for consumers
+      node.init(std::forward<Args>(args)...);
+      published_[position % capacity_].store(position + 1,
+                                             std::memory_order_release);
+
+      return NodeRef(node);
+    }
+
+    /**
+     * Takes next item for {@param consumer}; consumer holds it until returned
+     * reference is released
+     * @returns empty reference if there is no item ready to read
+     */
+    NodeRef get(size_t consumer) noexcept(IF_RELEASE) {
+      assert(consumer < consumers_.size());
+      lock();
+
+      auto &cursor = consumers_[consumer];
+      if (cursor.detached or cursor.position == push_position_) {
+        unlock();
+        return {};
+      }
+
+      // Item is not emplaced yet
+      if (published_[cursor.position % capacity_].load(
+              std::memory_order_acquire)
+          != cursor.position + 1) {
+        unlock();
+        return {};
+      }
+
+      auto &node = nodeAt(cursor.position++);
+
+      unlock();
+
+      // Consumer's hold was counted, when item was put
+      return NodeRef(node);
+    }
+
+   private:
+    struct Cursor {
+      uint64_t position = 0;
+      bool detached = false;
+    };
+
+    void lock() const noexcept {
+      while (busy_.test_and_set(std::memory_order_acquire)) {
+        continue;
+      }
+    }
+
+    void unlock() const noexcept {
+      busy_.clear(std::memory_order_release);
+    }
+
+    Node &nodeAt(uint64_t position) noexcept {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      return *reinterpret_cast<Node *>(
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+          raw_data_.data() + element_size_ * (position % capacity_));
+    }
+
+    /**
+     * Detaches consumers which didn't read item at {@param position} yet, and
+     * releases their holds of unread items. Must be called under lock
+     */
+    void detachLagging(uint64_t position) noexcept {
+      for (auto &cursor : consumers_) {
+        if (cursor.detached or cursor.position > position) {
+          continue;
+        }
+        for (auto i = cursor.position; i < push_position_; ++i) {
+          nodeAt(i).release();
+        }
+        cursor.detached = true;
+        --attached_;
+      }
+    }
+
+    const size_t capacity_;
+    const size_t element_size_;
+    const LagPolicy policy_;
+    std::vector<std::byte> raw_data_;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+    std::unique_ptr<std::atomic<uint64_t>[]> published_;
+    std::vector<Cursor> consumers_;
+    uint32_t attached_ = consumers_.size();
+    uint64_t push_position_ = 0;
+    std::atomic_size_t dropped_ = 0;
+    mutable std::atomic_flag busy_ = false;
+  };
+
+}  // namespace soralog
@@ -10,7 +10,9 @@
 #include <atomic>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #ifdef NDEBUG
@@ -37,8 +39,33 @@ namespace soralog {
         return *reinterpret_cast<const T *>(item_);
       }
 
+      /**
+       * Captures free node exclusively
+       * @returns true if success
+       */
+      bool capture() noexcept {
+        uint32_t free = 0;
+        return holders.compare_exchange_strong(
+            free, 1, std::memory_order_acquire, std::memory_order_relaxed);
+      }
+
+      /**
+       * Releases one hold of node; it's free when all holds are released
+       */
+      void release() noexcept {
+        holders.fetch_sub(1, std::memory_order_release);
+      }
+
+      // Number of references holding node (e.g. producer and consumers)
       // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
-      std::atomic_flag busy = ATOMIC_VAR_INIT(false);
+      std::atomic_uint32_t holders = 0;
+
+      // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+      uint64_t sequence = 0;
+
+      // Id of buffer which node belongs to
+      // NOLINTNEXTLINE(cppcoreguidelines-non-private-member-variables-in-classes)
+      uint32_t lane = 0;
 
      private:
       // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
@@ -50,16 +77,27 @@ namespace soralog {
 
      public:
       NodeRef() noexcept = default;
-      NodeRef(NodeRef &&) noexcept = delete;
       NodeRef(const NodeRef &) = delete;
-      NodeRef &operator=(NodeRef &&) noexcept = delete;
       NodeRef &operator=(const NodeRef &) = delete;
 
+      NodeRef(NodeRef &&other) noexcept
+          : node(std::exchange(other.node, nullptr)) {}
+
+      NodeRef &operator=(NodeRef &&other) noexcept {
+        if (this != &other) {
+          if (node) {
+            node->release();
+          }
+          node = std::exchange(other.node, nullptr);
+        }
+        return *this;
+      }
+
       NodeRef(Node &node) noexcept : node(&node) {}
 
       ~NodeRef() noexcept(IF_RELEASE) {
         if (node) {
-          node->busy.clear();
+          node->release();
         }
       }
 
@@ -76,6 +114,23 @@ namespace soralog {
       explicit operator bool() const noexcept {
         return node != nullptr;
       }
+
+      /**
+       * @returns sequence number of item in buffer (starts from 1)
+       */
+      uint64_t sequence() const noexcept(IF_RELEASE) {
+        assert(node);
+        return node->sequence;
+      }
+
+      /**
+       * @returns id of buffer which item was put into; sequence numbers are
+       * counted by each buffer
+       */
+      uint32_t lane() const noexcept(IF_RELEASE) {
+        assert(node);
+        return node->lane;
+      }
     };
 
     CircularBuffer() = delete;
@@ -85,7 +140,11 @@ namespace soralog {
     CircularBuffer &operator=(CircularBuffer &&) noexcept = delete;
     CircularBuffer &operator=(const CircularBuffer &) = delete;
 
-    CircularBuffer(size_t capacity, size_t padding)
+    /**
+     * @param lane is id of buffer, which is given to its items; it
+     * distinguishes items of several buffers with own numeration each
+     */
+    CircularBuffer(size_t capacity, size_t padding, uint32_t lane)
         : capacity_(capacity),
           element_size_([&] {
             const auto alignment = std::alignment_of_v<Node>;
@@ -97,10 +156,14 @@ namespace soralog {
           raw_data_(capacity_ * element_size_) {
       for (auto index = 0; index < capacity; ++index) {
         // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-        new (raw_data_.data() + element_size_ * index) Node;
+        auto *node = new (raw_data_.data() + element_size_ * index) Node;
+        node->lane = lane;
       }
     };
 
+    CircularBuffer(size_t capacity, size_t padding)
+        : CircularBuffer(capacity, padding, 0) {};
+
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init,hicpp-member-init)
     explicit CircularBuffer(size_t capacity) : CircularBuffer(capacity, 0) {};
 
@@ -122,6 +185,13 @@ namespace soralog {
       return ret;
     }
 
+    /**
+     * @returns true if there is no item; doesn't lock buffer
+     */
+    bool empty() const noexcept {
+      return size_.load(std::memory_order_acquire) == 0;
+    }
+
     size_t avail() const noexcept {
       while (busy_.test_and_set()) {
         continue;
@@ -131,6 +201,13 @@ namespace soralog {
       return ret;
     }
 
+    /**
+     * @returns sequence number of last put item, i.e. total number of them
+     */
+    uint64_t lastSequence() const noexcept {
+      return pushed_.load(std::memory_order_relaxed);
+    }
+
     template <typename... Args>
     [[nodiscard]] NodeRef put(Args &&...args) noexcept(IF_RELEASE) {
       while (true) {
@@ -138,8 +215,12 @@ namespace soralog {
           continue;
         }
 
+        // Claim index of item; it's number of item as well
+        const auto pushed = pushed_.load(std::memory_order_relaxed);
+        const auto push_index = pushed % capacity_;
+
         // Tail is caught up - queue is full
-        if (pop_index_ == push_index_ and size_ != 0) {
+        if (pop_index_ == push_index and size_ != 0) {
           busy_.clear();
           return {};
         }
@@ -147,16 +228,18 @@ namespace soralog {
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
         auto &node = *reinterpret_cast<Node *>(
             // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-            raw_data_.data() + element_size_ * push_index_);
+            raw_data_.data() + element_size_ * push_index);
 
         // Capture node if not busy
-        if (node.busy.test_and_set()) {
+        if (not node.capture()) {
           busy_.clear();
           continue;
         }
 
-        // Go to next item place
-        push_index_ = (push_index_ + 1) % capacity_;
+        // Go to next item place; counter is changed under lock only, so it
+        // isn't read-modify-write
+        pushed_.store(pushed + 1, std::memory_order_relaxed);
+        node.sequence = pushed + 1;
 
         assert(size_ < capacity_);
         ++size_;
@@ -177,7 +260,7 @@ namespace soralog {
         }
 
         // Head is caught up - queue is empty
-        if (push_index_ == pop_index_ and size_ == 0) {
+        if (size_ == 0) {
           busy_.clear();
           return {};
         }
@@ -188,7 +271,7 @@ namespace soralog {
             raw_data_.data() + element_size_ * pop_index_);
 
         // Capture node if not busy
-        if (node.busy.test_and_set()) {
+        if (not node.capture()) {
           busy_.clear();
           continue;
         }
@@ -210,7 +293,8 @@ namespace soralog {
     const size_t element_size_;
     std::vector<std::byte> raw_data_;
     std::atomic_size_t size_ = 0;
-    std::atomic_size_t push_index_ = 0;
+    // Number of put items, i.e. claim index of next one
+    std::atomic<uint64_t> pushed_ = 0;
     std::atomic_size_t pop_index_ = 0;
     mutable std::atomic_flag busy_ = false;
   };
@@ -8,19 +8,192 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <cstring>
 #include <string_view>
+#include <type_traits>
 
+#include <fmt/compile.h>
 #include <fmt/format.h>
 #include <fmt/ostream.h>
 
 #include <soralog/level.hpp>
-#include <soralog/sink.hpp>
 #include <soralog/util.hpp>
 
 namespace soralog {
 
+  /// Prefix of message of event, which opens span (see SL_SPAN_BEGIN)
+  constexpr std::string_view span_begin_prefix = ">>> ";
+
+  /// Prefix of message of event, which closes span (see SL_SPAN_END)
+  constexpr std::string_view span_end_prefix = "<<< ";
+
+  /**
+   * Role of event on timeline of thread
+   */
+  enum class SpanKind : uint8_t {
+    NONE,      ///< usual event
+    BEGIN,     ///< opens span (SL_SPAN_BEGIN)
+    END,       ///< closes span (SL_SPAN_END)
+    COMPLETE,  ///< whole span, made at its end (SL_SCOPE_TIMER)
+  };
+
+  /**
+   * Format of event which marks span. Message is rendered by wrapped format
+   * as usual, and kind of span, its duration and place of its name in message
+   * are kept in event as metadata, so sinks don't need to recognize them by
+   * text of message. Message of begin and end is name after prefix of kind
+   * (span_begin_prefix, span_end_prefix); message of complete span starts
+   * with name of {@var name_size} bytes
+   */
+  template <typename Format>
+  struct SpanFormat {
+    Format format;
+    SpanKind kind;
+    std::chrono::nanoseconds duration;
+    size_t name_size;
+  };
+
+  /**
+   * @returns format of event of {@param kind} with message by
+   * {@param format}; {@param duration} and {@param name_size} are for
+   * complete span only
+   */
+  template <typename Format>
+  constexpr SpanFormat<Format> spanFormat(
+      SpanKind kind,
+      const Format &format,
+      std::chrono::nanoseconds duration = {},
+      size_t name_size = 0) {
+    return {format, kind, duration, name_size};
+  }
+
+  template <typename Format>
+  struct IsSpanFormat : std::false_type {};
+
+  template <typename Format>
+  struct IsSpanFormat<SpanFormat<Format>> : std::true_type {};
+
+  /**
+   * @returns text of {@param format}; format might be precompiled one
+   * (FMT_COMPILE), string literal, or any string-like object
+   */
+  template <typename Format>
+  constexpr auto formatToView(const Format &format) {
+    if constexpr (IsSpanFormat<Format>::value) {
+      return formatToView(format.format);
+    } else if constexpr (::fmt::detail::is_compiled_string<Format>::value) {
+      return static_cast<::fmt::string_view>(format);
+    } else {
+      return ::fmt::detail_exported::compile_string_to_view<char>(format);
+    }
+  }
+
+  /**
+   * @returns true if message by {@tparam Format} and {@tparam Args} is just
+   * constant text of string literal (precompiled format without arguments
+   * and replacement fields), so it doesn't need formatting
+   */
+  template <typename Format, typename... Args>
+  constexpr bool isLiteralMessage() {
+    if constexpr (sizeof...(Args) == 0
+                  and ::fmt::detail::is_compiled_string<Format>::value) {
+      constexpr auto text = formatToView(Format{});
+      return std::string_view(text.data(), text.size()).find_first_of("{}")
+          == std::string_view::npos;
+    } else {
+      return false;
+    }
+  }
+
+  /**
+   * @returns true if text of {@tparam Format} is known in compile-time
+   * (string literal or precompiled format), i.e. it isn't made in runtime
+   */
+  template <typename Format>
+  constexpr bool isStaticFormat() {
+    if constexpr (IsSpanFormat<Format>::value) {
+      return isStaticFormat<decltype(Format::format)>();
+    } else {
+      return ::fmt::detail::is_compiled_string<Format>::value
+          or std::is_array_v<Format>;
+    }
+  }
+
+  /**
+   * Writes message by {@param format} and {@param args} into {@param storage}
+   * of {@param max_message_length} bytes. If formatting is failed, writes
+   * description of error instead and sets {@param failed}
+   * @returns size of message
+   */
+  template <typename Format, typename... Args>
+  size_t formatMessage(char *storage,
+                       size_t max_message_length,
+                       bool &failed,
+                       const Format &format,
+                       const Args &...args) {
+    if constexpr (IsSpanFormat<Format>::value) {
+      return formatMessage(
+          storage, max_message_length, failed, format.format, args...);
+    }
+
+    struct {
+      using iterator_category = std::random_access_iterator_tag;
+      using value_type = char;
+      using reference = value_type &;
+      using pointer = value_type *;
+      using difference_type = ptrdiff_t;
+
+      value_type *pos;
+
+      value_type &operator*() const {
+        return *pos;
+      }
+      constexpr auto &operator++() {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        ++pos;
+        return *this;
+      }
+      constexpr auto operator++(int) {
+        auto origin = *this;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        ++pos;
+        return origin;
+      }
+    } it{storage};
+
+    size_t size = 0;
+    try {
+      // Before fmt 10 format_to_n of compiled format checks bound per char,
+      // and it is slower than parsing of format in runtime
+      if constexpr (FMT_VERSION >= 100000
+                    and ::fmt::detail::is_compiled_string<Format>::value) {
+        // Format was parsed in compile-time; arguments are written right
+        // into storage without parsing
+        size = ::fmt::format_to_n(storage, max_message_length, format, args...)
+                   .size;
+      } else {
+        size = ::fmt::vformat_to_n(it,
+                                   max_message_length,
+                                   formatToView(format),
+                                   ::fmt::make_format_args(args...))
+                   .size;
+      }
+    } catch (const std::exception &exception) {
+      size = fmt::format_to_n(it,
+                              max_message_length,
+                              "Format error: {}; Format: {}",
+                              exception.what(),
+                              formatToView(format))
+                 .size;
+      failed = true;
+    }
+    return std::min(max_message_length, size);
+  }
+
   /**
    * @class Event
    * Data of logging event
@@ -62,48 +235,27 @@ namespace soralog {
           break;
       }
 
-      struct {
-        using iterator_category = std::random_access_iterator_tag;
-        using value_type = char;
-        using reference = value_type &;
-        using pointer = value_type *;
-        using difference_type = ptrdiff_t;
-
-        value_type *pos;
+      if constexpr (IsSpanFormat<Format>::value) {
+        span_kind_ = format.kind;
+        span_duration_ = format.duration;
+        span_name_size_ = format.name_size;
+      }
 
-        value_type &operator*() const {
-          return *pos;
-        }
-        constexpr auto &operator++() {
-          // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-          ++pos;
-          return *this;
-        }
-        constexpr auto operator++(int) {
-          auto origin = *this;
-          // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
-          ++pos;
-          return origin;
+      if constexpr (isLiteralMessage<Format, Args...>()) {
+        // Event refers to static text of literal instead of copying it
+        constexpr auto text = formatToView(Format{});
+        message_data_ = text.data();
+        message_size_ = text.size();
+      } else {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        auto *const storage = reinterpret_cast<char *>(this) + sizeof(*this);
+        bool failed = false;
+        message_size_ = formatMessage(
+            storage, max_message_length, failed, format, args...);
+        if (failed) {
+          name = "Soralog";
+          level_ = Level::ERROR;
         }
-      } it{message_data_};
-
-      try {
-        message_size_ =
-            ::fmt::vformat_to_n(
-                it,
-                max_message_length,
-                ::fmt::detail_exported::compile_string_to_view<char>(format),
-                ::fmt::make_format_args(args...))
-                .size;
-      } catch (const std::exception &exception) {
-        message_size_ = fmt::format_to_n(it,
-                                         max_message_length,
-                                         "Format error: {}; Format: {}",
-                                         exception.what(),
-                                         format)
-                            .size;
-        name = "Soralog";
-        level_ = Level::ERROR;
       }
 
       message_size_ = std::min(max_message_length, message_size_);
@@ -146,6 +298,37 @@ namespace soralog {
       return level_;
     }
 
+    /**
+     * @returns role of event on timeline of thread
+     */
+    SpanKind span_kind() const noexcept {
+      return span_kind_;
+    }
+
+    /**
+     * @returns duration of complete span; event is made at its end
+     */
+    std::chrono::nanoseconds span_duration() const noexcept {
+      return span_duration_;
+    }
+
+    /**
+     * @returns name of span, which event marks, or empty one for usual event
+     */
+    std::string_view span_name() const noexcept {
+      const auto text = message();
+      switch (span_kind_) {
+        case SpanKind::BEGIN:
+          return text.substr(std::min(span_begin_prefix.size(), text.size()));
+        case SpanKind::END:
+          return text.substr(std::min(span_end_prefix.size(), text.size()));
+        case SpanKind::COMPLETE:
+          return text.substr(0, span_name_size_);
+        default:
+          return {};
+      }
+    }
+
     /**
      * @returns message of event
      */
@@ -161,8 +344,13 @@ namespace soralog {
     std::array<char, 32> name_;
     size_t name_size_;
     Level level_ = Level::OFF;
+    SpanKind span_kind_ = SpanKind::NONE;
+    std::chrono::nanoseconds span_duration_{};
+    size_t span_name_size_ = 0;
+    // Message is rendered right after event, or it is static text of literal
     // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
-    char *const message_data_ = reinterpret_cast<char *>(this) + sizeof(*this);
+    const char *message_data_ =
+        reinterpret_cast<const char *>(this) + sizeof(*this);
     size_t message_size_;
   };
 }  // namespace soralog
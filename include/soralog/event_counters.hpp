@@ -0,0 +1,205 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <soralog/level.hpp>
+
+namespace soralog {
+
+  /**
+   * @class EventCounters
+   * Lock-free table of numbers of events by logger, level and call site.
+   * Call site is identified by format of message, so message itself is never
+   * rendered. Formats made in runtime share one site (see dynamic_site), so
+   * number of sites is bounded. Table has fixed capacity; events of keys
+   * which don't fit into it are counted as overflowed
+   */
+  class EventCounters final {
+   public:
+    /// Longer formats are truncated to identify site
+    static constexpr size_t max_site_length = 96;
+
+    /// Site of all events, which format isn't string literal or precompiled
+    /// one (e.g. string made in runtime)
+    static constexpr std::string_view dynamic_site = "<dynamic>";
+
+    struct Counter {
+      std::string logger;
+      Level level;
+      std::string site;
+      uint64_t count;
+    };
+
+    EventCounters() = delete;
+    EventCounters(EventCounters &&) noexcept = delete;
+    EventCounters(const EventCounters &) = delete;
+    ~EventCounters() = default;
+    EventCounters &operator=(EventCounters &&) noexcept = delete;
+    EventCounters &operator=(const EventCounters &) = delete;
+
+    /**
+     * @param capacity is max number of distinct keys (rounded up to power of 2)
+     */
+    explicit EventCounters(size_t capacity)
+        : mask_([capacity] {
+            size_t size = 1;
+            while (size < capacity) {
+              size <<= 1;
+            }
+            return size - 1;
+          }()),
+          // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+          slots_(std::make_unique<Slot[]>(mask_ + 1)) {}
+
+    size_t capacity() const noexcept {
+      return mask_ + 1;
+    }
+
+    /**
+     * Counts event of logger {@param logger} with level {@param level} made
+     * by format {@param site}
+     */
+    void count(std::string_view logger,
+               Level level,
+               std::string_view site) noexcept {
+      logger = logger.substr(0, std::tuple_size_v<decltype(Slot::logger)>);
+      site = site.substr(0, max_site_length);
+      const auto hash = hashOf(logger, level, site);
+
+      for (size_t i = 0; i <= mask_; ++i) {
+        auto &slot = slots_[(hash + i) & mask_];
+        auto state = slot.state.load(std::memory_order_acquire);
+
+        if (state == State::FREE) {
+          if (slot.state.compare_exchange_strong(state,
+                                                 State::WRITING,
+                                                 std::memory_order_acquire,
+                                                 std::memory_order_acquire)) {
+            slot.hash = hash;
+            slot.level = level;
+            slot.logger_size = logger.size();
+            std::copy(logger.begin(), logger.end(), slot.logger.begin());
+            slot.site_size = site.size();
+            std::copy(site.begin(), site.end(), slot.site.begin());
+            slot.count.store(1, std::memory_order_relaxed);
+            // Sequentially consistent with check of idle dumper (see total())
+            slot.state.store(State::READY, std::memory_order_seq_cst);
+            return;
+          }
+        }
+
+        // Key is being written by other thread right now
+        while (state == State::WRITING) {
+          state = slot.state.load(std::memory_order_acquire);
+        }
+
+        if (slot.hash == hash and slot.level == level
+            and slot.loggerView() == logger and slot.siteView() == site) {
+          slot.count.fetch_add(1, std::memory_order_seq_cst);
+          return;
+        }
+      }
+
+      overflowed_.fetch_add(1, std::memory_order_seq_cst);
+    }
+
+    /**
+     * @returns snapshot of counters
+     */
+    std::vector<Counter> counters() const {
+      std::vector<Counter> result;
+      for (size_t i = 0; i <= mask_; ++i) {
+        const auto &slot = slots_[i];
+        if (slot.state.load(std::memory_order_acquire) != State::READY) {
+          continue;
+        }
+        result.push_back({std::string(slot.loggerView()),
+                          slot.level,
+                          std::string(slot.siteView()),
+                          slot.count.load(std::memory_order_relaxed)});
+      }
+      return result;
+    }
+
+    /**
+     * @returns number of all counted events. It changes with each event, so
+     * reader may skip unchanged counters. Counting thread, which checks some
+     * flag after count() by sequentially consistent load, and reader, which
+     * sets this flag and then calls total() after sequentially consistent
+     * fence, don't miss each other
+     */
+    uint64_t total() const noexcept {
+      uint64_t total = overflowed_.load(std::memory_order_relaxed);
+      for (size_t i = 0; i <= mask_; ++i) {
+        const auto &slot = slots_[i];
+        if (slot.state.load(std::memory_order_acquire) == State::READY) {
+          total += slot.count.load(std::memory_order_relaxed);
+        }
+      }
+      return total;
+    }
+
+    /**
+     * @returns number of events, which were not counted by key because of
+     * table is full
+     */
+    uint64_t overflowed() const noexcept {
+      return overflowed_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    enum State : uint8_t { FREE, WRITING, READY };
+
+    struct alignas(64) Slot {
+      std::atomic<uint64_t> count = 0;
+      std::atomic<State> state = State::FREE;
+      Level level = Level::OFF;
+      uint8_t logger_size = 0;
+      uint8_t site_size = 0;
+      uint64_t hash = 0;
+      std::array<char, 32> logger{};  // the same limit as for event
+      std::array<char, max_site_length> site{};
+
+      std::string_view loggerView() const noexcept {
+        return {logger.data(), logger_size};
+      }
+      std::string_view siteView() const noexcept {
+        return {site.data(), site_size};
+      }
+    };
+
+    static uint64_t hashOf(std::string_view logger,
+                           Level level,
+                           std::string_view site) noexcept {
+      // FNV-1a
+      uint64_t hash = 0xcbf29ce484222325;
+      auto mix = [&hash](char c) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 0x100000001b3;
+      };
+      std::for_each(logger.begin(), logger.end(), mix);
+      mix(static_cast<char>(level));
+      std::for_each(site.begin(), site.end(), mix);
+      return hash;
+    }
+
+    const size_t mask_;
+    // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<uint64_t> overflowed_ = 0;
+  };
+
+}  // namespace soralog
@@ -0,0 +1,113 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace soralog {
+
+  /**
+   * @class Executor
+   * Runs tasks of sinks (flushes) instead of their own worker threads, so
+   * threads are owned by application (e.g. pool of its event loops).
+   * Implementation must provide immediate and delayed posting only; tasks
+   * may run by any thread of executor, but each task runs once.
+   * See ThreadPoolExecutor and AsioExecutor (header-only, needs Boost.Asio)
+   */
+  class Executor {
+   public:
+    using Task = std::function<void()>;
+    using Duration = std::chrono::steady_clock::duration;
+
+    /**
+     * @class WakeHandle
+     * Handle of task posted with delay. Task can be woken up to run before
+     * delay is over, or cancelled; anyway it runs not more than once
+     */
+    class WakeHandle final
+        : public std::enable_shared_from_this<WakeHandle> {
+     public:
+      WakeHandle(Executor &executor, Task task)
+          : executor_(executor), task_(std::move(task)) {}
+
+      /**
+       * Posts task to run as soon as possible, if it hasn't run yet
+       */
+      void wake();
+
+      /**
+       * Prevents task from running
+       * @returns false if task is already started
+       */
+      bool cancel() noexcept {
+        return not claimed_.test_and_set(std::memory_order_acq_rel);
+      }
+
+      /**
+       * Runs task, if it isn't started or cancelled yet
+       */
+      void run();
+
+     private:
+      Executor &executor_;
+      Task task_;
+      std::atomic_flag claimed_ = ATOMIC_FLAG_INIT;
+    };
+
+    Executor() = default;
+    Executor(const Executor &) = delete;
+    Executor(Executor &&) noexcept = delete;
+    virtual ~Executor() = default;
+    Executor &operator=(const Executor &) = delete;
+    Executor &operator=(Executor &&) noexcept = delete;
+
+    /**
+     * Runs {@param task} as soon as possible
+     */
+    virtual void post(Task task) = 0;
+
+    /**
+     * Runs {@param task} after {@param delay}
+     */
+    virtual void postAfter(Duration delay, Task task) = 0;
+
+    /**
+     * Runs {@param task} after {@param delay}
+     * @returns handle to run it earlier or to cancel it
+     */
+    std::shared_ptr<WakeHandle> schedule(Duration delay, Task task);
+
+    /**
+     * @returns executor which is used by sinks created by current thread at
+     * the moment, or nullptr if sinks start own workers
+     */
+    static std::shared_ptr<Executor> current() noexcept;
+
+    /**
+     * @class Scope
+     * Sets executor returned by current() during its lifetime; logging
+     * system uses it to pass its executor to sinks it creates
+     */
+    class Scope final {
+     public:
+      explicit Scope(std::shared_ptr<Executor> executor) noexcept;
+      ~Scope();
+      Scope(const Scope &) = delete;
+      Scope(Scope &&) noexcept = delete;
+      Scope &operator=(const Scope &) = delete;
+      Scope &operator=(Scope &&) noexcept = delete;
+
+     private:
+      std::shared_ptr<Executor> previous_;
+    };
+  };
+
+}  // namespace soralog
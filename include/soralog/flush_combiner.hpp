@@ -0,0 +1,141 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace soralog {
+
+  /**
+   * @class FlushCombiner
+   * Serializes passes of flush (i.e. writing out of all queued events) by
+   * flat combining: thread which finds flush in progress doesn't write events
+   * itself, but requests one more pass from flushing thread (combiner) and
+   * waits until some pass started after its request is done. So events
+   * queued by thread before flush are written out when it returns, and
+   * events of concurrent producers are written by one batch. Waiting
+   * threads sleep on condition variable, which is notified only if there
+   * are ones.
+   */
+  class FlushCombiner final {
+   public:
+    /// Combiner hands over after so many passes, so one producer doesn't
+    /// stay writing for others under permanent load
+    static constexpr size_t max_passes = 8;
+
+    /**
+     * Makes sure that {@param pass} is done after the call starts: runs it
+     * by this thread, or waits for pass done by other one
+     */
+    template <typename Pass>
+    void combine(const Pass &pass) noexcept {
+      const auto ticket = started_.load(std::memory_order_seq_cst) + 1;
+      auto requested = requested_.load(std::memory_order_relaxed);
+      while (requested < ticket
+             and not requested_.compare_exchange_weak(
+                 requested, ticket, std::memory_order_relaxed)) {
+      }
+
+      while (done_.load(std::memory_order_acquire) < ticket) {
+        if (in_progress_.exchange(true, std::memory_order_acquire)) {
+          park([&] {
+            return done_.load(std::memory_order_seq_cst) >= ticket;
+          });
+          continue;
+        }
+        // Requested pass might be done by combiner which has just left
+        if (done_.load(std::memory_order_acquire) >= ticket) {
+          release();
+          break;
+        }
+        // Passes are done while other threads request them
+        size_t passes = 0;
+        do {
+          const auto id = started_.fetch_add(1, std::memory_order_seq_cst) + 1;
+          // Events queued before request are seen by the pass
+          std::atomic_thread_fence(std::memory_order_seq_cst);
+          pass();
+          done_.store(id, std::memory_order_seq_cst);
+          // Threads waiting for this pass don't wait for the next ones
+          unpark();
+        } while (++passes < max_passes
+                 and requested_.load(std::memory_order_acquire)
+                         > done_.load(std::memory_order_relaxed));
+        release();
+      }
+    }
+
+    /**
+     * Runs {@param pass} exclusively, i.e. not concurrently with other
+     * passes. If other pass is in progress, waits for it, if {@param wait},
+     * or returns at once. Such pass doesn't serve requests of combine()
+     * @returns false if pass is not run
+     */
+    template <typename Pass>
+    bool exclusive(const Pass &pass, bool wait) noexcept {
+      while (in_progress_.exchange(true, std::memory_order_acquire)) {
+        if (not wait) {
+          return false;
+        }
+        park([] { return false; });
+      }
+      pass();
+      release();
+      return true;
+    }
+
+   private:
+    void release() noexcept {
+      in_progress_.store(false, std::memory_order_seq_cst);
+      unpark();
+    }
+
+    /**
+     * Sleeps while pass is in progress, until {@param is_done} returns true.
+     * Counter of parked threads is increased before state is checked, and
+     * state is changed before counter is checked by unpark(), so wakeup
+     * isn't lost
+     */
+    template <typename IsDone>
+    void park(const IsDone &is_done) noexcept {
+      std::unique_lock lock(mutex_);
+      parked_.fetch_add(1, std::memory_order_seq_cst);
+      while (in_progress_.load(std::memory_order_seq_cst) and not is_done()) {
+        condvar_.wait_until(lock, std::chrono::steady_clock::time_point::max());
+      }
+      parked_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * Wakes up parked threads; costs nothing if there are no ones
+     */
+    void unpark() noexcept {
+      if (parked_.load(std::memory_order_seq_cst) != 0) {
+        std::lock_guard lock(mutex_);
+        condvar_.notify_all();
+      }
+    }
+
+    std::atomic_bool in_progress_ = false;
+    // Number of started and done passes, and pass requested by waiting threads
+    std::atomic<uint64_t> started_ = 0;
+    std::atomic<uint64_t> done_ = 0;
+    std::atomic<uint64_t> requested_ = 0;
+
+    // Threads waiting for pass in progress sleep instead of spinning
+    std::atomic<size_t> parked_ = 0;
+    std::mutex mutex_;
+    std::condition_variable condvar_;
+  };
+
+}  // namespace soralog
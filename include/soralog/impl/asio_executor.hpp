@@ -0,0 +1,50 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/executor.hpp>
+
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+namespace soralog {
+
+  /**
+   * @class AsioExecutor
+   * Executor running tasks by Boost.Asio executor (e.g. of io_context or
+   * thread_pool). It's header-only, so library doesn't depend on Boost;
+   * include it if application uses Asio.
+   * Executor of Asio must outlive sinks using this one
+   */
+  class AsioExecutor final : public Executor {
+   public:
+    AsioExecutor() = delete;
+
+    explicit AsioExecutor(boost::asio::any_io_executor executor)
+        : executor_(std::move(executor)) {}
+
+    void post(Task task) override {
+      boost::asio::post(executor_, std::move(task));
+    }
+
+    void postAfter(Duration delay, Task task) override {
+      auto timer = std::make_shared<boost::asio::steady_timer>(executor_);
+      timer->expires_after(delay);
+      // Timer is kept alive by its handler
+      timer->async_wait(
+          [timer, task = std::move(task)](const boost::system::error_code &) {
+            task();
+          });
+    }
+
+   private:
+    boost::asio::any_io_executor executor_;
+  };
+
+}  // namespace soralog
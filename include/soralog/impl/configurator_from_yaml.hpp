@@ -15,6 +15,7 @@
 #include <yaml-cpp/yaml.h>
 
 #include <soralog/logging_system.hpp>
+#include <soralog/redactor.hpp>
 
 namespace soralog {
 
@@ -81,6 +82,14 @@ namespace soralog {
       std::optional<Level> parseLevel(const std::string &target,
                                       const YAML::Node &node);
 
+      std::shared_ptr<Redactor> parseRedactor(const std::string &name,
+                                              const YAML::Node &sink_node);
+
+      std::optional<size_t> parseShards(const std::string &name,
+                                        const YAML::Node &sink_node);
+
+      std::optional<bool> parsePoll(const YAML::Node &sink_node);
+
       void parseSinks(const YAML::Node &sinks);
 
       void parseSink(int number, const YAML::Node &sink);
@@ -91,9 +100,24 @@ namespace soralog {
       void parseSinkToFile(const std::string &name,
                            const YAML::Node &sink_node);
 
+      void parseSinkToTrace(const std::string &name,
+                            const YAML::Node &sink_node);
+
       void parseSinkToSyslog(const std::string &name,
                              const YAML::Node &sink_node);
 
+      void parseSinkToSharedMemory(const std::string &name,
+                                   const YAML::Node &sink_node);
+
+      void parseSinkToNetwork(const std::string &name,
+                              const YAML::Node &sink_node);
+
+      void parseSinkToOtlp(const std::string &name,
+                           const YAML::Node &sink_node);
+
+      void parseSinkToMetrics(const std::string &name,
+                              const YAML::Node &sink_node);
+
       void parseMultisink(const std::string &name, const YAML::Node &sink_node);
 
       void parseGroups(const YAML::Node &groups,
@@ -17,23 +17,59 @@
 namespace soralog {
   using namespace std::chrono_literals;
 
+  /**
+   * @class Multisink
+   * Sink passing events to several underlying sinks.
+   * By default each event is pushed into each sink separately. In broadcast
+   * mode event is formatted and stored once in shared buffer, and each sink
+   * reads it from there by own cursor
+   */
   class Multisink final : public Sink {
    public:
+    using LagPolicy = BroadcastBuffer<Event>::LagPolicy;
+
     Multisink() = delete;
     Multisink(Multisink &&) noexcept = delete;
     Multisink(const Multisink &) = delete;
     Multisink &operator=(Multisink &&) noexcept = delete;
     Multisink &operator=(const Multisink &) = delete;
 
+    /**
+     * @param broadcast enables broadcast mode with provided policy for the
+     * case if some sink is lagging
+     * @param capacity is number of events in shared buffer
+     */
     Multisink(std::string name,
               Level level,
-              std::vector<std::shared_ptr<Sink>> sinks);
+              std::vector<std::shared_ptr<Sink>> sinks,
+              std::optional<LagPolicy> broadcast = {},
+              std::optional<size_t> capacity = {});
 
     void rotate() noexcept override;
     void flush() noexcept override;
 
+    /**
+     * @returns number of events dropped in broadcast mode
+     */
+    size_t dropped() const noexcept {
+      return broadcast_ ? broadcast_->dropped() : 0;
+    }
+
+    /**
+     * @returns true if sink {@param index} is detached in broadcast mode.
+     * Counting and direct sinks are detached always, they get events by push
+     */
+    bool isDetached(size_t index) const noexcept {
+      return broadcast_ and broadcast_->isDetached(index);
+    }
+
    private:
     void async_flush() noexcept override {};
+
+    static ThreadInfoType threadInfoType(
+        const std::vector<std::shared_ptr<Sink>> &sinks);
+    static size_t maxMessageLength(
+        const std::vector<std::shared_ptr<Sink>> &sinks);
   };
 
 }  // namespace soralog
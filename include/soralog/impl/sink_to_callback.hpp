@@ -0,0 +1,111 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/batch_sink.hpp>
+
+#include <functional>
+#include <mutex>
+
+namespace soralog {
+
+  /**
+   * @class SinkToCallback
+   * Sink passes events to subscribed callbacks in-process. Callbacks are
+   * called by worker of sink with batches of events, never by threads which
+   * make events. Optionally sink keeps ring of last rendered events, which
+   * can be read by any thread without locking.
+   */
+  class SinkToCallback final : public BatchSink {
+   public:
+    /// Called with batch of events; events are valid during call only
+    using Callback = std::function<void(const Batch &events)>;
+    using SubscriptionId = uint64_t;
+
+    SinkToCallback() = delete;
+    SinkToCallback(SinkToCallback &&) noexcept = delete;
+    SinkToCallback(const SinkToCallback &) = delete;
+    SinkToCallback &operator=(SinkToCallback &&) noexcept = delete;
+    SinkToCallback &operator=(const SinkToCallback &) = delete;
+
+    /**
+     * @param recent is number of last rendered events kept in ring; 0 means
+     * there is no ring
+     * @param latency must not be zero, because callbacks are called by
+     * worker only
+     */
+    SinkToCallback(std::string name,
+                   Level level,
+                   std::optional<size_t> recent = {},
+                   std::optional<ThreadInfoType> thread_info_type = {},
+                   std::optional<size_t> capacity = {},
+                   std::optional<size_t> max_message_length = {},
+                   std::optional<size_t> buffer_size = {},
+                   std::optional<size_t> latency = {});
+    ~SinkToCallback() override;
+
+    /**
+     * Adds {@param callback}; it gets events pushed after subscription
+     * @returns id for unsubscription
+     */
+    SubscriptionId subscribe(Callback callback);
+
+    /**
+     * Removes callback by {@param id}. Callback may be called one more time,
+     * if worker is calling callbacks right now
+     */
+    void unsubscribe(SubscriptionId id);
+
+    /**
+     * @returns up to {@param count} last rendered events, the oldest first
+     */
+    std::vector<std::string> recent(
+        size_t count = std::numeric_limits<size_t>::max()) const;
+
+   protected:
+    void write(const Batch &events, std::vector<char> &buffer) override;
+
+   private:
+    struct Subscriber {
+      SubscriptionId id;
+      Callback callback;
+    };
+    using Subscribers = std::vector<Subscriber>;
+
+    /**
+     * Slot of ring of recent events. It's guarded by seqlock: version is odd
+     * while record is being written, and it's 2 * (position + 1) after that.
+     * Size and words of record are accessed by relaxed atomics, so reading
+     * of slot being rewritten isn't a data race; such copy is just dropped
+     */
+    struct Slot {
+      std::atomic<uint64_t> version = 0;
+      std::atomic<size_t> size = 0;
+    };
+
+    /// Record is stored by words of this type
+    using Word = uint64_t;
+
+    void keep(const Event &event, uint32_t lane, uint64_t sequence);
+
+    std::mutex subscription_mutex_;
+    SubscriptionId last_id_ = 0;
+    // Accessed by std::atomic_load/std::atomic_store
+    std::shared_ptr<const Subscribers> subscribers_;
+
+    const size_t ring_size_;
+    const size_t record_size_;
+    const size_t record_words_;
+    std::vector<Slot> slots_;
+    std::vector<std::atomic<Word>> records_;
+    // Record is rendered here before it's stored into slot; used by worker
+    std::vector<char> record_;
+    std::atomic<uint64_t> kept_ = 0;
+  };
+
+}  // namespace soralog
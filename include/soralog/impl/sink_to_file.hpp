@@ -7,20 +7,47 @@
 
 #pragma once
 
-#include <soralog/sink.hpp>
+#include <soralog/batch_sink.hpp>
+#include <soralog/prefix_cache.hpp>
+#include <soralog/render_pool.hpp>
 
-#include <condition_variable>
+#include <sys/uio.h>
+
+#include <cstdlib>
 #include <filesystem>
-#include <fstream>
 #include <memory>
-#include <mutex>
-#include <thread>
 
 namespace soralog {
   using namespace std::chrono_literals;
 
-  class SinkToFile final : public Sink {
+  /**
+   * @class SinkToFile
+   * Sink writes rendered events into file.
+   * Batch is written by gathering write: rendered prefixes of records are
+   * placed in buffer, but long messages are referred right in slots of
+   * queue, so they aren't copied in user space at all.
+   * Optionally big batches of events are rendered by pool of threads into
+   * separate buffers, which are written out in original order of events.
+   * Optionally (Linux only) written data are periodically written back and
+   * dropped from page cache, so log doesn't evict pages of other files, and
+   * space of file is preallocated ahead.
+   * Optionally (Linux only) file is written with O_DIRECT bypassing page
+   * cache: records are collected in aligned buffer, which is written by
+   * whole blocks; partial last block is rewritten after each batch. Sink
+   * falls back to usual writing, if filesystem doesn't support direct I/O
+   */
+  class SinkToFile final : public BatchSink {
    public:
+    /// Shorter messages are copied into buffer next to prefix, because
+    /// separate piece of gathering write costs more than copying them
+    static constexpr size_t min_in_place_message_size = 128;
+
+    /// Alignment of offsets, sizes and memory of direct writing
+    static constexpr size_t direct_block_size = 4096;
+
+    /// Size of aligned buffer of direct writing
+    static constexpr size_t direct_buffer_size = 1u << 20;
+
     SinkToFile() = delete;
     SinkToFile(SinkToFile &&) noexcept = delete;
     SinkToFile(const SinkToFile &) = delete;
@@ -34,33 +61,130 @@ namespace soralog {
                std::optional<size_t> capacity = {},
                std::optional<size_t> buffer_size = {},
                std::optional<size_t> max_message_length = {},
-               std::optional<size_t> latency = {});
+               std::optional<size_t> latency = {},
+               std::optional<bool> with_sequence = {},
+               std::optional<size_t> render_threads = {},
+               std::optional<size_t> shards = {},
+               std::optional<size_t> writeback_size = {},
+               std::optional<size_t> preallocate_size = {},
+               std::optional<bool> direct_io = {},
+               std::optional<bool> polled = {});
     ~SinkToFile() override;
 
-    void rotate() noexcept override;
+   protected:
+    void write(const Batch &events, std::vector<char> &buffer) override;
 
-    void flush() noexcept override;
+    void sync() noexcept override;
 
-   protected:
-    void async_flush() noexcept override;
+    void reopen() noexcept override;
 
    private:
-    void run();
+    /**
+     * Renders events by chunks in parallel and writes them out in original
+     * order
+     */
+    void writeInParallel(const Batch &events);
+
+    /**
+     * Renders events into {@param buffer} and writes them out
+     */
+    void writeInSerial(const Batch &events, std::vector<char> &buffer);
+
+    /**
+     * Writes all {@param count} pieces of data from {@param iov} to file,
+     * continuing after partial writes
+     */
+    void writeOut(iovec *iov, size_t count) noexcept;
+
+    /**
+     * Opens file with O_DIRECT if it's requested and supported, and sets
+     * {@param direct} accordingly
+     * @returns descriptor of file or -1
+     */
+    int openFile(bool &direct) noexcept;
+
+    /**
+     * Takes offsets from end of just opened file; falls back to usual
+     * writing, if direct one is not possible
+     */
+    void resetOffsets() noexcept;
+
+    /**
+     * Loads partial last block of file into aligned buffer and checks if
+     * direct writing is possible
+     */
+    bool prepareDirect() noexcept;
+
+    /**
+     * Appends {@param count} pieces of data from {@param iov} to aligned
+     * buffer, writing it out when it's full
+     */
+    void writeDirect(const iovec *iov, size_t count) noexcept;
+
+    /**
+     * Writes buffered data including partial last block, which is padded;
+     * file is truncated to size of data, and space beyond it is reserved
+     * again, if it's preallocated
+     */
+    void writeDirectTail() noexcept;
+
+    /**
+     * Writes {@param size} bytes from start of aligned buffer
+     */
+    bool writeBlocks(size_t size) noexcept;
+
+    /**
+     * Reserves space of file for {@param size} bytes to be written, by steps
+     * of preallocate_size_
+     */
+    void preallocate(size_t size) noexcept;
+
+    /**
+     * Starts writeback of data written since previous call, if there are at
+     * least writeback_size_ bytes, and drops pages of previous range from
+     * page cache
+     */
+    void writeBack() noexcept;
 
     const std::filesystem::path path_;
 
-    std::unique_ptr<std::thread> sink_worker_{};
-
-    std::vector<char> buff_;
-    std::ofstream out_{};
-    std::mutex mutex_{};
-    std::condition_variable condvar_{};
-    std::atomic_bool need_to_finalize_ = false;
-    std::atomic_bool need_to_flush_ = false;
-    std::atomic_bool need_to_rotate_ = false;
-    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
-        std::chrono::steady_clock::time_point();
-    std::atomic_flag flush_in_progress_ = false;
+    std::unique_ptr<RenderPool> render_pool_{};
+    std::vector<std::vector<char>> chunks_;
+    std::vector<size_t> chunk_sizes_;
+    std::vector<PrefixCache> chunk_prefixes_;
+
+    PrefixCache prefixes_;
+
+    // Size of data between writebacks; 0 means page cache isn't managed
+    const size_t writeback_size_;
+    // Step of preallocation; 0 means space isn't preallocated
+    size_t preallocate_size_;
+
+    // Direct writing is requested
+    const bool direct_io_;
+
+    int fd_ = -1;
+    // File is opened with O_DIRECT
+    bool direct_ = false;
+
+    struct AlignedFree {
+      void operator()(char *ptr) const noexcept {
+        std::free(ptr);  // NOLINT
+      }
+    };
+    // Buffer of direct writing, which starts at offset direct_base_ of file
+    std::unique_ptr<char, AlignedFree> direct_buffer_;
+    size_t direct_base_ = 0;
+    size_t direct_size_ = 0;
+    // Offsets in file: end of written data, end of data which writeback is
+    // started for, end of data dropped from page cache, end of reserved space
+    size_t offset_ = 0;
+    size_t written_back_ = 0;
+    size_t dropped_ = 0;
+    size_t allocated_ = 0;
+    // Pieces of data for gathering write of batch
+    std::vector<iovec> iov_;
+    bool write_failed_ = false;
   };
 
 }  // namespace soralog
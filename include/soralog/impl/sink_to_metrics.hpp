@@ -0,0 +1,100 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/sink.hpp>
+#include <soralog/sink_scheduler.hpp>
+
+#include <filesystem>
+#include <mutex>
+#include <optional>
+
+namespace soralog {
+
+  /**
+   * @class SinkToMetrics
+   * Sink renders nothing: it counts events by logger, level and call site
+   * (format of message). Formats which aren't string literals, e.g. strings
+   * made in runtime for SL_*_DF macros, share one site "<dynamic>", so
+   * number of series stays bounded. Counters are available by API and are
+   * periodically dumped into file in Prometheus text format (e.g. for
+   * textfile collector of node exporter). Dumps are done by own thread, or
+   * by tasks of executor if it's set while sink is created. Unchanged
+   * counters are not dumped, and idle sink sleeps until the next event
+   */
+  class SinkToMetrics final : public Sink {
+   public:
+    using Counter = EventCounters::Counter;
+
+    SinkToMetrics() = delete;
+    SinkToMetrics(SinkToMetrics &&) noexcept = delete;
+    SinkToMetrics(const SinkToMetrics &) = delete;
+    SinkToMetrics &operator=(SinkToMetrics &&) noexcept = delete;
+    SinkToMetrics &operator=(const SinkToMetrics &) = delete;
+
+    /**
+     * @param path of file for dump; nothing is dumped if it's empty
+     * @param period of dumping in milliseconds
+     * @param capacity is max number of distinct counters
+     */
+    SinkToMetrics(std::string name,
+                  Level level,
+                  std::optional<std::filesystem::path> path = {},
+                  std::optional<size_t> period = {},
+                  std::optional<size_t> capacity = {});
+    ~SinkToMetrics() override;
+
+    /**
+     * @returns snapshot of counters
+     */
+    std::vector<Counter> counters() const;
+
+    /**
+     * @returns number of events, which were not counted by key because of
+     * table of counters is full
+     */
+    uint64_t overflowed() const noexcept;
+
+    /**
+     * @returns counters in Prometheus text exposition format
+     */
+    std::string render() const;
+
+    /**
+     * Dumps counters into file, if they are changed since the last dump
+     */
+    void flush() noexcept override;
+
+    void async_flush() noexcept override;
+
+    void rotate() noexcept override;
+
+   protected:
+    void wakeUp() noexcept override;
+
+   private:
+    /**
+     * Dumps counters into file, if they are changed since the last dump or
+     * {@param forced}
+     */
+    void dump(bool forced) noexcept;
+
+    const std::filesystem::path path_;
+    const std::chrono::milliseconds period_;
+
+    // Worker, or tasks of executor, which dump counters periodically
+    SinkScheduler scheduler_;
+    // Time of next periodic dump; accessed by scheduler only
+    std::chrono::steady_clock::time_point next_dump_{};
+
+    std::mutex dump_mutex_;
+    // Total of counters at the last dump; guarded by dump_mutex_
+    std::optional<uint64_t> dumped_total_{};
+  };
+
+}  // namespace soralog
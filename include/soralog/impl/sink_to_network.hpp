@@ -0,0 +1,174 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/flush_combiner.hpp>
+#include <soralog/sink.hpp>
+#include <soralog/sink_scheduler.hpp>
+
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+namespace soralog {
+  using namespace std::chrono_literals;
+
+  /**
+   * @class SinkToNetwork
+   * Sink sends rendered events to remote collector by batches.
+   * TCP: each batch is sent as frame: 4-byte length (big-endian) and lines.
+   * UDP: each batch is datagram with whole lines, bounded by MTU-related size.
+   * Connection is established by sink worker (or by tasks of executor, if it
+   * is set while sink is created) in non-blocking way and re-established with
+   * exponential backoff; it's done so even without latency, so producers are
+   * never blocked by resolving of host. Batches are kept in memory while connection is
+   * absent; exceeding ones are moved into spool file (if it is configured) to
+   * be sent after reconnect, or dropped otherwise.
+   */
+  class SinkToNetwork final : public Sink {
+   public:
+    enum class Protocol : uint8_t {
+      TCP,
+      UDP,
+    };
+
+    SinkToNetwork() = delete;
+    SinkToNetwork(SinkToNetwork &&) noexcept = delete;
+    SinkToNetwork(const SinkToNetwork &) = delete;
+    SinkToNetwork &operator=(SinkToNetwork &&) noexcept = delete;
+    SinkToNetwork &operator=(const SinkToNetwork &) = delete;
+
+    SinkToNetwork(std::string name,
+                  Level level,
+                  Protocol protocol,
+                  std::string host,
+                  uint16_t port,
+                  std::optional<ThreadInfoType> thread_info_type = {},
+                  std::optional<size_t> capacity = {},
+                  std::optional<size_t> max_message_length = {},
+                  std::optional<size_t> buffer_size = {},
+                  std::optional<size_t> latency = {},
+                  std::optional<size_t> max_pending_size = {},
+                  std::optional<size_t> max_datagram_size = {},
+                  std::optional<std::filesystem::path> spool_path = {},
+                  std::optional<bool> with_sequence = {},
+                  std::optional<size_t> shards = {});
+    ~SinkToNetwork() override;
+
+    void rotate() noexcept override {};
+
+    void flush() noexcept override;
+
+    /**
+     * @returns true if connection is established
+     */
+    bool isConnected() const noexcept {
+      return state_.load(std::memory_order_acquire) == State::CONNECTED;
+    }
+
+    /**
+     * @returns number of dropped events
+     */
+    size_t dropped() const noexcept {
+      return dropped_.load(std::memory_order_relaxed);
+    }
+
+   protected:
+    void async_flush() noexcept override;
+
+    void wakeUp() noexcept override;
+
+   private:
+    enum class State : uint8_t {
+      DISCONNECTED,
+      CONNECTING,
+      CONNECTED,
+    };
+
+    /**
+     * Rendered events prepared to send
+     */
+    struct Batch {
+      std::string data;
+      size_t events;
+    };
+
+    /**
+     * @returns time when worker should do next pass of flush; idle sink
+     * (without events and unsent data, and not connecting) parks
+     */
+    std::chrono::steady_clock::time_point nextDeadline() noexcept;
+
+    /**
+     * Tries to send the rest of data during finalization, while connection
+     * is alive
+     */
+    void deliverRest() noexcept;
+
+    /**
+     * Moves events into pending batches and sends them if it's possible.
+     * Connection is (re)established if {@param can_connect} is true
+     */
+    void flush(bool can_connect) noexcept;
+
+    /**
+     * Does one pass of flush; called by one thread at once (see combiner_)
+     */
+    void drain(bool can_connect) noexcept;
+
+    void connect() noexcept;
+    void disconnect(bool failed) noexcept;
+    void send() noexcept;
+    bool sendSpooled() noexcept;
+    void enqueue(std::string data, size_t events) noexcept;
+    void restrictPending() noexcept;
+
+    std::string_view payload(const std::string &batch) const noexcept;
+
+    const Protocol protocol_;
+    const std::string host_;
+    const uint16_t port_;
+    const size_t max_pending_size_;
+    const size_t max_batch_size_;
+    const std::optional<std::filesystem::path> spool_path_;
+
+    // Worker, or tasks of executor, which connect and send in background
+    SinkScheduler scheduler_;
+
+    std::vector<char> buff_;
+    std::string batch_;
+    size_t batch_events_ = 0;
+
+    int socket_ = -1;
+    std::atomic<State> state_ = State::DISCONNECTED;
+    std::chrono::milliseconds backoff_;
+    std::atomic<std::chrono::steady_clock::time_point> next_connect_ =
+        std::chrono::steady_clock::time_point();
+    std::chrono::steady_clock::time_point connect_deadline_{};
+
+    std::deque<Batch> pending_;
+    size_t pending_size_ = 0;
+    // There is data waiting for connection (pending or spooled batches)
+    std::atomic_bool has_unsent_ = false;
+    size_t sent_offset_ = 0;
+
+    std::ofstream spool_;
+    size_t spool_size_ = 0;
+    size_t spool_offset_ = 0;
+    std::string spooled_batch_;
+    size_t spooled_sent_offset_ = 0;
+
+    std::atomic_size_t dropped_ = 0;
+
+    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
+        std::chrono::steady_clock::time_point();
+    FlushCombiner combiner_;
+  };
+
+}  // namespace soralog
@@ -0,0 +1,167 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/flush_combiner.hpp>
+#include <soralog/sink.hpp>
+#include <soralog/sink_scheduler.hpp>
+
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace soralog {
+  using namespace std::chrono_literals;
+
+  /**
+   * @class SinkToOtlp
+   * Sink exports events as OpenTelemetry log records (OTLP/JSON) by HTTP POST
+   * requests to collector (e.g. http://127.0.0.1:4318/v1/logs). Records are
+   * grouped by logger name, which is used as instrumentation scope; severity
+   * is mapped from level; logger name, thread info, lane and number of event
+   * (as "#lane.seq" of text sinks) are passed by attributes. Batch is
+   * closed when it exceeds buffer size or latency is expired, or at once
+   * without latency. Closed batches are exported by sink worker only (or by
+   * tasks of executor, if it's set while sink is created), so producers
+   * (and flush() called by them) never wait for collector. Body
+   * is compressed by gzip, if it's enabled. Batches which collector has not
+   * accepted, or which are in excess of max_pending_batches, are dropped and
+   * counted.
+   */
+  class SinkToOtlp final : public Sink {
+   public:
+    /// Max number of closed batches waiting for export
+    static constexpr size_t max_pending_batches = 16;
+
+    SinkToOtlp() = delete;
+    SinkToOtlp(SinkToOtlp &&) noexcept = delete;
+    SinkToOtlp(const SinkToOtlp &) = delete;
+    SinkToOtlp &operator=(SinkToOtlp &&) noexcept = delete;
+    SinkToOtlp &operator=(const SinkToOtlp &) = delete;
+
+    /**
+     * @param endpoint is URL in form http://host[:port][/path]
+     * @throws std::invalid_argument if endpoint is malformed
+     */
+    SinkToOtlp(std::string name,
+               Level level,
+               const std::string &endpoint,
+               std::optional<ThreadInfoType> thread_info_type = {},
+               std::optional<size_t> capacity = {},
+               std::optional<size_t> max_message_length = {},
+               std::optional<size_t> buffer_size = {},
+               std::optional<size_t> latency = {},
+               std::optional<bool> compression = {},
+               std::optional<std::string> service_name = {});
+    ~SinkToOtlp() override;
+
+    void rotate() noexcept override {};
+
+    void flush() noexcept override;
+
+    /**
+     * @returns number of exported records
+     */
+    size_t exported() const noexcept {
+      return exported_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @returns number of records which were not accepted by collector
+     */
+    size_t dropped() const noexcept {
+      return dropped_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @returns OTLP severity number in according with {@param level}
+     */
+    static int severityNumber(Level level) noexcept;
+
+   protected:
+    void async_flush() noexcept override;
+
+    void wakeUp() noexcept override;
+
+   private:
+    /**
+     * Records of one instrumentation scope in current batch
+     */
+    struct Scope {
+      std::string name;
+      std::string records;
+    };
+
+    /**
+     * Closed batch waiting for export
+     */
+    struct Batch {
+      std::string body;
+      size_t records = 0;
+    };
+
+    /**
+     * @returns time of next pass of export; sink without events parks
+     */
+    std::chrono::steady_clock::time_point nextExport() noexcept;
+
+    /**
+     * Moves all queued events into batches; called by one thread at once
+     */
+    void drain() noexcept;
+
+    /**
+     * Appends record of {@param event} with number {@param sequence} in
+     * {@param lane} to batch of scope of its logger
+     */
+    void append(const Event &event, uint32_t lane, uint64_t sequence);
+
+    /**
+     * Closes current batch and passes it to worker for export
+     */
+    void seal() noexcept;
+
+    /**
+     * Exports closed batches; called by worker or export task only
+     */
+    void exportPending() noexcept;
+
+    bool compress();
+    bool post(const std::string &body, const char *content_encoding) noexcept;
+    bool connect() noexcept;
+    void disconnect() noexcept;
+
+    std::string host_;
+    uint16_t port_ = 80;
+    std::string path_;
+    const bool compression_;
+    const std::optional<std::string> service_name_;
+
+    // Worker, or tasks of executor, which export batches in background
+    SinkScheduler scheduler_;
+
+    std::vector<Scope> scopes_;
+    size_t records_count_ = 0;
+    size_t batch_size_ = 0;
+    std::deque<Batch> pending_;  // guarded by mutex_
+    std::string body_;
+    std::string compressed_;
+    std::string request_;
+    int socket_ = -1;
+
+    std::atomic_size_t exported_ = 0;
+    std::atomic_size_t dropped_ = 0;
+
+    std::mutex mutex_;
+    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
+        std::chrono::steady_clock::time_point();
+    FlushCombiner combiner_;
+  };
+
+}  // namespace soralog
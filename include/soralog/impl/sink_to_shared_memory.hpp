@@ -0,0 +1,81 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/sink.hpp>
+
+#include <memory>
+
+#include <soralog/shared_memory_ring.hpp>
+
+namespace soralog {
+  using namespace std::chrono_literals;
+
+  /**
+   * @class SinkToSharedMemory
+   * Sink passes events into lock-free ring in shared memory segment. Separate
+   * process (log agent) gets them from there and does all I/O. Producer
+   * formats event right into captured slot of ring and publishes it at once,
+   * so there is no queue in process and nothing is lost if it crashes after
+   * push. Event is dropped (and counted in segment) if the ring is full,
+   * because waiting for consumer would block logging process.
+   * Several processes might use the same segment (it must be configured with
+   * the same geometry), each record is tagged with pid.
+   * See tools/shm_consumer for reference consumer and collector.
+   */
+  class SinkToSharedMemory final : public Sink {
+   public:
+    SinkToSharedMemory() = delete;
+    SinkToSharedMemory(SinkToSharedMemory &&) noexcept = delete;
+    SinkToSharedMemory(const SinkToSharedMemory &) = delete;
+    SinkToSharedMemory &operator=(SinkToSharedMemory &&) noexcept = delete;
+    SinkToSharedMemory &operator=(const SinkToSharedMemory &) = delete;
+
+    /**
+     * @note {@param capacity}, {@param buffer_size} and {@param latency} are
+     * accepted for compatibility of configuration only: events aren't queued
+     */
+    SinkToSharedMemory(std::string name,
+                       Level level,
+                       std::string segment,
+                       std::optional<ThreadInfoType> thread_info_type = {},
+                       std::optional<size_t> capacity = {},
+                       std::optional<size_t> max_message_length = {},
+                       std::optional<size_t> buffer_size = {},
+                       std::optional<size_t> latency = {},
+                       std::optional<size_t> segment_capacity = {});
+    ~SinkToSharedMemory() override = default;
+
+    void rotate() noexcept override {};
+
+    void flush() noexcept override {};
+
+    /**
+     * @returns ring in shared memory, or nullptr if it is not opened
+     */
+    const std::unique_ptr<SharedMemoryRing> &ring() const noexcept {
+      return ring_;
+    }
+
+   protected:
+    void async_flush() noexcept override {};
+
+    DirectSlot claimDirect() noexcept override;
+
+    void publishDirect(const DirectSlot &slot,
+                       std::chrono::system_clock::time_point timestamp,
+                       std::string_view name,
+                       Level level,
+                       size_t message_size,
+                       uint64_t sequence) noexcept override;
+
+   private:
+    std::unique_ptr<SharedMemoryRing> ring_;
+  };
+
+}  // namespace soralog
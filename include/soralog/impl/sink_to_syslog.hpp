@@ -7,17 +7,13 @@
 
 #pragma once
 
-#include <soralog/sink.hpp>
-
-#include <condition_variable>
-#include <memory>
-#include <mutex>
-#include <thread>
+#include <soralog/batch_sink.hpp>
+#include <soralog/prefix_cache.hpp>
 
 namespace soralog {
   using namespace std::chrono_literals;
 
-  class SinkToSyslog final : public Sink {
+  class SinkToSyslog final : public BatchSink {
    public:
     SinkToSyslog() = delete;
     SinkToSyslog(SinkToSyslog &&) noexcept = delete;
@@ -32,32 +28,19 @@ namespace soralog {
                  std::optional<size_t> capacity = {},
                  std::optional<size_t> max_message_length = {},
                  std::optional<size_t> buffer_size = {},
-                 std::optional<size_t> latency = {});
+                 std::optional<size_t> latency = {},
+                 std::optional<bool> with_sequence = {},
+                 std::optional<size_t> shards = {},
+                 std::optional<bool> polled = {});
     ~SinkToSyslog() override;
 
-    void rotate() noexcept override {};
-
-    void flush() noexcept override;
-
    protected:
-    void async_flush() noexcept override;
+    void write(const Batch &events, std::vector<char> &buffer) override;
 
    private:
-    void run();
-
     static std::atomic_bool syslog_is_opened_;
     const std::string ident_;
-
-    std::unique_ptr<std::thread> sink_worker_{};
-
-    std::vector<char> buff_;
-    std::mutex mutex_;
-    std::condition_variable condvar_;
-    std::atomic_bool need_to_finalize_ = false;
-    std::atomic_bool need_to_flush_ = false;
-    std::atomic<std::chrono::steady_clock::time_point> next_flush_ =
-        std::chrono::steady_clock::time_point();
-    std::atomic_flag flush_in_progress_ = false;
+    PrefixCache prefixes_;
   };
 
 }  // namespace soralog
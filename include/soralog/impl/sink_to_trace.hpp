@@ -0,0 +1,94 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/batch_sink.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+#include <fmt/format.h>
+
+namespace soralog {
+
+  /**
+   * @class SinkToTrace
+   * Sink writes events into file in Chrome Trace Event format (JSON array),
+   * which can be opened by Perfetto UI or chrome://tracing.
+   * Events marked by SL_SPAN_BEGIN and SL_SPAN_END become begin and end of
+   * span, events of SL_SCOPE_TIMER become complete span (by kind of span
+   * kept in event), others become instant events. Tracks are threads of
+   * events (thread info is needed). Array is closed when file is rotated or
+   * sink is destroyed. Existing trace file is continued: closing bracket of
+   * its array is dropped and new records are appended, so trace of previous
+   * run or of rotation without moving of file isn't lost.
+   */
+  class SinkToTrace final : public BatchSink {
+   public:
+    SinkToTrace() = delete;
+    SinkToTrace(SinkToTrace &&) noexcept = delete;
+    SinkToTrace(const SinkToTrace &) = delete;
+    SinkToTrace &operator=(SinkToTrace &&) noexcept = delete;
+    SinkToTrace &operator=(const SinkToTrace &) = delete;
+
+    SinkToTrace(std::string name,
+                Level level,
+                std::filesystem::path path,
+                std::optional<ThreadInfoType> thread_info_type = {},
+                std::optional<size_t> capacity = {},
+                std::optional<size_t> max_message_length = {},
+                std::optional<size_t> buffer_size = {},
+                std::optional<size_t> latency = {},
+                std::optional<size_t> shards = {},
+                std::optional<bool> polled = {});
+    ~SinkToTrace() override;
+
+   protected:
+    void write(const Batch &events, std::vector<char> &buffer) override;
+
+    void sync() noexcept override;
+
+    void reopen() noexcept override;
+
+   private:
+    /// State of file after it's prepared to be continued
+    enum class Resumed {
+      NEW,        ///< file is absent or empty; array must be started
+      EMPTY,      ///< array is opened, but has no records
+      CONTINUED,  ///< array has records; next one is after comma
+    };
+
+    /**
+     * Opens file and starts JSON array, or continues existing one
+     */
+    void open();
+
+    /**
+     * Drops closing bracket of JSON array of existing file
+     * @returns state of file, or nothing if file can't be continued
+     */
+    std::optional<Resumed> resume();
+
+    /**
+     * Finishes JSON array and closes file
+     */
+    void close();
+
+    void render(const Event &event);
+
+    const std::filesystem::path path_;
+    const int pid_;
+
+    std::ofstream out_{};
+    bool is_first_record_ = true;
+    std::unordered_set<size_t> named_threads_;
+    fmt::memory_buffer records_;
+  };
+
+}  // namespace soralog
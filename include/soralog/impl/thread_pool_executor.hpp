@@ -0,0 +1,64 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/executor.hpp>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace soralog {
+
+  /**
+   * @class ThreadPoolExecutor
+   * Executor owning plain pool of threads. Delayed tasks are kept in heap by
+   * deadline; idle threads sleep without deadline.
+   * Tasks which are ready at destruction are done, delayed ones are dropped
+   */
+  class ThreadPoolExecutor final : public Executor {
+   public:
+    ThreadPoolExecutor() = delete;
+
+    /**
+     * @param name is used for naming of threads
+     * @param threads is number of threads (at least one)
+     */
+    ThreadPoolExecutor(const std::string &name, size_t threads = 1);
+    ~ThreadPoolExecutor() override;
+
+    void post(Task task) override;
+
+    void postAfter(Duration delay, Task task) override;
+
+   private:
+    struct DelayedTask {
+      std::chrono::steady_clock::time_point deadline;
+      Task task;
+
+      // Ordering for heap with the nearest deadline on top
+      bool operator<(const DelayedTask &other) const noexcept {
+        return deadline > other.deadline;
+      }
+    };
+
+    void run(const std::string &name);
+
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable condvar_;
+    std::deque<Task> ready_;
+    std::vector<DelayedTask> delayed_;
+    bool stop_ = false;
+  };
+
+}  // namespace soralog
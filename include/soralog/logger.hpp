@@ -47,7 +47,7 @@ namespace soralog {
       if (level_ >= level) {
         if (level != Level::OFF and level != Level::IGNORE) {
           sink_->push(name_, level, format, args...);
-          if (level_ >= Level::CRITICAL) {
+          if (level == Level::CRITICAL) {
             sink_->flush();
           }
         }
@@ -16,6 +16,7 @@
 #include <string>
 
 #include <soralog/configurator.hpp>
+#include <soralog/executor.hpp>
 
 namespace soralog {
 
@@ -37,7 +38,14 @@ namespace soralog {
     LoggingSystem(LoggingSystem &&tmp) noexcept = delete;
     LoggingSystem &operator=(LoggingSystem &&tmp) noexcept = delete;
 
-    explicit LoggingSystem(std::shared_ptr<Configurator> configurator);
+    /**
+     * @param configurator sets up logging system
+     * @param executor runs flushes (and other background work, like
+     * rendering in parallel) of created sinks instead of their own threads;
+     * if it's empty, sinks start workers
+     */
+    explicit LoggingSystem(std::shared_ptr<Configurator> configurator,
+                           std::shared_ptr<Executor> executor = {});
 
     /**
      * Call configurator to setup logging system for work
@@ -111,12 +119,22 @@ namespace soralog {
      */
     [[nodiscard]] std::shared_ptr<Group> getGroup(const std::string &name);
 
+    /**
+     * Writes out up to {@param budget} events of polled sinks, which have no
+     * workers; application calls it from its own loop or idle hook. Sinks
+     * are polled in turn starting from the next one each call, so busy sink
+     * doesn't starve others
+     * @returns number of written events
+     */
+    size_t poll(size_t budget);
+
     /**
      * Creates sink with type {@tparam SinkType} using arguments {@param args}
      */
     template <typename SinkType, typename... Args>
     std::shared_ptr<SinkType> makeSink(Args &&...args) {
       std::lock_guard guard(mutex_);
+      Executor::Scope scope(executor_);
       auto sink = std::make_shared<SinkType>(std::forward<Args>(args)...);
       sinks_[sink->name()] = sink;
       return sink;
@@ -274,11 +292,14 @@ namespace soralog {
                                  std::optional<Level> level);
 
     std::shared_ptr<Configurator> configurator_;
+    std::shared_ptr<Executor> executor_;
     bool is_configured_ = false;
     std::recursive_mutex mutex_;
     std::unordered_map<std::string, std::weak_ptr<Logger>> loggers_;
     std::unordered_map<std::string, std::shared_ptr<Sink>> sinks_;
     std::unordered_map<std::string, std::shared_ptr<Group>> groups_;
+    // Sink which next poll starts from
+    size_t poll_cursor_ = 0;
   };
 
 }  // namespace soralog
@@ -7,7 +7,10 @@
 
 #pragma once
 
+#include <fmt/compile.h>
+
 #include <soralog/logger.hpp>
+#include <soralog/scope_timer.hpp>
 
 /**
  * SL_LOG
@@ -18,6 +21,11 @@
  * SL_WARN
  * SL_ERROR
  * SL_CRITICAL
+ *
+ * SL_SCOPE_TIMER
+ * SL_SCOPE_HISTOGRAM
+ * SL_SPAN_BEGIN
+ * SL_SPAN_END
  */
 
 #define _SL_LOG_IF_LEVEL(LOG, LVL, FMT, ...)                 \
@@ -29,8 +37,10 @@
     }                                                        \
   })
 
+// String-literal format is parsed in compile-time, so only arguments are
+// written in runtime (with fmt 10 or later; see formatMessage)
 #define _SL_LOG(LOG, LVL, FMT, ...) \
-  _SL_LOG_IF_LEVEL((LOG), (LVL), (FMT), ##__VA_ARGS__)
+  _SL_LOG_IF_LEVEL((LOG), (LVL), FMT_COMPILE(FMT), ##__VA_ARGS__)
 
 #define SL_LOG(LOG, LVL, FMT, ...) _SL_LOG((LOG), (LVL), (FMT), ##__VA_ARGS__)
 
@@ -100,7 +110,7 @@ endif()
 
 #ifndef WITHOUT_TRACE_LOG_LEVEL
 #define SL_TRACE_DF(LOG, FMT, ...) \
-  _SL_LOG((LOG), soralog::Level::TRACE, (FMT), ##__VA_ARGS__)
+  _SL_LOG_DF((LOG), soralog::Level::TRACE, (FMT), ##__VA_ARGS__)
 #else
 #define SL_TRACE_DF(LOG, FMT, ...)
 #endif
@@ -126,3 +136,57 @@ endif()
 
 #define SL_CRITICAL_DF(LOG, FMT, ...) \
   _SL_LOG_DF((LOG), soralog::Level::CRITICAL, (FMT), ##__VA_ARGS__)
+
+// Macros for measuring of scope duration. Timer is started by macro and
+// stopped at the end of scope. Clock isn't read if level is not enough.
+// SL_SCOPE_TIMER logs event with duration of each pass of scope;
+// SL_SCOPE_HISTOGRAM aggregates durations of all passes by site into
+// histogram and periodically logs its summary (count, avg, p50/p90/p99, max)
+
+#define _SL_CONCAT_IMPL(A, B) A##B
+#define _SL_CONCAT(A, B) _SL_CONCAT_IMPL(A, B)
+
+#define SL_SCOPE_TIMER_LVL(LOG, LVL, NAME)                            \
+  soralog::ScopeTimer _SL_CONCAT(_sl_scope_timer_, __LINE__)((LOG), \
+                                                             (LVL), \
+                                                             (NAME))
+
+#define SL_SCOPE_HISTOGRAM_LVL(LOG, LVL, NAME)                        \
+  static soralog::LatencyHistogram _SL_CONCAT(_sl_scope_histogram_,   \
+                                              __LINE__)((NAME));      \
+  soralog::ScopeTimer _SL_CONCAT(_sl_scope_timer_, __LINE__)(         \
+      (LOG), (LVL), _SL_CONCAT(_sl_scope_histogram_, __LINE__))
+
+#ifndef WITHOUT_DEBUG_LOG_LEVEL
+#define SL_SCOPE_TIMER(LOG, NAME) \
+  SL_SCOPE_TIMER_LVL((LOG), soralog::Level::DEBUG, (NAME))
+#else
+#define SL_SCOPE_TIMER(LOG, NAME)
+#endif
+
+#define SL_SCOPE_HISTOGRAM(LOG, NAME) \
+  SL_SCOPE_HISTOGRAM_LVL((LOG), soralog::Level::INFO, (NAME))
+
+// Macros for marking of begin and end of span on timeline of thread.
+// Kind of span is kept in event, so trace sink renders it as span, while
+// others render message as usual
+
+#ifndef WITHOUT_DEBUG_LOG_LEVEL
+#define SL_SPAN_BEGIN(LOG, NAME)                                          \
+  _SL_LOG_IF_LEVEL((LOG),                                                 \
+                   soralog::Level::DEBUG,                                 \
+                   soralog::spanFormat(soralog::SpanKind::BEGIN,          \
+                                       FMT_COMPILE("{}{}")),              \
+                   soralog::span_begin_prefix,                            \
+                   (NAME))
+#define SL_SPAN_END(LOG, NAME)                                            \
+  _SL_LOG_IF_LEVEL((LOG),                                                 \
+                   soralog::Level::DEBUG,                                 \
+                   soralog::spanFormat(soralog::SpanKind::END,            \
+                                       FMT_COMPILE("{}{}")),              \
+                   soralog::span_end_prefix,                              \
+                   (NAME))
+#else
+#define SL_SPAN_BEGIN(LOG, NAME)
+#define SL_SPAN_END(LOG, NAME)
+#endif
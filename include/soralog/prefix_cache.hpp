@@ -0,0 +1,93 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include <soralog/level.hpp>
+
+namespace soralog {
+
+  /**
+   * @class PrefixCache
+   * Keeps rendered prefixes of records, i.e. part of record with level,
+   * logger name, separators and styles around them, which is the same for
+   * all events of some logger with some level. So prefix is rendered once
+   * and then just copied. Cache is direct-mapped: entry is selected by hash
+   * of logger name and level, and is replaced by another one on collision.
+   */
+  class PrefixCache final {
+   public:
+    /// Max size of rendered prefix
+    static constexpr size_t max_prefix_size = 128;
+
+    /// Max length of logger name which prefix can be cached for
+    static constexpr size_t max_name_size = 32;
+
+    /// Number of entries
+    static constexpr size_t capacity_bits = 6;
+    static constexpr size_t capacity = 1u << capacity_bits;
+
+    /**
+     * @returns prefix for events of logger {@param name} with {@param level};
+     * prefix is rendered by {@param render} (called as render(char *&ptr) and
+     * must not put more than max_prefix_size bytes), if it is not cached yet
+     */
+    template <typename Render>
+    std::string_view get(std::string_view name,
+                         Level level,
+                         const Render &render) noexcept {
+      auto &entry = entries_[index(name, level)];  // NOLINT
+
+      if (not entry.is_valid or entry.level != level
+          or entry.name_size != name.size()
+          or std::memcmp(entry.name.data(), name.data(), name.size()) != 0) {
+        auto *ptr = entry.prefix.data();
+        render(ptr);
+        entry.prefix_size = ptr - entry.prefix.data();
+        // Prefix of too long name is rendered each time
+        entry.is_valid = name.size() <= max_name_size;
+        entry.name_size = std::min(name.size(), max_name_size);
+        std::memcpy(entry.name.data(), name.data(), entry.name_size);
+        entry.level = level;
+      }
+      return {entry.prefix.data(), entry.prefix_size};
+    }
+
+   private:
+    /**
+     * @returns index of entry for {@param name} and {@param level}. Hash is
+     * made by length and edge bytes of name only, because it is computed for
+     * each event, and entry is checked by whole name anyway
+     */
+    static size_t index(std::string_view name, Level level) noexcept {
+      uint64_t key = name.size() << 16 | static_cast<uint8_t>(level);
+      if (not name.empty()) {
+        key |= static_cast<uint64_t>(static_cast<uint8_t>(name.front())) << 24
+             | static_cast<uint64_t>(static_cast<uint8_t>(name.back())) << 32;
+      }
+      return (key * 0x9e3779b97f4a7c15) >> (64 - capacity_bits);
+    }
+
+    struct Entry {
+      bool is_valid = false;
+      Level level = Level::OFF;
+      size_t name_size = 0;
+      size_t prefix_size = 0;
+      std::array<char, max_name_size> name{};
+      std::array<char, max_prefix_size> prefix{};
+    };
+
+    std::array<Entry, capacity> entries_;
+  };
+
+}  // namespace soralog
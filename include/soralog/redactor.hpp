@@ -0,0 +1,97 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace soralog {
+
+  /**
+   * @class Redactor
+   * Masks secrets in rendered text. All patterns are compiled once into
+   * Aho-Corasick automaton (dense DFA), so text is scanned in one pass with
+   * one table lookup per byte, independently of number of patterns.
+   * Patterns are literals; found match defines which part of text is masked
+   * (see Mask). Masked bytes are replaced in place, so length is kept.
+   */
+  class Redactor final {
+   public:
+    /// Character which replaces masked bytes
+    static constexpr char mask_char = '*';
+
+    /**
+     * Part of text which is masked when pattern is found
+     */
+    enum class Mask : uint8_t {
+      MATCH,  //!< Found literal itself
+      WORD,   //!< Whole word containing literal (e.g. e-mail by "@")
+      VALUE,  //!< Word following literal (e.g. token by "token=")
+    };
+
+    struct Pattern {
+      std::string text;
+      Mask mask = Mask::MATCH;
+    };
+
+    Redactor() = delete;
+    Redactor(Redactor &&) noexcept = delete;
+    Redactor(const Redactor &) = delete;
+    ~Redactor() = default;
+    Redactor &operator=(Redactor &&) noexcept = delete;
+    Redactor &operator=(const Redactor &) = delete;
+
+    /**
+     * Compiles {@param patterns}
+     * @throws std::invalid_argument if some pattern is empty
+     */
+    explicit Redactor(std::vector<Pattern> patterns);
+
+    /**
+     * Masks secrets in text from {@param begin} to {@param end}
+     * @returns number of found patterns
+     */
+    size_t redact(char *begin, char *end) const noexcept;
+
+   private:
+    using State = uint32_t;
+
+    /// Pattern is not found in state
+    static constexpr uint32_t no_pattern = UINT32_MAX;
+
+    static bool isDelimiter(char c) noexcept;
+
+    /// Flag of state in transition, which means some pattern ends there
+    static constexpr State has_output = 1u << 31;
+
+    State next(State state, char c) const noexcept {
+      return transitions_[(state & ~has_output) * 256
+                          + static_cast<uint8_t>(c)];
+    }
+
+    /**
+     * @returns position of first byte from {@param ptr} to {@param end},
+     * which can start some pattern, or {@param end}
+     */
+    char *skip(char *ptr, char *end) const noexcept;
+
+    std::vector<Pattern> patterns_;
+    // Next state by state and byte
+    std::vector<State> transitions_;
+    // Longest pattern ending in state
+    std::vector<uint32_t> outputs_;
+    // Bytes which move automaton out of initial state
+    std::array<bool, 256> starts_{};
+    // The only such byte, if all patterns start with the same one
+    char single_start_ = 0;
+    bool is_single_start_ = false;
+  };
+
+}  // namespace soralog
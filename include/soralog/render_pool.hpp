@@ -0,0 +1,100 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <soralog/executor.hpp>
+
+namespace soralog {
+
+  /**
+   * @class RenderPool
+   * Small pool of threads for parallel rendering of events by sink.
+   * Work is split into numbered tasks; results of them are consumed strictly
+   * in order of numbers by calling thread (which executes tasks too), so
+   * output is the same as it would be with serial processing.
+   * If executor is set while pool is created, pool has no threads: helping
+   * tasks are posted to executor for each job instead.
+   */
+  class RenderPool final {
+   public:
+    using Task = std::function<void(size_t)>;
+
+    RenderPool() = delete;
+    RenderPool(RenderPool &&) noexcept = delete;
+    RenderPool(const RenderPool &) = delete;
+    RenderPool &operator=(RenderPool &&) noexcept = delete;
+    RenderPool &operator=(const RenderPool &) = delete;
+
+    /**
+     * @param name is used for naming of threads
+     * @param threads is number of additional threads (or helping tasks of
+     * executor)
+     */
+    RenderPool(const std::string &name, size_t threads);
+    ~RenderPool();
+
+    /**
+     * @returns number of threads doing tasks, including calling one
+     */
+    size_t concurrency() const noexcept {
+      return helpers_ + 1;
+    }
+
+    /**
+     * Executes {@param task} for each number in [0, {@param count}) in
+     * parallel, and calls {@param consume} in calling thread for each number
+     * in ascending order as soon as corresponding task is done.
+     * Returns when all tasks are done and consumed
+     */
+    void process(size_t count, const Task &task, const Task &consume);
+
+   private:
+    void run(const std::string &name);
+
+    /**
+     * Helping task on executor: executes tasks of current job
+     */
+    void help();
+
+    /**
+     * Takes and executes next task of current job
+     * @returns false if there is no more task
+     */
+    bool execute();
+
+    const size_t helpers_;
+    std::vector<std::thread> threads_;
+
+    // Executor running helping tasks instead of threads
+    std::shared_ptr<Executor> executor_{};
+    std::vector<std::shared_ptr<Executor::WakeHandle>> posted_{};
+    size_t helped_ = 0;  // number of finished helping tasks
+
+    std::mutex mutex_;
+    std::condition_variable job_condvar_;
+    std::condition_variable done_condvar_;
+    const Task *task_ = nullptr;
+    size_t count_ = 0;
+    std::atomic_size_t next_ = 0;
+    std::unique_ptr<std::atomic_bool[]> done_;
+    size_t done_capacity_ = 0;
+    size_t generation_ = 0;
+    size_t active_ = 0;
+    bool stop_ = false;
+  };
+
+}  // namespace soralog
@@ -0,0 +1,242 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include <fmt/compile.h>
+
+#include <soralog/event.hpp>
+#include <soralog/level.hpp>
+
+namespace soralog {
+
+  /**
+   * @class LatencyHistogram
+   * Lock-free histogram of durations of some code site. Buckets are powers
+   * of two of nanoseconds, so percentiles are upper bounds of buckets.
+   * It's intended to be static object per site (see SL_SCOPE_HISTOGRAM)
+   */
+  class LatencyHistogram final {
+   public:
+    // Monotonic, so durations aren't affected by adjusting of wall clock
+    using Clock = std::chrono::steady_clock;
+
+    /// Bucket N keeps durations in [2^N, 2^(N+1)) ns; the last one - others
+    static constexpr size_t buckets = 48;
+
+    static constexpr std::chrono::seconds default_period{10};
+
+    struct Summary {
+      uint64_t count;
+      std::chrono::nanoseconds avg;
+      std::chrono::nanoseconds p50;
+      std::chrono::nanoseconds p90;
+      std::chrono::nanoseconds p99;
+      std::chrono::nanoseconds max;
+    };
+
+    LatencyHistogram() = delete;
+    LatencyHistogram(LatencyHistogram &&) noexcept = delete;
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    ~LatencyHistogram() = default;
+    LatencyHistogram &operator=(LatencyHistogram &&) noexcept = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    /**
+     * @param name of site; must outlive histogram (e.g. string literal)
+     * @param period between dumps of summary
+     */
+    explicit LatencyHistogram(std::string_view name,
+                              Clock::duration period = default_period)
+        : name_(name),
+          period_(period),
+          next_dump_(Clock::now().time_since_epoch().count() + period.count()) {
+    }
+
+    std::string_view name() const noexcept {
+      return name_;
+    }
+
+    void record(std::chrono::nanoseconds duration) noexcept {
+      const auto ns = static_cast<uint64_t>(std::max<int64_t>(
+          duration.count(), 0));
+      size_t bucket = ns == 0 ? 0 : 63 - __builtin_clzll(ns);
+      bucket = std::min(bucket, buckets - 1);
+      buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+      count_.fetch_add(1, std::memory_order_relaxed);
+      total_.fetch_add(ns, std::memory_order_relaxed);
+      auto max = max_.load(std::memory_order_relaxed);
+      while (ns > max
+             and not max_.compare_exchange_weak(
+                 max, ns, std::memory_order_relaxed)) {
+      }
+    }
+
+    /**
+     * Checks if it's time to dump summary. Returns true only for one caller
+     * per period
+     */
+    bool isTimeToDump(Clock::time_point now) noexcept {
+      auto next = next_dump_.load(std::memory_order_relaxed);
+      const auto current = now.time_since_epoch().count();
+      if (current < next) {
+        return false;
+      }
+      return next_dump_.compare_exchange_strong(
+          next, current + period_.count(), std::memory_order_relaxed);
+    }
+
+    /**
+     * Takes summary of durations recorded since previous call and resets
+     * histogram. Concurrent records might get into any of two periods
+     */
+    Summary collect() noexcept {
+      std::array<uint64_t, buckets> counts{};
+      uint64_t count = 0;
+      for (size_t i = 0; i < buckets; ++i) {
+        counts[i] = buckets_[i].exchange(0, std::memory_order_relaxed);
+        count += counts[i];
+      }
+      count_.fetch_sub(count, std::memory_order_relaxed);
+      const auto total = total_.exchange(0, std::memory_order_relaxed);
+      const auto max = max_.exchange(0, std::memory_order_relaxed);
+
+      auto percentile = [&](uint64_t permille) {
+        const auto rank = (count * permille + 999) / 1000;
+        uint64_t accumulated = 0;
+        for (size_t i = 0; i < buckets; ++i) {
+          accumulated += counts[i];
+          if (accumulated >= rank and accumulated != 0) {
+            // Upper bound of bucket, but not more than real maximum
+            return std::chrono::nanoseconds(
+                std::min<uint64_t>((uint64_t{2} << i) - 1, max));
+          }
+        }
+        return std::chrono::nanoseconds(max);
+      };
+
+      Summary summary;
+      summary.count = count;
+      summary.avg = std::chrono::nanoseconds(count == 0 ? 0 : total / count);
+      summary.p50 = percentile(500);
+      summary.p90 = percentile(900);
+      summary.p99 = percentile(990);
+      summary.max = std::chrono::nanoseconds(max);
+      return summary;
+    }
+
+    /**
+     * @returns number of durations recorded since last collecting
+     */
+    uint64_t count() const noexcept {
+      return count_.load(std::memory_order_relaxed);
+    }
+
+   private:
+    const std::string_view name_;
+    const Clock::duration period_;
+    std::atomic<Clock::rep> next_dump_;
+    std::array<std::atomic<uint64_t>, buckets> buckets_{};
+    std::atomic<uint64_t> count_ = 0;
+    std::atomic<uint64_t> total_ = 0;
+    std::atomic<uint64_t> max_ = 0;
+  };
+
+  /**
+   * @class ScopeTimer
+   * Measures time of scope. At the end of scope it either logs event with
+   * duration, or records duration into histogram and periodically logs its
+   * summary. Nothing is measured if logger's level is not enough.
+   * Logger is referred without taking ownership, so it must outlive timer,
+   * as it usually does for scope. Use it by macros SL_SCOPE_TIMER and
+   * SL_SCOPE_HISTOGRAM
+   */
+  template <typename LoggerPtr>
+  class ScopeTimer final {
+   public:
+    using Clock = LatencyHistogram::Clock;
+
+    ScopeTimer() = delete;
+    ScopeTimer(ScopeTimer &&) noexcept = delete;
+    ScopeTimer(const ScopeTimer &) = delete;
+    ScopeTimer &operator=(ScopeTimer &&) noexcept = delete;
+    ScopeTimer &operator=(const ScopeTimer &) = delete;
+
+    /**
+     * @param name of scope; must outlive timer (e.g. string literal)
+     */
+    ScopeTimer(const LoggerPtr &log, Level level, std::string_view name)
+        : log_(&*log), level_(level), name_(name) {
+      if (log_->level() >= level_) {
+        start_ = Clock::now();
+      }
+    }
+
+    ScopeTimer(const LoggerPtr &log, Level level, LatencyHistogram &histogram)
+        : log_(&*log),
+          level_(level),
+          name_(histogram.name()),
+          histogram_(&histogram) {
+      if (log_->level() >= level_) {
+        start_ = Clock::now();
+      }
+    }
+
+    ~ScopeTimer() {
+      if (start_ == Clock::time_point{}) {
+        return;
+      }
+      const auto end = Clock::now();
+      const auto duration =
+          std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_);
+
+      if (histogram_ == nullptr) {
+        // Event is complete span, which is ended now
+        log_->log(level_,
+                  spanFormat(SpanKind::COMPLETE,
+                             FMT_COMPILE("{} took {:.3f} ms"),
+                             duration,
+                             name_.size()),
+                  name_,
+                  static_cast<double>(duration.count()) / 1e6);
+        return;
+      }
+
+      histogram_->record(duration);
+      if (histogram_->isTimeToDump(end)) {
+        auto summary = histogram_->collect();
+        log_->log(level_,
+                  "{}: count={} avg={:.3f}ms p50<={:.3f}ms p90<={:.3f}ms "
+                  "p99<={:.3f}ms max={:.3f}ms",
+                  name_,
+                  summary.count,
+                  static_cast<double>(summary.avg.count()) / 1e6,
+                  static_cast<double>(summary.p50.count()) / 1e6,
+                  static_cast<double>(summary.p90.count()) / 1e6,
+                  static_cast<double>(summary.p99.count()) / 1e6,
+                  static_cast<double>(summary.max.count()) / 1e6);
+      }
+    }
+
+   private:
+    // Copying of smart pointer would cost atomic increment per scope
+    decltype(&*std::declval<const LoggerPtr &>()) const log_;
+    const Level level_;
+    const std::string_view name_;
+    LatencyHistogram *const histogram_ = nullptr;
+    Clock::time_point start_{};
+  };
+
+}  // namespace soralog
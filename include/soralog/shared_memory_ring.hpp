@@ -0,0 +1,279 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <soralog/event.hpp>
+#include <soralog/level.hpp>
+
+#ifdef NDEBUG
+#define IF_RELEASE true
+#else
+#define IF_RELEASE false
+#endif
+
+namespace soralog {
+
+  /**
+   * @class SharedMemoryRing
+   * Lock-free ring of log records placed in named POSIX shared memory segment
+   * (i.e. file in /dev/shm). Records are put by sinks of one or several
+   * logging processes and got by separated process (log agent), which does
+   * I/O. Data stay in segment if logging process crashes, and can be read
+   * after that.
+   * Ring is bounded MPMC queue by D.Vyukov: each slot has own sequence number
+   * using to pass slot between producers and consumers without any lock.
+   * Producer tags free slot by token of own process (pid and start time)
+   * before capturing of it, so captured slot always has known owner. Slot
+   * captured by producer which has disappeared before publishing of record
+   * would stall the ring; consumer skips such slot by skipAbandoned().
+   * Slot of live producer is never skipped, because producer might still
+   * write into it; consumer could only report such stall (stalledBy()).
+   */
+  class SharedMemoryRing final {
+   public:
+    /**
+     * Log event record as it is placed in slot of ring.
+     * Message is placed right after record in the same slot.
+     */
+    struct Record final {
+      int64_t timestamp;  ///< Nanoseconds since epoch of system clock
+      uint64_t thread_number;
+      uint64_t sequence;  ///< Number of event in sink; gaps mean lost events
+      uint32_t message_size;
+      uint32_t pid;  ///< Id of process which produced record
+      Level level;
+      uint8_t thread_name_size;
+      uint8_t name_size;
+      std::array<char, 16> thread_name;
+      std::array<char, 32> name;
+
+      /**
+       * @returns time when event is happened
+       */
+      std::chrono::system_clock::time_point time() const noexcept {
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                std::chrono::nanoseconds(timestamp)));
+      }
+
+      /**
+       * @returns name of thread which the event was created in
+       */
+      std::string_view threadName() const noexcept {
+        return {thread_name.data(),
+                std::min<size_t>(thread_name_size, thread_name.size())};
+      }
+
+      /**
+       * @returns name of logger through which the event was created
+       */
+      std::string_view loggerName() const noexcept {
+        return {name.data(), std::min<size_t>(name_size, name.size())};
+      }
+    };
+
+   private:
+    struct Header;
+    struct Slot;
+
+   public:
+    /**
+     * Reference to captured record. Slot is released on destruction
+     */
+    class RecordRef {
+      Slot *slot_ = nullptr;
+      uint64_t release_sequence_ = 0;
+      size_t max_message_length_ = 0;
+
+     public:
+      RecordRef() noexcept = default;
+      RecordRef(RecordRef &&) noexcept = delete;
+      RecordRef(const RecordRef &) = delete;
+      RecordRef &operator=(RecordRef &&) noexcept = delete;
+      RecordRef &operator=(const RecordRef &) = delete;
+
+      RecordRef(Slot &slot,
+                uint64_t release_sequence,
+                size_t max_message_length) noexcept
+          : slot_(&slot),
+            release_sequence_(release_sequence),
+            max_message_length_(max_message_length) {}
+
+      ~RecordRef() noexcept;
+
+      const Record &operator*() const noexcept(IF_RELEASE);
+
+      const Record *operator->() const noexcept(IF_RELEASE) {
+        return &**this;
+      }
+
+      /**
+       * @returns message of event
+       */
+      std::string_view message() const noexcept(IF_RELEASE);
+
+      explicit operator bool() const noexcept {
+        return slot_ != nullptr;
+      }
+    };
+
+    SharedMemoryRing() = delete;
+    SharedMemoryRing(SharedMemoryRing &&) noexcept = delete;
+    SharedMemoryRing(const SharedMemoryRing &) = delete;
+    SharedMemoryRing &operator=(SharedMemoryRing &&) noexcept = delete;
+    SharedMemoryRing &operator=(const SharedMemoryRing &) = delete;
+
+    /**
+     * Creates segment with name {@param name}, or attaches to existing one.
+     * Existing segment must have the same geometry: number of slots
+     * {@param capacity} (rounded up to power of two) and size of slot enough
+     * to place message with length {@param max_message_length}
+     * @throws std::system_error if segment can't be opened or mapped, and
+     * std::runtime_error if existing segment is incompatible
+     */
+    SharedMemoryRing(std::string name,
+                     size_t capacity,
+                     size_t max_message_length);
+
+    /**
+     * Attaches to existing segment with name {@param name}.
+     * Geometry is taken from segment
+     * @throws std::system_error if segment can't be opened or mapped, and
+     * std::runtime_error if segment is not a soralog ring
+     */
+    explicit SharedMemoryRing(std::string name);
+
+    ~SharedMemoryRing();
+
+    /**
+     * @returns name of segment
+     */
+    const std::string &name() const noexcept {
+      return name_;
+    }
+
+    /**
+     * @returns number of slots
+     */
+    size_t capacity() const noexcept;
+
+    /**
+     * @returns max length of message which could be placed into slot
+     */
+    size_t maxMessageLength() const noexcept;
+
+    /**
+     * @returns approximate number of records in the ring
+     */
+    size_t size() const noexcept;
+
+    /**
+     * @returns number of records which were not put because ring was full
+     */
+    uint64_t dropped() const noexcept;
+
+    /**
+     * @returns number of slots skipped because producer had disappeared
+     * before publishing of record
+     */
+    uint64_t abandoned() const noexcept;
+
+    /**
+     * Free slot captured by producer to write record right into it
+     */
+    struct Claim final {
+      Record *record = nullptr;
+      char *message = nullptr;  ///< Storage for message of max length
+      uint64_t position = 0;
+
+      explicit operator bool() const noexcept {
+        return record != nullptr;
+      }
+    };
+
+    /**
+     * Captures free slot; record of it is tagged with id of this process,
+     * the rest fields and message are written by caller
+     * @returns empty claim (and counts record as dropped) if ring is full
+     */
+    [[nodiscard]] Claim claim() noexcept;
+
+    /**
+     * Publishes record written into {@param claim} for consumer
+     * @returns false (and counts record as dropped) if slot is not owned by
+     * the claim anymore
+     */
+    bool publish(const Claim &claim) noexcept;
+
+    /**
+     * Places data of {@param event} with its {@param sequence} number into
+     * free slot.
+     * @returns false (and count record as dropped) if ring is full
+     */
+    bool put(const Event &event, uint64_t sequence) noexcept;
+
+    /**
+     * Captures the oldest record
+     * @returns empty reference if ring is empty
+     */
+    [[nodiscard]] RecordRef get() noexcept;
+
+    /**
+     * Checks the oldest slot, which is captured by producer, but isn't
+     * published yet. Slot is skipped if process of producer does not exist
+     * anymore, otherwise it's remembered as stalled one
+     * @returns true if slot was skipped
+     * @note Should be called by consumer when get() returns nothing
+     */
+    bool skipAbandoned() noexcept;
+
+    /**
+     * Checks if the oldest slot found by last skipAbandoned() is not
+     * published by live producer during {@param timeout}
+     * @returns pid of such producer, or nothing if ring is not stalled
+     */
+    std::optional<uint32_t> stalledBy(
+        std::chrono::milliseconds timeout) const noexcept;
+
+    /**
+     * Removes segment with name {@param name} from the system. Processes
+     * which already have mapped it continue to work with it
+     * @returns true if success
+     */
+    static bool unlink(const std::string &name) noexcept;
+
+   private:
+    void map(int fd, size_t size);
+
+    Slot &slot(uint64_t position) const noexcept;
+
+    const std::string name_;
+    Header *header_ = nullptr;
+    size_t mapped_size_ = 0;
+    size_t mask_ = 0;
+    size_t slot_size_ = 0;
+    size_t max_message_length_ = 0;
+    const uint32_t pid_;
+    const uint64_t token_;
+
+    // Consumer side state to detect stalled slot
+    uint64_t stalled_position_ = 0;
+    uint32_t stalled_owner_ = 0;
+    std::chrono::steady_clock::time_point stalled_since_{};
+  };
+
+}  // namespace soralog
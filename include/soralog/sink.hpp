@@ -7,14 +7,18 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <thread>
 
 #include <fmt/format.h>
 
+#include <soralog/broadcast_buffer.hpp>
 #include <soralog/circular_buffer.hpp>
 #include <soralog/event.hpp>
+#include <soralog/event_counters.hpp>
 
 #ifdef NDEBUG
 #define IF_RELEASE true
@@ -52,6 +56,19 @@ namespace soralog {
       ID     //!< Log thread id
     };
 
+    /// Events of this level and more important are placed in separate small
+    /// queue, so they aren't held by filled main one, and sink is flushed
+    /// without delay. Queues are merged by time of events, so order is kept
+    static constexpr Level urgent_level = Level::ERROR;
+
+    /// Events queue isn't sharded by default, in spite of number of cores.
+    /// Capacity of queue is split among shards, so thread writing the most
+    /// of log (usual case) fills own shard and waits for flush K times more
+    /// often, and worker checks heads of all K shards to output each event.
+    /// Sharding pays back with many threads logging at once only; 0 (or
+    /// 'auto' in config) sets number of shards to number of cores
+    static constexpr size_t default_shards = 1;
+
     Sink() = delete;
     Sink(const Sink &) = delete;
     Sink(Sink &&) noexcept = delete;
@@ -65,32 +82,61 @@ namespace soralog {
          size_t max_events,
          size_t max_message_length,
          size_t max_buffer_size,
-         size_t latency)
+         size_t latency,
+         bool with_sequence = false,
+         size_t shards = default_shards)
         : name_(std::move(name)),
           level_(level),
           thread_info_type_(thread_info_type),
+          with_sequence_(with_sequence),
           max_message_length_(max_message_length),
           max_buffer_size_(max_buffer_size),
           latency_(latency),
-          events_(max_events, max_message_length) {
+          events_(
+              shardCapacity(max_events, resolveShards(shards, max_events)),
+              max_message_length,
+              0),
+          urgent_events_(std::clamp<size_t>(max_events / 8, 4, 256),
+                         max_message_length,
+                         resolveShards(shards, max_events)),
+          lane_sizes_(resolveShards(shards, max_events) + 1) {
       // Auto-fix buffer size
       if (max_buffer_size_ < max_message_length * 2) {
         // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast,-warnings-as-errors)
         const_cast<size_t &>(max_buffer_size_) = max_message_length * 2;
       }
+
+      // Additional shards of events queue; events_ is the first one
+      shards = resolveShards(shards, max_events);
+      if (shards > 1) {
+        shards_.reserve(shards - 1);
+        for (size_t i = 1; i < shards; ++i) {
+          shards_.emplace_back(std::make_unique<CircularBuffer<Event>>(
+              events_.capacity(), max_message_length, i));
+        }
+      }
+      // Heads of all shards and of urgent events
+      fronts_.resize(shards + 1);
     }
 
     Sink(std::string name,
          Level level,
-         std::vector<std::shared_ptr<Sink>> sinks)
+         std::vector<std::shared_ptr<Sink>> sinks,
+         std::shared_ptr<BroadcastBuffer<Event>> broadcast = {},
+         ThreadInfoType thread_info_type = ThreadInfoType::NONE,
+         size_t max_message_length = 0)
         : name_(std::move(name)),
           level_(level),
-          thread_info_type_(),
-          max_message_length_(),
+          thread_info_type_(thread_info_type),
+          with_sequence_(),
+          max_message_length_(max_message_length),
           max_buffer_size_(),
           latency_(),
           events_(0, 0),
-          underlying_sinks_(std::move(sinks)) {};
+          urgent_events_(0, 0),
+          lane_sizes_(1),
+          underlying_sinks_(std::move(sinks)),
+          broadcast_(std::move(broadcast)) {};
 
     /**
      * @returns name of sink
@@ -106,6 +152,20 @@ namespace soralog {
       return level_;
     }
 
+    /**
+     * @returns number of accepted events. Each event gets number of its
+     * place in queue (lane, i.e. shard or urgent queue, and sequence number
+     * in it), so gap in numbers of lane in sink output means lost events
+     */
+    uint64_t lastSequence() const noexcept {
+      auto sequence = sequence_.load(std::memory_order_relaxed)
+                    + events_.lastSequence() + urgent_events_.lastSequence();
+      for (const auto &shard : shards_) {
+        sequence += shard->lastSequence();
+      }
+      return sequence;
+    }
+
     /**
      * Emplaces new log event
      * @param name is name of logger
@@ -121,10 +181,30 @@ namespace soralog {
       if (level_ < level or level == Level::OFF or level == Level::IGNORE) {
         return;
       }
+      if (counters_) {
+        // Counting sink doesn't need rendered event
+        if constexpr (isStaticFormat<Format>()) {
+          auto site = formatToView(format);
+          counters_->count(name, level, {site.data(), site.size()});
+        } else {
+          counters_->count(name, level, EventCounters::dynamic_site);
+        }
+        // The first event after idle wakes up dumping of counters
+        unpark();
+        return;
+      }
+      if (direct_) {
+        pushDirect(name, level, format, args...);
+        return;
+      }
       if (underlying_sinks_.empty()) {
+        const bool urgent = level <= urgent_level;
+        const auto lane = urgent ? urgentLane() : laneOfThread();
+        auto &events = queueOf(lane);
+        size_t buffered = 0;
         while (true) {
           {
-            auto node = events_.put(name,
+            auto node = events.put(name,
                                     thread_info_type_,
                                     level,
                                     format,
@@ -133,7 +213,9 @@ namespace soralog {
 
             // Event is queued successfully
             LIKELY_IF((bool)node) {
-              size_ += node->message().size();
+              buffered = lane_sizes_[lane].bytes.fetch_add(
+                             node->message().size(), std::memory_order_relaxed)
+                       + node->message().size();
               break;
             }
           }
@@ -144,8 +226,59 @@ namespace soralog {
 
         if (latency_ == std::chrono::milliseconds::zero()) {
           flush();
-        } else if (size_ >= max_buffer_size_ * 4 / 5) {
+        } else if (urgent or isFilled(buffered)) {
           async_flush();
+        } else {
+          // The first event after idle arms deadline of flush
+          unpark();
+        }
+      } else if (broadcast_) {
+        // Counting and direct sinks don't read shared buffer
+        for (const auto &sink : underlying_sinks_) {
+          if (sink->counters_ or sink->direct_) {
+            sink->push(name, level, format, args...);
+          }
+        }
+
+        while (true) {
+          {
+            auto node = broadcast_->put(name,
+                                        thread_info_type_,
+                                        level,
+                                        format,
+                                        max_message_length_,
+                                        args...);
+
+            // Event is queued successfully
+            LIKELY_IF((bool)node) {
+              break;
+            }
+          }
+
+          if (broadcast_->policy()
+              == BroadcastBuffer<Event>::LagPolicy::DROP) {
+            return;
+          }
+
+          // The slowest sink is lagging. Flush immediately and try again
+          flush();
+        }
+
+        const bool urgent = level <= urgent_level;
+        const bool filled =
+            broadcast_->size() >= broadcast_->capacity() * 4 / 5;
+        for (const auto &sink : underlying_sinks_) {
+          if (sink->level_ < level and not filled) {
+            // Sink skips this event; place of it is reclaimed by next flush
+            continue;
+          }
+          if (sink->latency_ == std::chrono::milliseconds::zero()) {
+            sink->flush();
+          } else if (urgent or filled) {
+            sink->async_flush();
+          } else {
+            sink->unpark();
+          }
         }
       } else {
         for (const auto &sink : underlying_sinks_) {
@@ -169,18 +302,320 @@ namespace soralog {
      */
     virtual void rotate() noexcept = 0;
 
+    /**
+     * Writes out up to {@param budget} events, if sink is polled, i.e. it has
+     * no worker and application drives writing
+     * @returns number of written events
+     */
+    virtual size_t poll([[maybe_unused]] size_t budget) noexcept {
+      return 0;
+    }
+
    protected:
+    friend class Multisink;
+
+    /**
+     * Place in destination of direct sink, which producer writes event into
+     */
+    struct DirectSlot {
+      void *place = nullptr;    ///< Sink specific place of event
+      uint64_t tag = 0;         ///< Sink specific data of place
+      char *message = nullptr;  ///< Storage for message of max length
+    };
+
+    /**
+     * Captures place for event in destination of direct sink (see direct_)
+     * @returns slot without storage, if event can't be placed; it's dropped
+     */
+    virtual DirectSlot claimDirect() noexcept {
+      return {};
+    }
+
+    /**
+     * Completes event, which message of {@param message_size} is written
+     * into {@param slot}, by the rest data, and makes it visible for reader
+     */
+    virtual void publishDirect(
+        [[maybe_unused]] const DirectSlot &slot,
+        [[maybe_unused]] std::chrono::system_clock::time_point timestamp,
+        [[maybe_unused]] std::string_view name,
+        [[maybe_unused]] Level level,
+        [[maybe_unused]] size_t message_size,
+        [[maybe_unused]] uint64_t sequence) noexcept {}
+
+    /**
+     * Wakes up worker parked by park()
+     */
+    virtual void wakeUp() noexcept {}
+
+    /**
+     * Marks worker as parked, i.e. going to sleep without deadline, if there
+     * are no events and nothing is {@param requested} (called as bool()).
+     * Must be called under the same mutex as wakeUp() notifies under
+     * @returns true if worker may park
+     */
+    template <typename Requested>
+    bool park(const Requested &requested) noexcept {
+      is_parked_.store(true, std::memory_order_seq_cst);
+      // Pairs with pushing thread, which queues event and then checks flag,
+      // so either event is seen here or worker is woken up
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (hasEvents() or requested()) {
+        is_parked_.store(false, std::memory_order_relaxed);
+        return false;
+      }
+      return true;
+    }
+
+    /**
+     * Wakes up worker, if it's parked. Only the first caller after parking
+     * pays for notification
+     */
+    void unpark() noexcept {
+      if (is_parked_.load(std::memory_order_seq_cst)
+          and is_parked_.exchange(false, std::memory_order_acq_rel)) {
+        wakeUp();
+      }
+    }
+
+    /**
+     * Captures next event to write out. Urgent events are merged with the
+     * rest by time, so they don't outrun earlier ones
+     * @returns empty reference if there are no events
+     */
+    CircularBuffer<Event>::NodeRef nextEvent() noexcept(IF_RELEASE) {
+      if (auto *shared = shared_events_.load(std::memory_order_acquire)) {
+        while (auto node = shared->get(shared_consumer_)) {
+          // Multisink filters events by own level only
+          if (level_ < node->level()) {
+            continue;
+          }
+          // Count it as own to keep accounting of sink consistent
+          lane_sizes_[node.lane()].bytes.fetch_add(node->message().size(),
+                                                   std::memory_order_relaxed);
+          return node;
+        }
+      }
+      // Single queue is read as is, while there is nothing to merge with
+      if (shards_.empty() and urgent_events_.empty()
+          and held_.load(std::memory_order_relaxed) == 0) {
+        return events_.get();
+      }
+      return nextMergedEvent();
+    }
+
+    /**
+     * Accounts event of {@param node} as written out; it doesn't occupy
+     * buffer anymore
+     */
+    void accountWritten(const CircularBuffer<Event>::NodeRef &node) noexcept {
+      lane_sizes_[node.lane()].bytes.fetch_sub(node->message().size(),
+                                               std::memory_order_relaxed);
+    }
+
+    /**
+     * @returns message of {@param event} cut to max message length of this
+     * sink. Event shared by broadcasting multisink is formatted by the
+     * longest limit among its sinks, so it might exceed limit of this one
+     */
+    std::string_view messageOf(const Event &event) const noexcept {
+      auto message = event.message();
+      return {message.data(), std::min(message.size(), max_message_length_)};
+    }
+
+    /**
+     * @returns true if some events are waiting for writing
+     */
+    bool hasEvents() const noexcept {
+      if (auto *shared = shared_events_.load(std::memory_order_acquire)) {
+        if (shared->pending(shared_consumer_) != 0) {
+          return true;
+        }
+      }
+      for (const auto &shard : shards_) {
+        if (not shard->empty()) {
+          return true;
+        }
+      }
+      if (not events_.empty() or not urgent_events_.empty()) {
+        return true;
+      }
+      // Checked after queues: drainer counts head before taking it out of
+      // queue, so event is seen at least in one place. Heads themselves are
+      // touched by drainer only
+      return held_.load(std::memory_order_acquire) != 0;
+    }
+
+    /**
+     * Size of events buffered in one lane (shard or urgent queue). Each lane
+     * has own counter in own cache line, so producers of different shards
+     * don't contend
+     */
+    struct alignas(64) LaneSize {
+      std::atomic_size_t bytes = 0;
+    };
+
     // NOLINTBEGIN(cppcoreguidelines-non-private-member-variables-in-classes)
     const std::string name_;
     Level level_;
     const ThreadInfoType thread_info_type_;
+    const bool with_sequence_;
     const size_t max_buffer_size_;
     const std::chrono::milliseconds latency_;
     const size_t max_message_length_;
+    // Number of events of direct sink; queued ones are numbered by queues
+    std::atomic<uint64_t> sequence_ = 0;
     CircularBuffer<Event> events_;
-    std::atomic_size_t size_ = 0;
+    // Other shards of events queue, if sink is sharded
+    std::vector<std::unique_ptr<CircularBuffer<Event>>> shards_{};
+    // Heads of shards and urgent events captured to merge them by time
+    std::vector<CircularBuffer<Event>::NodeRef> fronts_{};
+    // Number of captured heads; the only part of fronts_ read by others
+    std::atomic_size_t held_ = 0;
+    CircularBuffer<Event> urgent_events_;
+    // Size of buffered events by lanes; lane of event is its node.lane()
+    std::vector<LaneSize> lane_sizes_;
     const std::vector<std::shared_ptr<Sink>> underlying_sinks_{};
+    // Events broadcast by multisink to its underlying sinks
+    const std::shared_ptr<BroadcastBuffer<Event>> broadcast_{};
+    // Counters of events, if sink counts them instead of writing out
+    std::unique_ptr<EventCounters> counters_{};
+    // Producer writes event right into destination of sink, without queue
+    bool direct_ = false;
+    // Events of multisink, which this sink consumes too
+    std::atomic<BroadcastBuffer<Event> *> shared_events_ = nullptr;
+    std::shared_ptr<BroadcastBuffer<Event>> shared_events_owner_{};
+    size_t shared_consumer_ = 0;
+    // Worker sleeps without deadline, because there are no events
+    std::atomic_bool is_parked_ = false;
     // NOLINTEND(cppcoreguidelines-non-private-member-variables-in-classes)
+
+   private:
+    /**
+     * Formats event right into place claimed in destination of direct sink
+     */
+    template <typename Format, typename... Args>
+    void pushDirect(std::string_view name,
+                    Level level,
+                    const Format &format,
+                    const Args &...args) noexcept(IF_RELEASE) {
+      const auto timestamp = std::chrono::system_clock::now();
+      // Number is taken by dropped event too, so gap shows loss
+      const auto sequence =
+          sequence_.fetch_add(1, std::memory_order_relaxed) + 1;
+      auto slot = claimDirect();
+      if (slot.message == nullptr) {
+        return;
+      }
+      bool failed = false;
+      const auto size = formatMessage(
+          slot.message, max_message_length_, failed, format, args...);
+      if (failed) {
+        name = "Soralog";
+        level = Level::ERROR;
+      }
+      publishDirect(slot, timestamp, name, level, size, sequence);
+    }
+
+    /**
+     * @returns number of shards; 0 means number of cores, but not more than
+     * queue of {@param max_events} can be split to with 8 events per shard
+     */
+    static size_t resolveShards(size_t shards, size_t max_events) noexcept {
+      if (shards == 0) {
+        shards = std::min<size_t>(std::thread::hardware_concurrency(),
+                                  max_events / 8);
+      }
+      return std::max<size_t>(shards, 1);
+    }
+
+    /**
+     * @returns capacity of each shard; total memory stays bounded
+     */
+    static size_t shardCapacity(size_t max_events, size_t shards) noexcept {
+      if (shards == 1) {
+        return max_events;
+      }
+      return std::max<size_t>(max_events / shards, 8);
+    }
+
+    /**
+     * @returns lane of urgent events; it follows lanes of shards
+     */
+    size_t urgentLane() const noexcept {
+      return shards_.size() + 1;
+    }
+
+    /**
+     * @returns lane (i.e. shard of events queue) of current thread
+     */
+    size_t laneOfThread() const noexcept {
+      if (shards_.empty()) {
+        return 0;
+      }
+      return util::getThreadNumber() % (shards_.size() + 1);
+    }
+
+    /**
+     * @returns queue of events of {@param lane}
+     */
+    CircularBuffer<Event> &queueOf(size_t lane) noexcept {
+      return lane == 0              ? events_
+           : lane <= shards_.size() ? *shards_[lane - 1]
+                                    : urgent_events_;
+    }
+
+    /**
+     * @returns true if buffered events reach threshold of async flush. Total
+     * size is summed by all lanes lazily, only when lane of producer, which
+     * has {@param buffered} bytes, holds its fair part of threshold
+     */
+    bool isFilled(size_t buffered) const noexcept {
+      const auto threshold = max_buffer_size_ * 4 / 5;
+      if (buffered * lane_sizes_.size() < threshold) {
+        return false;
+      }
+      size_t total = 0;
+      for (const auto &lane : lane_sizes_) {
+        total += lane.bytes.load(std::memory_order_relaxed);
+      }
+      return total >= threshold;
+    }
+
+    /**
+     * Merges shards and urgent events by time of events. Each queue keeps
+     * order of its events, and events of different queues are ordered by
+     * time (and by lane, if time is the same)
+     * @returns captured the earliest event among heads of queues
+     */
+    CircularBuffer<Event>::NodeRef nextMergedEvent() noexcept(IF_RELEASE) {
+      size_t best = fronts_.size();
+      for (size_t i = 0; i < fronts_.size(); ++i) {
+        auto &front = fronts_[i];
+        if (not front) {
+          auto &queue = queueOf(i);
+          if (queue.empty()) {
+            continue;
+          }
+          // Counted before taking out of queue, see hasEvents()
+          held_.fetch_add(1, std::memory_order_seq_cst);
+          front = queue.get();
+          if (not front) {
+            held_.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+          }
+        }
+        if (best == fronts_.size()
+            or front->timestamp() < fronts_[best]->timestamp()) {
+          best = i;
+        }
+      }
+      if (best == fronts_.size()) {
+        return {};
+      }
+      held_.fetch_sub(1, std::memory_order_release);
+      return std::move(fronts_[best]);
+    }
   };
 
 }  // namespace soralog
@@ -0,0 +1,117 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <soralog/executor.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace soralog {
+
+  /**
+   * @class SinkScheduler
+   * Runs background passes of sink (flush, export, dump, etc.) by own worker
+   * thread, or by tasks of executor, if it's set while scheduler is started
+   * (see Executor::Scope). Pass is run at deadline provided by sink, or at
+   * once when it is requested. Sink without work returns no deadline, so
+   * scheduler sleeps without wakeups until it's woken up or requested.
+   * Passes are run one at once.
+   */
+  class SinkScheduler final {
+   public:
+    using Clock = std::chrono::steady_clock;
+    using Pass = std::function<void()>;
+    using Deadline = std::function<Clock::time_point()>;
+
+    /// Deadline of scheduler, which has nothing to do
+    static constexpr Clock::time_point never = Clock::time_point::max();
+
+    SinkScheduler() = default;
+    SinkScheduler(const SinkScheduler &) = delete;
+    SinkScheduler(SinkScheduler &&) noexcept = delete;
+    ~SinkScheduler();
+    SinkScheduler &operator=(const SinkScheduler &) = delete;
+    SinkScheduler &operator=(SinkScheduler &&) noexcept = delete;
+
+    /**
+     * Starts worker thread named {@param thread_name}, or takes current
+     * executor. {@param pass} does one pass of background work.
+     * {@param deadline} returns time of next pass, or never; it's called
+     * under lock, which wake() and request() take too, after start, after
+     * each pass, and when scheduler is woken up
+     */
+    void start(std::string thread_name, Pass pass, Deadline deadline);
+
+    /**
+     * Runs pass as soon as possible
+     */
+    void request() noexcept;
+
+    /**
+     * Takes deadline again, e.g. when the first event after idle is pushed
+     */
+    void wake() noexcept;
+
+    /**
+     * Stops scheduling; pass in progress is finished before return. Sink
+     * does the final pass itself, if it needs
+     */
+    void stop() noexcept;
+
+    /**
+     * @returns true if scheduler is started and isn't stopped yet
+     */
+    bool active() const noexcept {
+      return worker_ or executor_;
+    }
+
+    /**
+     * @returns true if current thread runs pass of this scheduler
+     */
+    bool isRunning() const noexcept;
+
+   private:
+    void run();
+
+    /**
+     * Schedules task on executor at {@param deadline}, if there is no one,
+     * or wakes it up, if deadline is passed. Called under mutex_
+     */
+    void schedule(Clock::time_point deadline) noexcept;
+
+    /**
+     * Task on executor: runs pass, and schedules the next one
+     */
+    void runScheduled() noexcept;
+
+    void runPass() noexcept;
+
+    std::string thread_name_;
+    Pass pass_;
+    Deadline deadline_;
+
+    std::unique_ptr<std::thread> worker_{};
+
+    // Executor running passes instead of worker
+    std::shared_ptr<Executor> executor_{};
+    // Pending or running task; guarded by mutex_
+    std::shared_ptr<Executor::WakeHandle> scheduled_{};
+
+    std::mutex mutex_;
+    std::condition_variable condvar_;
+    bool requested_ = false;  // guarded by mutex_
+    bool stopping_ = false;   // guarded by mutex_
+  };
+
+}  // namespace soralog
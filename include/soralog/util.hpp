@@ -8,7 +8,10 @@
 #pragma once
 
 #include <pthread.h>
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cstring>
 #include <string>
 
 namespace soralog::util {
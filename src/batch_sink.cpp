@@ -0,0 +1,224 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/batch_sink.hpp>
+
+#include <iostream>
+#include <limits>
+
+namespace soralog {
+
+  BatchSink::BatchSink(std::string name,
+                       Level level,
+                       ThreadInfoType thread_info_type,
+                       size_t max_events,
+                       size_t max_message_length,
+                       size_t max_buffer_size,
+                       size_t latency,
+                       bool with_sequence,
+                       size_t shards,
+                       bool worker_only,
+                       bool polled)
+      : Sink(std::move(name),
+             level,
+             thread_info_type,
+             max_events,
+             max_message_length,
+             max_buffer_size,
+             latency,
+             with_sequence,
+             shards),
+        max_batch_size_(std::max<size_t>(
+            1,
+            std::min(events_.capacity() * (shards_.size() + 1)
+                         + urgent_events_.capacity(),
+                     max_buffer_size_
+                         / (max_message_length_ + max_record_overhead)))),
+        worker_only_(worker_only),
+        polled_(polled),
+        buff_(max_batch_size_ * (max_message_length_ + max_record_overhead)) {
+    batch_.reserve(max_batch_size_);
+  }
+
+  BatchSink::~BatchSink() {
+    assert(not scheduler_.active());
+  }
+
+  void BatchSink::start() {
+    if (latency_ == std::chrono::milliseconds::zero() or polled_) {
+      return;
+    }
+    scheduler_.start(
+        "log:" + name_, [this] { flush(); }, [this] { return nextFlush(); });
+  }
+
+  void BatchSink::stop() noexcept {
+    scheduler_.stop();
+    combiner_.combine([this] { drain(std::numeric_limits<size_t>::max()); });
+
+    // Nobody flushes by worker anymore
+    {
+      std::lock_guard lock(flushes_mutex_);
+      need_to_finalize_ = true;
+    }
+    flushes_condvar_.notify_all();
+  }
+
+  void BatchSink::async_flush() noexcept {
+    if (latency_ == std::chrono::milliseconds::zero()) {
+      flush();
+      return;
+    }
+    need_to_flush_.store(true, std::memory_order_seq_cst);
+    scheduler_.request();
+  }
+
+  void BatchSink::wakeUp() noexcept {
+    // Worker is either waiting already or sees event before parking
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_relaxed);
+    scheduler_.wake();
+  }
+
+  std::chrono::steady_clock::time_point BatchSink::nextFlush() noexcept {
+    if (park([&] { return need_to_flush_.load(std::memory_order_relaxed); })) {
+      return SinkScheduler::never;
+    }
+    return next_flush_.load(std::memory_order_relaxed);
+  }
+
+  void BatchSink::rotate() noexcept {
+    need_to_rotate_.store(true, std::memory_order_release);
+    async_flush();
+  }
+
+  void BatchSink::flush() noexcept {
+    if (worker_only_ and scheduler_.active() and not scheduler_.isRunning()) {
+      flushByWorker();
+      return;
+    }
+
+    // Flush by other thread might miss events pushed by this one, so it
+    // does one more pass for them
+    combiner_.combine([this] { drain(std::numeric_limits<size_t>::max()); });
+  }
+
+  size_t BatchSink::poll(size_t budget) noexcept {
+    if (not polled_ or budget == 0) {
+      return 0;
+    }
+
+    if (not need_to_flush_.load(std::memory_order_acquire)
+        and not need_to_rotate_.load(std::memory_order_acquire)) {
+      if (not hasEvents()) {
+        // The first event after idle arms deadline of flush
+        next_flush_.store(std::chrono::steady_clock::time_point::max(),
+                          std::memory_order_relaxed);
+        return 0;
+      }
+      const auto now = std::chrono::steady_clock::now();
+      auto deadline = next_flush_.load(std::memory_order_relaxed);
+      if (deadline == std::chrono::steady_clock::time_point::max()) {
+        deadline = now + latency_;
+        next_flush_.store(deadline, std::memory_order_relaxed);
+      }
+      if (now < deadline) {
+        return 0;
+      }
+    }
+
+    size_t written = 0;
+    combiner_.exclusive([&] { written = drain(budget); }, false);
+    return written;
+  }
+
+  size_t BatchSink::drain(size_t budget) noexcept {
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_release);
+
+    batch_redactor_ = std::atomic_load(&redactor_);
+
+    size_t written = 0;
+    bool drained = false;
+    while (true) {
+      const auto limit = std::min(max_batch_size_, budget - written);
+      while (batch_.size() < limit) {
+        auto node = nextEvent();
+        if (not node) {
+          break;
+        }
+        batch_.emplace_back(std::move(node));
+      }
+      if (batch_.empty()) {
+        drained = true;
+        break;
+      }
+
+      try {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        write(Batch(batch_.data(), batch_.data() + batch_.size()), buff_);
+      } catch (const std::exception &exception) {
+        std::cerr << "Can't write events of sink '" << name_
+                  << "': " << exception.what() << '\n';
+      }
+
+      for (const auto &node : batch_) {
+        accountWritten(node);
+      }
+      written += batch_.size();
+      const bool was_full = batch_.size() == limit;
+      batch_.clear();
+
+      // Queue is drained
+      if (not was_full) {
+        drained = true;
+        break;
+      }
+      if (written == budget) {
+        break;
+      }
+    }
+
+    if (not drained) {
+      // The rest is due at once
+      next_flush_.store(std::chrono::steady_clock::now(),
+                        std::memory_order_release);
+    } else if (need_to_flush_.exchange(false, std::memory_order_acq_rel)) {
+      sync();
+    }
+
+    if (need_to_rotate_.exchange(false, std::memory_order_acq_rel)) {
+      reopen();
+    }
+
+    if (worker_only_) {
+      {
+        std::lock_guard lock(flushes_mutex_);
+        ++flushes_;
+      }
+      flushes_condvar_.notify_all();
+    }
+    return written;
+  }
+
+  void BatchSink::flushByWorker() noexcept {
+    std::unique_lock lock(flushes_mutex_);
+    const auto flushes = flushes_;
+    lock.unlock();
+    async_flush();
+    lock.lock();
+    while (flushes_ == flushes and not need_to_finalize_) {
+      flushes_condvar_.wait_until(lock, SinkScheduler::never);
+    }
+  }
+
+  void BatchSink::setRedactor(
+      std::shared_ptr<const Redactor> redactor) noexcept {
+    std::atomic_store(&redactor_, std::move(redactor));
+  }
+
+}  // namespace soralog
@@ -0,0 +1,55 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/executor.hpp>
+
+#include <utility>
+
+namespace soralog {
+
+  namespace {
+
+    std::shared_ptr<Executor> &currentExecutor() noexcept {
+      thread_local std::shared_ptr<Executor> executor;
+      return executor;
+    }
+
+  }  // namespace
+
+  void Executor::WakeHandle::wake() {
+    executor_.post([self = shared_from_this()] { self->run(); });
+  }
+
+  void Executor::WakeHandle::run() {
+    if (not claimed_.test_and_set(std::memory_order_acq_rel)) {
+      task_();
+    }
+  }
+
+  std::shared_ptr<Executor::WakeHandle> Executor::schedule(Duration delay,
+                                                           Task task) {
+    auto handle = std::make_shared<WakeHandle>(*this, std::move(task));
+    if (delay <= Duration::zero()) {
+      post([handle] { handle->run(); });
+    } else {
+      postAfter(delay, [handle] { handle->run(); });
+    }
+    return handle;
+  }
+
+  std::shared_ptr<Executor> Executor::current() noexcept {
+    return currentExecutor();
+  }
+
+  Executor::Scope::Scope(std::shared_ptr<Executor> executor) noexcept
+      : previous_(std::exchange(currentExecutor(), std::move(executor))) {}
+
+  Executor::Scope::~Scope() {
+    currentExecutor() = std::move(previous_);
+  }
+
+}  // namespace soralog
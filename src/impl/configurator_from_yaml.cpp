@@ -17,8 +17,13 @@
 #include <soralog/impl/multisink.hpp>
 #include <soralog/impl/sink_to_console.hpp>
 #include <soralog/impl/sink_to_file.hpp>
+#include <soralog/impl/sink_to_metrics.hpp>
+#include <soralog/impl/sink_to_network.hpp>
 #include <soralog/impl/sink_to_nowhere.hpp>
+#include <soralog/impl/sink_to_otlp.hpp>
+#include <soralog/impl/sink_to_shared_memory.hpp>
 #include <soralog/impl/sink_to_syslog.hpp>
+#include <soralog/impl/sink_to_trace.hpp>
 
 namespace soralog {
 
@@ -138,6 +143,102 @@ namespace soralog {
     }
   }
 
+  std::optional<size_t> ConfiguratorFromYAML::Applicator::parseShards(
+      const std::string &name, const YAML::Node &sink_node) {
+    auto shards_node = sink_node["shards"];
+    if (not shards_node.IsDefined()) {
+      return std::nullopt;
+    }
+    if (not shards_node.IsScalar()) {
+      errors_ << "W: Property 'shards' of sink node is not scalar\n";
+      has_warning_ = true;
+      return std::nullopt;
+    }
+    auto shards_str = shards_node.as<std::string>();
+    if (shards_str == "auto") {
+      return 0;  // number of cores
+    }
+    auto shards_int = shards_node.as<int>();
+    if (std::to_string(shards_int) != shards_str or shards_int < 1) {
+      errors_ << "W: Wrong value of property 'shards' of sink '" << name
+              << "': " << shards_str << "\n";
+      has_warning_ = true;
+      return std::nullopt;
+    }
+    return shards_int;
+  }
+
+  std::optional<bool> ConfiguratorFromYAML::Applicator::parsePoll(
+      const YAML::Node &sink_node) {
+    auto poll_node = sink_node["poll"];
+    if (not poll_node.IsDefined()) {
+      return std::nullopt;
+    }
+    if (not poll_node.IsScalar()) {
+      errors_ << "W: Property 'poll' of sink node is not true or false\n";
+      has_warning_ = true;
+      return std::nullopt;
+    }
+    return poll_node.as<bool>();
+  }
+
+  std::shared_ptr<Redactor> ConfiguratorFromYAML::Applicator::parseRedactor(
+      const std::string &name, const YAML::Node &sink_node) {
+    auto redact_node = sink_node["redact"];
+    if (not redact_node.IsDefined()) {
+      return nullptr;
+    }
+    if (not redact_node.IsSequence()) {
+      errors_ << "W: Property 'redact' of sink '" << name
+              << "' is not a YAML sequence\n";
+      has_warning_ = true;
+      return nullptr;
+    }
+
+    std::vector<Redactor::Pattern> patterns;
+    for (auto i = 0; i < redact_node.size(); ++i) {
+      auto pattern_node = redact_node[i];
+      Redactor::Pattern pattern;
+
+      // Short form is just text of pattern
+      auto text_node = pattern_node.IsMap() ? pattern_node["pattern"]
+                                            : pattern_node;
+      if (not text_node.IsScalar() or text_node.as<std::string>().empty()) {
+        errors_ << "W: Pattern #" << i << " of 'redact' of sink '" << name
+                << "' is not a non-empty string\n";
+        has_warning_ = true;
+        continue;
+      }
+      pattern.text = text_node.as<std::string>();
+
+      if (pattern_node.IsMap()) {
+        auto mask_node = pattern_node["mask"];
+        if (mask_node.IsDefined()) {
+          auto mask_str =
+              mask_node.IsScalar() ? mask_node.as<std::string>() : "";
+          if (mask_str == "match") {
+            pattern.mask = Redactor::Mask::MATCH;
+          } else if (mask_str == "word") {
+            pattern.mask = Redactor::Mask::WORD;
+          } else if (mask_str == "value") {
+            pattern.mask = Redactor::Mask::VALUE;
+          } else {
+            errors_ << "W: Wrong property 'mask' of pattern #" << i
+                    << " of 'redact' of sink '" << name << "'\n";
+            has_warning_ = true;
+          }
+        }
+      }
+
+      patterns.emplace_back(std::move(pattern));
+    }
+
+    if (patterns.empty()) {
+      return nullptr;
+    }
+    return std::make_shared<Redactor>(std::move(patterns));
+  }
+
   void ConfiguratorFromYAML::Applicator::parseSinks(const YAML::Node &sinks) {
     if (sinks.IsNull()) {
       errors_ << "E: Sinks list is empty\n";
@@ -262,8 +363,18 @@ namespace soralog {
       parseSinkToConsole(name, sink);
     } else if (type == "file") {
       parseSinkToFile(name, sink);
+    } else if (type == "trace") {
+      parseSinkToTrace(name, sink);
     } else if (type == "syslog") {
       parseSinkToSyslog(name, sink);
+    } else if (type == "shm") {
+      parseSinkToSharedMemory(name, sink);
+    } else if (type == "network") {
+      parseSinkToNetwork(name, sink);
+    } else if (type == "otlp") {
+      parseSinkToOtlp(name, sink);
+    } else if (type == "metrics") {
+      parseSinkToMetrics(name, sink);
     } else if (type == "multisink") {
       parseMultisink(name, sink);
     } else {
@@ -282,6 +393,7 @@ namespace soralog {
     std::optional<size_t> buffer_size;
     std::optional<size_t> max_message_length;
     std::optional<size_t> latency;
+    std::optional<bool> with_sequence;
 
     auto color_node = sink_node["color"];
     if (color_node.IsDefined()) {
@@ -403,6 +515,22 @@ namespace soralog {
       }
     }
 
+    auto sequence_node = sink_node["sequence"];
+    if (sequence_node.IsDefined()) {
+      if (not sequence_node.IsScalar()) {
+        errors_ << "W: Property 'sequence' of sink node is not true or false\n";
+        has_warning_ = true;
+      } else {
+        with_sequence.emplace(sequence_node.as<bool>());
+      }
+    }
+
+    auto shards = parseShards(name, sink_node);
+
+    auto polled = parsePoll(sink_node);
+
+    auto redactor = parseRedactor(name, sink_node);
+
     auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
                      .value_or(Level::TRACE);
 
@@ -437,6 +565,18 @@ namespace soralog {
       if (key == "latency") {
         continue;
       }
+      if (key == "sequence") {
+        continue;
+      }
+      if (key == "shards") {
+        continue;
+      }
+      if (key == "poll") {
+        continue;
+      }
+      if (key == "redact") {
+        continue;
+      }
       if (key == "level") {
         continue;
       }
@@ -451,15 +591,19 @@ namespace soralog {
       has_warning_ = true;
     }
 
-    system_.makeSink<SinkToConsole>(name,
-                                    level,
-                                    stream_type,
-                                    color,
-                                    thread_info_type,
-                                    capacity,
-                                    max_message_length,
-                                    buffer_size,
-                                    latency);
+    auto sink = system_.makeSink<SinkToConsole>(name,
+                                                level,
+                                                stream_type,
+                                                color,
+                                                thread_info_type,
+                                                capacity,
+                                                max_message_length,
+                                                buffer_size,
+                                                latency,
+                                                with_sequence,
+                                                shards,
+                                                polled);
+    sink->setRedactor(std::move(redactor));
   }
 
   void ConfiguratorFromYAML::Applicator::parseSinkToFile(
@@ -470,6 +614,11 @@ namespace soralog {
     std::optional<size_t> buffer_size;
     std::optional<size_t> max_message_length;
     std::optional<size_t> latency;
+    std::optional<bool> with_sequence;
+    std::optional<size_t> render_threads;
+    std::optional<size_t> writeback_size;
+    std::optional<size_t> preallocate_size;
+    std::optional<bool> direct_io;
 
     auto path_node = sink_node["path"];
     if (not path_node.IsDefined()) {
@@ -572,6 +721,90 @@ namespace soralog {
       }
     }
 
+    auto sequence_node = sink_node["sequence"];
+    if (sequence_node.IsDefined()) {
+      if (not sequence_node.IsScalar()) {
+        errors_ << "W: Property 'sequence' of sink node is not true or false\n";
+        has_warning_ = true;
+      } else {
+        with_sequence.emplace(sequence_node.as<bool>());
+      }
+    }
+
+    auto render_threads_node = sink_node["render_threads"];
+    if (render_threads_node.IsDefined()) {
+      if (not render_threads_node.IsScalar()) {
+        errors_ << "W: Property 'render_threads' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto render_threads_int = render_threads_node.as<int>();
+        if (std::to_string(render_threads_int)
+                != render_threads_node.as<std::string>()
+            or render_threads_int < 0) {
+          errors_ << "W: Wrong value of property 'render_threads' of sink '"
+                  << name << "': " << render_threads_node.as<std::string>()
+                  << "\n";
+          has_warning_ = true;
+        } else {
+          render_threads.emplace(render_threads_int);
+        }
+      }
+    }
+
+    auto writeback_node = sink_node["writeback"];
+    if (writeback_node.IsDefined()) {
+      if (not writeback_node.IsScalar()) {
+        errors_ << "W: Property 'writeback' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto writeback_int = writeback_node.as<int>();
+        if (std::to_string(writeback_int) != writeback_node.as<std::string>()
+            or writeback_int < 0) {
+          errors_ << "W: Wrong value of property 'writeback' of sink '" << name
+                  << "': " << writeback_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          writeback_size.emplace(writeback_int);
+        }
+      }
+    }
+
+    auto preallocate_node = sink_node["preallocate"];
+    if (preallocate_node.IsDefined()) {
+      if (not preallocate_node.IsScalar()) {
+        errors_ << "W: Property 'preallocate' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto preallocate_int = preallocate_node.as<int>();
+        if (std::to_string(preallocate_int)
+                != preallocate_node.as<std::string>()
+            or preallocate_int < 0) {
+          errors_ << "W: Wrong value of property 'preallocate' of sink '"
+                  << name << "': " << preallocate_node.as<std::string>()
+                  << "\n";
+          has_warning_ = true;
+        } else {
+          preallocate_size.emplace(preallocate_int);
+        }
+      }
+    }
+
+    auto direct_node = sink_node["direct"];
+    if (direct_node.IsDefined()) {
+      if (not direct_node.IsScalar()) {
+        errors_ << "W: Property 'direct' of sink node is not true or false\n";
+        has_warning_ = true;
+      } else {
+        direct_io.emplace(direct_node.as<bool>());
+      }
+    }
+
+    auto shards = parseShards(name, sink_node);
+
+    auto polled = parsePoll(sink_node);
+
+    auto redactor = parseRedactor(name, sink_node);
+
     auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
                      .value_or(Level::TRACE);
 
@@ -601,6 +834,30 @@ namespace soralog {
       if (key == "latency") {
         continue;
       }
+      if (key == "sequence") {
+        continue;
+      }
+      if (key == "shards") {
+        continue;
+      }
+      if (key == "poll") {
+        continue;
+      }
+      if (key == "render_threads") {
+        continue;
+      }
+      if (key == "writeback") {
+        continue;
+      }
+      if (key == "preallocate") {
+        continue;
+      }
+      if (key == "direct") {
+        continue;
+      }
+      if (key == "redact") {
+        continue;
+      }
       if (key == "level") {
         continue;
       }
@@ -621,33 +878,41 @@ namespace soralog {
       has_warning_ = true;
     }
 
-    system_.makeSink<SinkToFile>(name,
-                                 level,
-                                 path,
-                                 thread_info_type,
-                                 capacity,
-                                 max_message_length,
-                                 buffer_size,
-                                 latency);
+    auto sink = system_.makeSink<SinkToFile>(name,
+                                             level,
+                                             path,
+                                             thread_info_type,
+                                             capacity,
+                                             max_message_length,
+                                             buffer_size,
+                                             latency,
+                                             with_sequence,
+                                             render_threads,
+                                             shards,
+                                             writeback_size,
+                                             preallocate_size,
+                                             direct_io,
+                                             polled);
+    sink->setRedactor(std::move(redactor));
   }
 
-  void ConfiguratorFromYAML::Applicator::parseSinkToSyslog(
+  void ConfiguratorFromYAML::Applicator::parseSinkToTrace(
       const std::string &name, const YAML::Node &sink_node) {
     bool fail = false;
-    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NAME;
     std::optional<size_t> capacity;
     std::optional<size_t> buffer_size;
     std::optional<size_t> max_message_length;
     std::optional<size_t> latency;
 
-    auto ident_node = sink_node["ident"];
-    if (not ident_node.IsDefined()) {
+    auto path_node = sink_node["path"];
+    if (not path_node.IsDefined()) {
       fail = true;
-      errors_ << "E: Not found 'ident' of sink '" << name << "'\n";
+      errors_ << "E: Not found 'path' of sink '" << name << "'\n";
       has_error_ = true;
-    } else if (not ident_node.IsScalar()) {
+    } else if (not path_node.IsScalar()) {
       fail = true;
-      errors_ << "E: Property 'ident' of sink '" << name << "' is not scalar\n";
+      errors_ << "E: Property 'path' of sink '" << name << "' is not scalar\n";
       has_error_ = true;
     }
 
@@ -741,6 +1006,12 @@ namespace soralog {
       }
     }
 
+    auto shards = parseShards(name, sink_node);
+
+    auto polled = parsePoll(sink_node);
+
+    auto redactor = parseRedactor(name, sink_node);
+
     auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
                      .value_or(Level::TRACE);
 
@@ -752,7 +1023,7 @@ namespace soralog {
       if (key == "type") {
         continue;
       }
-      if (key == "ident") {
+      if (key == "path") {
         continue;
       }
       if (key == "thread") {
@@ -770,6 +1041,15 @@ namespace soralog {
       if (key == "latency") {
         continue;
       }
+      if (key == "shards") {
+        continue;
+      }
+      if (key == "poll") {
+        continue;
+      }
+      if (key == "redact") {
+        continue;
+      }
       if (key == "level") {
         continue;
       }
@@ -782,7 +1062,7 @@ namespace soralog {
       return;
     }
 
-    auto ident = ident_node.as<std::string>();
+    auto path = path_node.as<std::string>();
 
     if (system_.getSink(name)) {
       errors_ << "W: Already exists sink with name '" << name
@@ -790,72 +1070,1114 @@ namespace soralog {
       has_warning_ = true;
     }
 
-    system_.makeSink<SinkToSyslog>(name,
-                                   level,
-                                   ident,
-                                   thread_info_type,
-                                   capacity,
-                                   max_message_length,
-                                   buffer_size,
-                                   latency);
+    auto sink = system_.makeSink<SinkToTrace>(name,
+                                              level,
+                                              path,
+                                              thread_info_type,
+                                              capacity,
+                                              max_message_length,
+                                              buffer_size,
+                                              latency,
+                                              shards,
+                                              polled);
+    sink->setRedactor(std::move(redactor));
   }
 
-  void ConfiguratorFromYAML::Applicator::parseMultisink(
+  void ConfiguratorFromYAML::Applicator::parseSinkToSyslog(
       const std::string &name, const YAML::Node &sink_node) {
     bool fail = false;
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> max_message_length;
+    std::optional<size_t> latency;
+    std::optional<bool> with_sequence;
 
-    auto sinks_node = sink_node["sinks"];
-    if (not sinks_node.IsDefined()) {
+    auto ident_node = sink_node["ident"];
+    if (not ident_node.IsDefined()) {
       fail = true;
-      errors_ << "E: Not found 'sinks' of sink '" << name << "'\n";
+      errors_ << "E: Not found 'ident' of sink '" << name << "'\n";
       has_error_ = true;
-    } else if (not sinks_node.IsSequence()) {
+    } else if (not ident_node.IsScalar()) {
       fail = true;
-      errors_ << "E: Property 'sinks' of sink '" << name << "' is not list\n";
+      errors_ << "E: Property 'ident' of sink '" << name << "' is not scalar\n";
       has_error_ = true;
     }
 
-    auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
-                     .value_or(Level::TRACE);
-
-    for (const auto &it : sink_node) {
-      auto key = it.first.as<std::string>();
-      if (key == "name") {
-        continue;
-      }
-      if (key == "type") {
-        continue;
-      }
-      if (key == "sinks") {
-        continue;
-      }
-      if (key == "level") {
-        continue;
+    auto thread_node = sink_node["thread"];
+    if (thread_node.IsDefined()) {
+      if (not thread_node.IsScalar()) {
+        errors_ << "W: Property 'thread' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto thread_str = thread_node.as<std::string>();
+        if (thread_str == "name") {
+          thread_info_type = Sink::ThreadInfoType::NAME;
+        } else if (thread_str == "id") {
+          thread_info_type = Sink::ThreadInfoType::ID;
+        } else if (thread_str != "none") {
+          errors_ << "W: Wrong property 'thread' value of sink '" << name
+                  << "': " << thread_str << "\n";
+          has_warning_ = true;
+        }
       }
-      errors_ << "W: Unknown property of sink '" << name << "': " << key
-              << "\n";
-      has_warning_ = true;
     }
 
-    if (fail) {
-      return;
+    auto capacity_node = sink_node["capacity"];
+    if (capacity_node.IsDefined()) {
+      if (not capacity_node.IsScalar()) {
+        errors_ << "W: Property 'capacity' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto capacity_int = capacity_node.as<int>();
+        if (capacity_int >= 4) {
+          capacity.emplace(capacity_int);
+        } else {
+          errors_ << "W: Wrong property 'capacity' value of sink '" << name
+                  << "': " << capacity_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
     }
 
-    auto sink_names = sinks_node.as<std::vector<std::string>>();
+    auto buffer_node = sink_node["buffer"];
+    if (buffer_node.IsDefined()) {
+      if (not buffer_node.IsScalar()) {
+        errors_ << "W: Property 'buffer' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto buffer_int = buffer_node.as<int>();
+        if (buffer_int >= sizeof(Event) * 4) {
+          buffer_size.emplace(buffer_int);
+        } else {
+          errors_ << "W: Wrong property 'buffer' value of sink '" << name
+                  << "': " << buffer_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
 
-    std::vector<std::shared_ptr<Sink>> sinks;
-    for (auto &sink_name : sink_names) {
-      auto sink = system_.getSink(sink_name);
-      if (not sink) {
-        errors_ << "E: Sink '" << sink_name << "' must be defined before sink '"
-                << name << "'\n";
+    auto max_message_length_node = sink_node["max_message_length"];
+    if (max_message_length_node.IsDefined()) {
+      if (not max_message_length_node.IsScalar()) {
+        errors_
+            << "W: Property 'max_message_length' of sink node is not scalar\n";
         has_warning_ = true;
       } else {
-        sinks.emplace_back(std::move(sink));
+        auto max_message_length_int = max_message_length_node.as<int>();
+        if (max_message_length_int >= 64) {
+          max_message_length.emplace(max_message_length_int);
+        } else {
+          errors_ << "W: Wrong property 'max_message_length' value of sink '"
+                  << name << "': " << max_message_length_node.as<std::string>()
+                  << "\n";
+          has_warning_ = true;
+        }
       }
     }
 
-    system_.makeSink<Multisink>(name, level, std::move(sinks));
+    auto latency_node = sink_node["latency"];
+    if (latency_node.IsDefined()) {
+      if (not latency_node.IsScalar()) {
+        errors_ << "W: Property 'latency' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto latency_int = latency_node.as<int>();
+        if (std::to_string(latency_int) != latency_node.as<std::string>()
+            or latency_int < 0) {
+          errors_ << "W: Wrong value of property 'latency' value of sink '"
+                  << name << "': " << latency_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          latency.emplace(latency_int);
+        }
+      }
+    }
+
+    auto sequence_node = sink_node["sequence"];
+    if (sequence_node.IsDefined()) {
+      if (not sequence_node.IsScalar()) {
+        errors_ << "W: Property 'sequence' of sink node is not true or false\n";
+        has_warning_ = true;
+      } else {
+        with_sequence.emplace(sequence_node.as<bool>());
+      }
+    }
+
+    auto shards = parseShards(name, sink_node);
+
+    auto polled = parsePoll(sink_node);
+
+    auto redactor = parseRedactor(name, sink_node);
+
+    auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
+                     .value_or(Level::TRACE);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (key == "name") {
+        continue;
+      }
+      if (key == "type") {
+        continue;
+      }
+      if (key == "ident") {
+        continue;
+      }
+      if (key == "thread") {
+        continue;
+      }
+      if (key == "capacity") {
+        continue;
+      }
+      if (key == "buffer") {
+        continue;
+      }
+      if (key == "max_message_length") {
+        continue;
+      }
+      if (key == "latency") {
+        continue;
+      }
+      if (key == "sequence") {
+        continue;
+      }
+      if (key == "shards") {
+        continue;
+      }
+      if (key == "poll") {
+        continue;
+      }
+      if (key == "redact") {
+        continue;
+      }
+      if (key == "level") {
+        continue;
+      }
+      errors_ << "W: Unknown property of sink '" << name << "': " << key
+              << "\n";
+      has_warning_ = true;
+    }
+
+    if (fail) {
+      return;
+    }
+
+    auto ident = ident_node.as<std::string>();
+
+    if (system_.getSink(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    auto sink = system_.makeSink<SinkToSyslog>(name,
+                                               level,
+                                               ident,
+                                               thread_info_type,
+                                               capacity,
+                                               max_message_length,
+                                               buffer_size,
+                                               latency,
+                                               with_sequence,
+                                               shards,
+                                               polled);
+    sink->setRedactor(std::move(redactor));
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToSharedMemory(
+      const std::string &name, const YAML::Node &sink_node) {
+    bool fail = false;
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> max_message_length;
+    std::optional<size_t> latency;
+    std::optional<size_t> segment_capacity;
+
+    auto segment_node = sink_node["segment"];
+    if (not segment_node.IsDefined()) {
+      fail = true;
+      errors_ << "E: Not found 'segment' of sink '" << name << "'\n";
+      has_error_ = true;
+    } else if (not segment_node.IsScalar()) {
+      fail = true;
+      errors_ << "E: Property 'segment' of sink '" << name
+              << "' is not scalar\n";
+      has_error_ = true;
+    }
+
+    auto thread_node = sink_node["thread"];
+    if (thread_node.IsDefined()) {
+      if (not thread_node.IsScalar()) {
+        errors_ << "W: Property 'thread' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto thread_str = thread_node.as<std::string>();
+        if (thread_str == "name") {
+          thread_info_type = Sink::ThreadInfoType::NAME;
+        } else if (thread_str == "id") {
+          thread_info_type = Sink::ThreadInfoType::ID;
+        } else if (thread_str != "none") {
+          errors_ << "W: Wrong property 'thread' value of sink '" << name
+                  << "': " << thread_str << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto capacity_node = sink_node["capacity"];
+    if (capacity_node.IsDefined()) {
+      if (not capacity_node.IsScalar()) {
+        errors_ << "W: Property 'capacity' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto capacity_int = capacity_node.as<int>();
+        if (capacity_int >= 4) {
+          capacity.emplace(capacity_int);
+        } else {
+          errors_ << "W: Wrong property 'capacity' value of sink '" << name
+                  << "': " << capacity_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto buffer_node = sink_node["buffer"];
+    if (buffer_node.IsDefined()) {
+      if (not buffer_node.IsScalar()) {
+        errors_ << "W: Property 'buffer' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto buffer_int = buffer_node.as<int>();
+        if (buffer_int >= sizeof(Event) * 4) {
+          buffer_size.emplace(buffer_int);
+        } else {
+          errors_ << "W: Wrong property 'buffer' value of sink '" << name
+                  << "': " << buffer_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto max_message_length_node = sink_node["max_message_length"];
+    if (max_message_length_node.IsDefined()) {
+      if (not max_message_length_node.IsScalar()) {
+        errors_
+            << "W: Property 'max_message_length' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto max_message_length_int = max_message_length_node.as<int>();
+        if (max_message_length_int >= 64) {
+          max_message_length.emplace(max_message_length_int);
+        } else {
+          errors_ << "W: Wrong property 'max_message_length' value of sink '"
+                  << name << "': " << max_message_length_node.as<std::string>()
+                  << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto latency_node = sink_node["latency"];
+    if (latency_node.IsDefined()) {
+      if (not latency_node.IsScalar()) {
+        errors_ << "W: Property 'latency' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto latency_int = latency_node.as<int>();
+        if (std::to_string(latency_int) != latency_node.as<std::string>()
+            or latency_int < 0) {
+          errors_ << "W: Wrong value of property 'latency' value of sink '"
+                  << name << "': " << latency_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          latency.emplace(latency_int);
+        }
+      }
+    }
+
+    auto segment_capacity_node = sink_node["segment_capacity"];
+    if (segment_capacity_node.IsDefined()) {
+      if (not segment_capacity_node.IsScalar()) {
+        errors_
+            << "W: Property 'segment_capacity' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto segment_capacity_int = segment_capacity_node.as<int>();
+        if (segment_capacity_int >= 4) {
+          segment_capacity.emplace(segment_capacity_int);
+        } else {
+          errors_ << "W: Wrong property 'segment_capacity' value of sink '"
+                  << name << "': " << segment_capacity_node.as<std::string>()
+                  << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
+                     .value_or(Level::TRACE);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (key == "name") {
+        continue;
+      }
+      if (key == "type") {
+        continue;
+      }
+      if (key == "segment") {
+        continue;
+      }
+      if (key == "segment_capacity") {
+        continue;
+      }
+      if (key == "thread") {
+        continue;
+      }
+      if (key == "capacity") {
+        continue;
+      }
+      if (key == "buffer") {
+        continue;
+      }
+      if (key == "max_message_length") {
+        continue;
+      }
+      if (key == "latency") {
+        continue;
+      }
+      if (key == "level") {
+        continue;
+      }
+      errors_ << "W: Unknown property of sink '" << name << "': " << key
+              << "\n";
+      has_warning_ = true;
+    }
+
+    if (fail) {
+      return;
+    }
+
+    auto segment = segment_node.as<std::string>();
+
+    if (system_.getSink(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    system_.makeSink<SinkToSharedMemory>(name,
+                                         level,
+                                         segment,
+                                         thread_info_type,
+                                         capacity,
+                                         max_message_length,
+                                         buffer_size,
+                                         latency,
+                                         segment_capacity);
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToNetwork(
+      const std::string &name, const YAML::Node &sink_node) {
+    bool fail = false;
+    SinkToNetwork::Protocol protocol = SinkToNetwork::Protocol::TCP;
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> max_message_length;
+    std::optional<size_t> latency;
+    std::optional<bool> with_sequence;
+    std::optional<size_t> max_pending_size;
+    std::optional<size_t> max_datagram_size;
+    std::optional<std::filesystem::path> spool_path;
+
+    auto protocol_node = sink_node["protocol"];
+    if (protocol_node.IsDefined()) {
+      if (not protocol_node.IsScalar()) {
+        errors_ << "W: Property 'protocol' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto protocol_str = protocol_node.as<std::string>();
+        if (protocol_str == "udp") {
+          protocol = SinkToNetwork::Protocol::UDP;
+        } else if (protocol_str != "tcp") {
+          fail = true;
+          errors_ << "E: Wrong property 'protocol' value of sink '" << name
+                  << "': " << protocol_str << "\n";
+          has_error_ = true;
+        }
+      }
+    }
+
+    auto host_node = sink_node["host"];
+    if (not host_node.IsDefined()) {
+      fail = true;
+      errors_ << "E: Not found 'host' of sink '" << name << "'\n";
+      has_error_ = true;
+    } else if (not host_node.IsScalar()) {
+      fail = true;
+      errors_ << "E: Property 'host' of sink '" << name << "' is not scalar\n";
+      has_error_ = true;
+    }
+
+    int port = 0;
+    auto port_node = sink_node["port"];
+    if (not port_node.IsDefined()) {
+      fail = true;
+      errors_ << "E: Not found 'port' of sink '" << name << "'\n";
+      has_error_ = true;
+    } else if (not port_node.IsScalar()) {
+      fail = true;
+      errors_ << "E: Property 'port' of sink '" << name << "' is not scalar\n";
+      has_error_ = true;
+    } else {
+      port = port_node.as<int>();
+      if (port <= 0 or port > 65535) {
+        fail = true;
+        errors_ << "E: Wrong property 'port' value of sink '" << name
+                << "': " << port_node.as<std::string>() << "\n";
+        has_error_ = true;
+      }
+    }
+
+    auto thread_node = sink_node["thread"];
+    if (thread_node.IsDefined()) {
+      if (not thread_node.IsScalar()) {
+        errors_ << "W: Property 'thread' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto thread_str = thread_node.as<std::string>();
+        if (thread_str == "name") {
+          thread_info_type = Sink::ThreadInfoType::NAME;
+        } else if (thread_str == "id") {
+          thread_info_type = Sink::ThreadInfoType::ID;
+        } else if (thread_str != "none") {
+          errors_ << "W: Wrong property 'thread' value of sink '" << name
+                  << "': " << thread_str << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto capacity_node = sink_node["capacity"];
+    if (capacity_node.IsDefined()) {
+      if (not capacity_node.IsScalar()) {
+        errors_ << "W: Property 'capacity' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto capacity_int = capacity_node.as<int>();
+        if (capacity_int >= 4) {
+          capacity.emplace(capacity_int);
+        } else {
+          errors_ << "W: Wrong property 'capacity' value of sink '" << name
+                  << "': " << capacity_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto buffer_node = sink_node["buffer"];
+    if (buffer_node.IsDefined()) {
+      if (not buffer_node.IsScalar()) {
+        errors_ << "W: Property 'buffer' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto buffer_int = buffer_node.as<int>();
+        if (buffer_int >= sizeof(Event) * 4) {
+          buffer_size.emplace(buffer_int);
+        } else {
+          errors_ << "W: Wrong property 'buffer' value of sink '" << name
+                  << "': " << buffer_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto max_message_length_node = sink_node["max_message_length"];
+    if (max_message_length_node.IsDefined()) {
+      if (not max_message_length_node.IsScalar()) {
+        errors_
+            << "W: Property 'max_message_length' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto max_message_length_int = max_message_length_node.as<int>();
+        if (max_message_length_int >= 64) {
+          max_message_length.emplace(max_message_length_int);
+        } else {
+          errors_ << "W: Wrong property 'max_message_length' value of sink '"
+                  << name << "': " << max_message_length_node.as<std::string>()
+                  << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto latency_node = sink_node["latency"];
+    if (latency_node.IsDefined()) {
+      if (not latency_node.IsScalar()) {
+        errors_ << "W: Property 'latency' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto latency_int = latency_node.as<int>();
+        if (std::to_string(latency_int) != latency_node.as<std::string>()
+            or latency_int < 0) {
+          errors_ << "W: Wrong value of property 'latency' value of sink '"
+                  << name << "': " << latency_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          latency.emplace(latency_int);
+        }
+      }
+    }
+
+    auto pending_node = sink_node["pending"];
+    if (pending_node.IsDefined()) {
+      if (not pending_node.IsScalar()) {
+        errors_ << "W: Property 'pending' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto pending_int = pending_node.as<int>();
+        if (pending_int >= 0) {
+          max_pending_size.emplace(pending_int);
+        } else {
+          errors_ << "W: Wrong property 'pending' value of sink '" << name
+                  << "': " << pending_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto datagram_node = sink_node["datagram"];
+    if (datagram_node.IsDefined()) {
+      if (not datagram_node.IsScalar()) {
+        errors_ << "W: Property 'datagram' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto datagram_int = datagram_node.as<int>();
+        if (datagram_int >= 256 and datagram_int <= 65507) {
+          max_datagram_size.emplace(datagram_int);
+        } else {
+          errors_ << "W: Wrong property 'datagram' value of sink '" << name
+                  << "': " << datagram_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto spool_node = sink_node["spool"];
+    if (spool_node.IsDefined()) {
+      if (not spool_node.IsScalar()) {
+        errors_ << "W: Property 'spool' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        spool_path.emplace(spool_node.as<std::string>());
+      }
+    }
+
+    auto sequence_node = sink_node["sequence"];
+    if (sequence_node.IsDefined()) {
+      if (not sequence_node.IsScalar()) {
+        errors_ << "W: Property 'sequence' of sink node is not true or false\n";
+        has_warning_ = true;
+      } else {
+        with_sequence.emplace(sequence_node.as<bool>());
+      }
+    }
+
+    auto shards = parseShards(name, sink_node);
+
+    auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
+                     .value_or(Level::TRACE);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (key == "name") {
+        continue;
+      }
+      if (key == "type") {
+        continue;
+      }
+      if (key == "protocol") {
+        continue;
+      }
+      if (key == "host") {
+        continue;
+      }
+      if (key == "port") {
+        continue;
+      }
+      if (key == "pending") {
+        continue;
+      }
+      if (key == "datagram") {
+        continue;
+      }
+      if (key == "spool") {
+        continue;
+      }
+      if (key == "thread") {
+        continue;
+      }
+      if (key == "capacity") {
+        continue;
+      }
+      if (key == "buffer") {
+        continue;
+      }
+      if (key == "max_message_length") {
+        continue;
+      }
+      if (key == "latency") {
+        continue;
+      }
+      if (key == "sequence") {
+        continue;
+      }
+      if (key == "shards") {
+        continue;
+      }
+      if (key == "level") {
+        continue;
+      }
+      errors_ << "W: Unknown property of sink '" << name << "': " << key
+              << "\n";
+      has_warning_ = true;
+    }
+
+    if (fail) {
+      return;
+    }
+
+    auto host = host_node.as<std::string>();
+
+    if (system_.getSink(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    system_.makeSink<SinkToNetwork>(name,
+                                    level,
+                                    protocol,
+                                    host,
+                                    static_cast<uint16_t>(port),
+                                    thread_info_type,
+                                    capacity,
+                                    max_message_length,
+                                    buffer_size,
+                                    latency,
+                                    max_pending_size,
+                                    max_datagram_size,
+                                    spool_path,
+                                    with_sequence,
+                                    shards);
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToOtlp(
+      const std::string &name, const YAML::Node &sink_node) {
+    bool fail = false;
+    Sink::ThreadInfoType thread_info_type = Sink::ThreadInfoType::NONE;
+    std::optional<size_t> capacity;
+    std::optional<size_t> buffer_size;
+    std::optional<size_t> max_message_length;
+    std::optional<size_t> latency;
+    std::optional<bool> compression;
+    std::optional<std::string> service_name;
+
+    auto endpoint_node = sink_node["endpoint"];
+    if (not endpoint_node.IsDefined()) {
+      fail = true;
+      errors_ << "E: Not found 'endpoint' of sink '" << name << "'\n";
+      has_error_ = true;
+    } else if (not endpoint_node.IsScalar()) {
+      fail = true;
+      errors_ << "E: Property 'endpoint' of sink '" << name
+              << "' is not scalar\n";
+      has_error_ = true;
+    }
+
+    auto thread_node = sink_node["thread"];
+    if (thread_node.IsDefined()) {
+      if (not thread_node.IsScalar()) {
+        errors_ << "W: Property 'thread' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto thread_str = thread_node.as<std::string>();
+        if (thread_str == "name") {
+          thread_info_type = Sink::ThreadInfoType::NAME;
+        } else if (thread_str == "id") {
+          thread_info_type = Sink::ThreadInfoType::ID;
+        } else if (thread_str != "none") {
+          errors_ << "W: Wrong property 'thread' value of sink '" << name
+                  << "': " << thread_str << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto capacity_node = sink_node["capacity"];
+    if (capacity_node.IsDefined()) {
+      if (not capacity_node.IsScalar()) {
+        errors_ << "W: Property 'capacity' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto capacity_int = capacity_node.as<int>();
+        if (capacity_int >= 4) {
+          capacity.emplace(capacity_int);
+        } else {
+          errors_ << "W: Wrong property 'capacity' value of sink '" << name
+                  << "': " << capacity_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto buffer_node = sink_node["buffer"];
+    if (buffer_node.IsDefined()) {
+      if (not buffer_node.IsScalar()) {
+        errors_ << "W: Property 'buffer' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto buffer_int = buffer_node.as<int>();
+        if (buffer_int >= sizeof(Event) * 4) {
+          buffer_size.emplace(buffer_int);
+        } else {
+          errors_ << "W: Wrong property 'buffer' value of sink '" << name
+                  << "': " << buffer_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto max_message_length_node = sink_node["max_message_length"];
+    if (max_message_length_node.IsDefined()) {
+      if (not max_message_length_node.IsScalar()) {
+        errors_
+            << "W: Property 'max_message_length' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto max_message_length_int = max_message_length_node.as<int>();
+        if (max_message_length_int >= 64) {
+          max_message_length.emplace(max_message_length_int);
+        } else {
+          errors_ << "W: Wrong property 'max_message_length' value of sink '"
+                  << name << "': " << max_message_length_node.as<std::string>()
+                  << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto latency_node = sink_node["latency"];
+    if (latency_node.IsDefined()) {
+      if (not latency_node.IsScalar()) {
+        errors_ << "W: Property 'latency' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto latency_int = latency_node.as<int>();
+        if (std::to_string(latency_int) != latency_node.as<std::string>()
+            or latency_int < 0) {
+          errors_ << "W: Wrong value of property 'latency' value of sink '"
+                  << name << "': " << latency_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          latency.emplace(latency_int);
+        }
+      }
+    }
+
+    auto compression_node = sink_node["compression"];
+    if (compression_node.IsDefined()) {
+      if (not compression_node.IsScalar()) {
+        errors_ << "W: Property 'compression' of sink node is not true or "
+                   "false\n";
+        has_warning_ = true;
+      } else {
+        compression.emplace(compression_node.as<bool>());
+      }
+    }
+
+    auto service_node = sink_node["service"];
+    if (service_node.IsDefined()) {
+      if (not service_node.IsScalar()) {
+        errors_ << "W: Property 'service' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        service_name.emplace(service_node.as<std::string>());
+      }
+    }
+
+    auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
+                     .value_or(Level::TRACE);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (key == "name") {
+        continue;
+      }
+      if (key == "type") {
+        continue;
+      }
+      if (key == "endpoint") {
+        continue;
+      }
+      if (key == "compression") {
+        continue;
+      }
+      if (key == "service") {
+        continue;
+      }
+      if (key == "thread") {
+        continue;
+      }
+      if (key == "capacity") {
+        continue;
+      }
+      if (key == "buffer") {
+        continue;
+      }
+      if (key == "max_message_length") {
+        continue;
+      }
+      if (key == "latency") {
+        continue;
+      }
+      if (key == "level") {
+        continue;
+      }
+      errors_ << "W: Unknown property of sink '" << name << "': " << key
+              << "\n";
+      has_warning_ = true;
+    }
+
+    if (fail) {
+      return;
+    }
+
+    auto endpoint = endpoint_node.as<std::string>();
+
+    if (system_.getSink(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    try {
+      system_.makeSink<SinkToOtlp>(name,
+                                   level,
+                                   endpoint,
+                                   thread_info_type,
+                                   capacity,
+                                   max_message_length,
+                                   buffer_size,
+                                   latency,
+                                   compression,
+                                   service_name);
+    } catch (const std::invalid_argument &exception) {
+      errors_ << "E: " << exception.what() << "\n";
+      has_error_ = true;
+    }
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseSinkToMetrics(
+      const std::string &name, const YAML::Node &sink_node) {
+    std::optional<std::filesystem::path> path;
+    std::optional<size_t> period;
+    std::optional<size_t> capacity;
+
+    auto path_node = sink_node["path"];
+    if (path_node.IsDefined()) {
+      if (not path_node.IsScalar()) {
+        errors_ << "W: Property 'path' of sink '" << name
+                << "' is not scalar\n";
+        has_warning_ = true;
+      } else {
+        path.emplace(path_node.as<std::string>());
+      }
+    }
+
+    auto period_node = sink_node["period"];
+    if (period_node.IsDefined()) {
+      if (not period_node.IsScalar()) {
+        errors_ << "W: Property 'period' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto period_int = period_node.as<int>();
+        if (std::to_string(period_int) != period_node.as<std::string>()
+            or period_int < 0) {
+          errors_ << "W: Wrong value of property 'period' of sink '" << name
+                  << "': " << period_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        } else {
+          period.emplace(period_int);
+        }
+      }
+    }
+
+    auto capacity_node = sink_node["capacity"];
+    if (capacity_node.IsDefined()) {
+      if (not capacity_node.IsScalar()) {
+        errors_ << "W: Property 'capacity' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto capacity_int = capacity_node.as<int>();
+        if (capacity_int >= 1) {
+          capacity.emplace(capacity_int);
+        } else {
+          errors_ << "W: Wrong property 'capacity' value of sink '" << name
+                  << "': " << capacity_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
+                     .value_or(Level::TRACE);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (key == "name") {
+        continue;
+      }
+      if (key == "type") {
+        continue;
+      }
+      if (key == "path") {
+        continue;
+      }
+      if (key == "period") {
+        continue;
+      }
+      if (key == "capacity") {
+        continue;
+      }
+      if (key == "level") {
+        continue;
+      }
+      errors_ << "W: Unknown property of sink '" << name << "': " << key
+              << "\n";
+      has_warning_ = true;
+    }
+
+    if (system_.getSink(name)) {
+      errors_ << "W: Already exists sink with name '" << name
+              << "'; Previous version will be overridden\n";
+      has_warning_ = true;
+    }
+
+    system_.makeSink<SinkToMetrics>(name, level, path, period, capacity);
+  }
+
+  void ConfiguratorFromYAML::Applicator::parseMultisink(
+      const std::string &name, const YAML::Node &sink_node) {
+    bool fail = false;
+    std::optional<Multisink::LagPolicy> broadcast;
+    std::optional<size_t> capacity;
+
+    auto sinks_node = sink_node["sinks"];
+    if (not sinks_node.IsDefined()) {
+      fail = true;
+      errors_ << "E: Not found 'sinks' of sink '" << name << "'\n";
+      has_error_ = true;
+    } else if (not sinks_node.IsSequence()) {
+      fail = true;
+      errors_ << "E: Property 'sinks' of sink '" << name << "' is not list\n";
+      has_error_ = true;
+    }
+
+    auto broadcast_node = sink_node["broadcast"];
+    if (broadcast_node.IsDefined()) {
+      if (not broadcast_node.IsScalar()) {
+        errors_ << "W: Property 'broadcast' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto broadcast_str = broadcast_node.as<std::string>();
+        if (broadcast_str == "block") {
+          broadcast.emplace(Multisink::LagPolicy::BLOCK);
+        } else if (broadcast_str == "drop") {
+          broadcast.emplace(Multisink::LagPolicy::DROP);
+        } else if (broadcast_str == "detach") {
+          broadcast.emplace(Multisink::LagPolicy::DETACH);
+        } else if (broadcast_str != "none") {
+          errors_ << "W: Wrong property 'broadcast' value of sink '" << name
+                  << "': " << broadcast_str << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto capacity_node = sink_node["capacity"];
+    if (capacity_node.IsDefined()) {
+      if (not capacity_node.IsScalar()) {
+        errors_ << "W: Property 'capacity' of sink node is not scalar\n";
+        has_warning_ = true;
+      } else {
+        auto capacity_int = capacity_node.as<int>();
+        if (capacity_int >= 4) {
+          capacity.emplace(capacity_int);
+        } else {
+          errors_ << "W: Wrong property 'capacity' value of sink '" << name
+                  << "': " << capacity_node.as<std::string>() << "\n";
+          has_warning_ = true;
+        }
+      }
+    }
+
+    auto level = parseLevel(fmt::format("sink '{}'", name), sink_node)
+                     .value_or(Level::TRACE);
+
+    for (const auto &it : sink_node) {
+      auto key = it.first.as<std::string>();
+      if (key == "name") {
+        continue;
+      }
+      if (key == "type") {
+        continue;
+      }
+      if (key == "sinks") {
+        continue;
+      }
+      if (key == "broadcast") {
+        continue;
+      }
+      if (key == "capacity") {
+        continue;
+      }
+      if (key == "level") {
+        continue;
+      }
+      errors_ << "W: Unknown property of sink '" << name << "': " << key
+              << "\n";
+      has_warning_ = true;
+    }
+
+    if (fail) {
+      return;
+    }
+
+    auto sink_names = sinks_node.as<std::vector<std::string>>();
+
+    std::vector<std::shared_ptr<Sink>> sinks;
+    for (auto &sink_name : sink_names) {
+      auto sink = system_.getSink(sink_name);
+      if (not sink) {
+        errors_ << "E: Sink '" << sink_name << "' must be defined before sink '"
+                << name << "'\n";
+        has_warning_ = true;
+      } else {
+        sinks.emplace_back(std::move(sink));
+      }
+    }
+
+    try {
+      system_.makeSink<Multisink>(
+          name, level, std::move(sinks), broadcast, capacity);
+    } catch (const std::invalid_argument &exception) {
+      errors_ << "E: " << exception.what() << "\n";
+      has_error_ = true;
+    }
   }
 
   void ConfiguratorFromYAML::Applicator::parseGroups(
@@ -8,6 +8,7 @@
 #include <soralog/impl/multisink.hpp>
 
 #include <iostream>
+#include <stdexcept>
 
 #include <fmt/chrono.h>
 
@@ -15,8 +16,74 @@ namespace soralog {
 
   Multisink::Multisink(std::string name,
                        Level level,
-                       std::vector<std::shared_ptr<Sink>> sinks)
-      : Sink(std::move(name), level, std::move(sinks)) {}
+                       std::vector<std::shared_ptr<Sink>> sinks,
+                       std::optional<LagPolicy> broadcast,
+                       std::optional<size_t> capacity)
+      : Sink(std::move(name),
+             level,
+             sinks,
+             broadcast.has_value()
+                 ? std::make_shared<BroadcastBuffer<Event>>(
+                       capacity.value_or(1u << 11),  // 2048 events
+                       maxMessageLength(sinks),
+                       sinks.size(),
+                       *broadcast)
+                 : nullptr,
+             threadInfoType(sinks),
+             maxMessageLength(sinks)) {
+    if (not broadcast_) {
+      return;
+    }
+
+    for (const auto &sink : underlying_sinks_) {
+      if (not sink->underlying_sinks_.empty()) {
+        throw std::invalid_argument(fmt::format(
+            "Broadcasting multisink '{}' can't contain multisink '{}'",
+            name_,
+            sink->name_));
+      }
+      if (sink->shared_events_.load(std::memory_order_acquire) != nullptr) {
+        throw std::invalid_argument(fmt::format(
+            "Sink '{}' is used by another broadcasting multisink already",
+            sink->name_));
+      }
+    }
+
+    for (size_t i = 0; i < underlying_sinks_.size(); ++i) {
+      const auto &sink = underlying_sinks_[i];
+      if (sink->counters_ or sink->direct_) {
+        // Counting and direct sinks get events by push, not from shared buffer
+        broadcast_->detach(i);
+        continue;
+      }
+      sink->shared_events_owner_ = broadcast_;
+      sink->shared_consumer_ = i;
+      sink->shared_events_.store(broadcast_.get(), std::memory_order_release);
+    }
+  }
+
+  Sink::ThreadInfoType Multisink::threadInfoType(
+      const std::vector<std::shared_ptr<Sink>> &sinks) {
+    // Shared event must keep thread info enough for each sink
+    auto thread_info_type = ThreadInfoType::NONE;
+    for (const auto &sink : sinks) {
+      if (sink->thread_info_type_ == ThreadInfoType::NAME
+          or thread_info_type == ThreadInfoType::NONE) {
+        thread_info_type = sink->thread_info_type_;
+      }
+    }
+    return thread_info_type;
+  }
+
+  size_t Multisink::maxMessageLength(
+      const std::vector<std::shared_ptr<Sink>> &sinks) {
+    size_t max_message_length = 0;
+    for (const auto &sink : sinks) {
+      max_message_length =
+          std::max(max_message_length, sink->max_message_length_);
+    }
+    return max_message_length;
+  }
 
   void Multisink::flush() noexcept {
     for (const auto &sink : underlying_sinks_) {
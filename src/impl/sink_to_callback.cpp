@@ -0,0 +1,229 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_callback.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include <fmt/chrono.h>
+
+namespace soralog {
+
+  namespace {
+    using namespace std::chrono_literals;
+
+    /**
+     * Stores {@param size} bytes of {@param data} into {@param words} by
+     * relaxed atomic stores
+     */
+    template <typename Word>
+    void storeWords(std::atomic<Word> *words, const char *data, size_t size) {
+      for (size_t i = 0; i < size; i += sizeof(Word)) {
+        Word word = 0;
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::memcpy(&word, data + i, std::min(sizeof(Word), size - i));
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        words[i / sizeof(Word)].store(word, std::memory_order_relaxed);
+      }
+    }
+
+    /**
+     * Loads {@param size} bytes from {@param words} into {@param data} by
+     * relaxed atomic loads
+     */
+    template <typename Word>
+    void loadWords(const std::atomic<Word> *words, char *data, size_t size) {
+      for (size_t i = 0; i < size; i += sizeof(Word)) {
+        const auto word =
+            // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            words[i / sizeof(Word)].load(std::memory_order_relaxed);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+        std::memcpy(data + i, &word, std::min(sizeof(Word), size - i));
+      }
+    }
+  }  // namespace
+
+  SinkToCallback::SinkToCallback(std::string name,
+                                 Level level,
+                                 std::optional<size_t> recent,
+                                 std::optional<ThreadInfoType> thread_info_type,
+                                 std::optional<size_t> capacity,
+                                 std::optional<size_t> max_message_length,
+                                 std::optional<size_t> buffer_size,
+                                 std::optional<size_t> latency)
+      : BatchSink(std::move(name),
+                  level,
+                  thread_info_type.value_or(ThreadInfoType::NONE),
+                  capacity.value_or(1u << 10),            // 1024 events
+                  max_message_length.value_or(1u << 10),  // 1024 bytes
+                  buffer_size.value_or(1u << 20),         // 1 Mb
+                  // Worker is needed, so latency can't be zero
+                  std::max<size_t>(latency.value_or(100), 1),  // 100 ms
+                  false,
+                  1,
+                  true),
+        subscribers_(std::make_shared<const Subscribers>()),
+        ring_size_(recent.value_or(0)),
+        record_size_(max_message_length_ + max_record_overhead),
+        record_words_((record_size_ + sizeof(Word) - 1) / sizeof(Word)),
+        slots_(ring_size_),
+        records_(ring_size_ * record_words_),
+        record_(ring_size_ == 0 ? 0 : record_size_) {
+    start();
+  }
+
+  SinkToCallback::~SinkToCallback() {
+    stop();
+  }
+
+  SinkToCallback::SubscriptionId SinkToCallback::subscribe(Callback callback) {
+    std::lock_guard lock(subscription_mutex_);
+    auto subscribers = std::make_shared<Subscribers>(
+        *std::atomic_load(&subscribers_));
+    auto id = ++last_id_;
+    subscribers->push_back({id, std::move(callback)});
+    std::atomic_store(
+        &subscribers_,
+        std::shared_ptr<const Subscribers>(std::move(subscribers)));
+    return id;
+  }
+
+  void SinkToCallback::unsubscribe(SubscriptionId id) {
+    std::lock_guard lock(subscription_mutex_);
+    auto subscribers = std::make_shared<Subscribers>(
+        *std::atomic_load(&subscribers_));
+    subscribers->erase(
+        std::remove_if(subscribers->begin(),
+                       subscribers->end(),
+                       [id](const auto &subscriber) {
+                         return subscriber.id == id;
+                       }),
+        subscribers->end());
+    std::atomic_store(
+        &subscribers_,
+        std::shared_ptr<const Subscribers>(std::move(subscribers)));
+  }
+
+  void SinkToCallback::write(const Batch &events, std::vector<char> &) {
+    if (ring_size_ != 0) {
+      for (const auto &node : events) {
+        keep(*node, node.lane(), node.sequence());
+      }
+    }
+
+    auto subscribers = std::atomic_load(&subscribers_);
+    for (const auto &subscriber : *subscribers) {
+      try {
+        subscriber.callback(events);
+      } catch (const std::exception &exception) {
+        std::cerr << "Callback of sink '" << name_
+                  << "' has thrown exception: " << exception.what() << '\n';
+      }
+    }
+  }
+
+  void SinkToCallback::keep(const Event &event,
+                            uint32_t lane,
+                            uint64_t sequence) {
+    const auto position = kept_.load(std::memory_order_relaxed);
+    auto &slot = slots_[position % ring_size_];
+    auto *const begin = record_.data();
+
+    const auto time = event.timestamp().time_since_epoch();
+    const auto sec = time / 1s;
+    const auto usec = time % 1s / 1us;
+
+    auto result = fmt::format_to_n(
+        begin,
+        record_size_,
+        "{:%y.%m.%d %H:%M:%S}.{:0>6}  ",
+        fmt::localtime(sec),
+        usec);
+    if (with_sequence_) {
+      result = fmt::format_to_n(result.out,
+                                record_size_ - (result.out - begin),
+                                "#{}.{:<6}  ",
+                                lane,
+                                sequence);
+    }
+    switch (thread_info_type_) {
+      case ThreadInfoType::NAME:
+        result = fmt::format_to_n(result.out,
+                                  record_size_ - (result.out - begin),
+                                  "{:<15}  ",
+                                  event.thread_name());
+        break;
+      case ThreadInfoType::ID:
+        result = fmt::format_to_n(result.out,
+                                  record_size_ - (result.out - begin),
+                                  "T:{:<6}  ",
+                                  event.thread_number());
+        break;
+      default:
+        break;
+    }
+    result = fmt::format_to_n(result.out,
+                              record_size_ - (result.out - begin),
+                              "{:<8}  {}  ",
+                              levelToStr(event.level()),
+                              event.name());
+    auto *const message = result.out;
+    result = fmt::format_to_n(message,
+                              record_size_ - (message - begin),
+                              "{}",
+                              messageOf(event));
+    redact(message, result.out);
+    const auto size = std::min<size_t>(result.out - begin, record_size_);
+
+    slot.version.store(position * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    storeWords(records_.data() + record_words_ * (position % ring_size_),
+               begin,
+               size);
+    slot.size.store(size, std::memory_order_relaxed);
+    slot.version.store(position * 2 + 2, std::memory_order_release);
+    kept_.store(position + 1, std::memory_order_release);
+  }
+
+  std::vector<std::string> SinkToCallback::recent(size_t count) const {
+    std::vector<std::string> result;
+    if (ring_size_ == 0) {
+      return result;
+    }
+
+    const auto kept = kept_.load(std::memory_order_acquire);
+    const auto first = kept - std::min({count, ring_size_, kept});
+    result.reserve(kept - first);
+
+    std::string record;
+    for (auto position = first; position < kept; ++position) {
+      const auto &slot = slots_[position % ring_size_];
+
+      const auto version = slot.version.load(std::memory_order_acquire);
+      if (version != position * 2 + 2) {
+        continue;  // Is overwritten by newer event already
+      }
+      record.resize(
+          std::min(slot.size.load(std::memory_order_relaxed), record_size_));
+      loadWords(
+          // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+          records_.data() + record_words_ * (position % ring_size_),
+          record.data(),
+          record.size());
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.version.load(std::memory_order_relaxed) != version) {
+        continue;  // Was overwritten during copying
+      }
+      result.emplace_back(std::move(record));
+    }
+    return result;
+  }
+
+}  // namespace soralog
@@ -141,210 +141,160 @@ namespace soralog {
                                std::optional<size_t> capacity,
                                std::optional<size_t> max_message_length,
                                std::optional<size_t> buffer_size,
-                               std::optional<size_t> latency)
-      : Sink(std::move(name),
-             level,
-             thread_info_type.value_or(ThreadInfoType::NONE),
-             capacity.value_or(1u << 6),             // 64 events
-             max_message_length.value_or(1u << 10),  // 1024 bytes
-             buffer_size.value_or(1u << 17),         // 128 Kb
-             latency.value_or(200)),                 // 200 ms
+                               std::optional<size_t> latency,
+                               std::optional<bool> with_sequence,
+                               std::optional<size_t> shards,
+                               std::optional<bool> polled)
+      : BatchSink(std::move(name),
+                  level,
+                  thread_info_type.value_or(ThreadInfoType::NONE),
+                  capacity.value_or(1u << 6),             // 64 events
+                  max_message_length.value_or(1u << 10),  // 1024 bytes
+                  buffer_size.value_or(1u << 17),         // 128 Kb
+                  latency.value_or(200),                  // 200 ms
+                  with_sequence.value_or(false),
+                  shards.value_or(Sink::default_shards),
+                  false,
+                  polled.value_or(false)),
         stream_(stream_type == Stream::STDERR ? std::cerr : std::cout),
-        with_color_(with_color),
-        buff_(max_buffer_size_) {
-    if (latency_ != std::chrono::milliseconds::zero()) {
-      sink_worker_ = std::make_unique<std::thread>([this] { run(); });
-    }
+        with_color_(with_color) {
+    start();
   }
 
   SinkToConsole::~SinkToConsole() {
-    if (latency_ != std::chrono::milliseconds::zero()) {
-      need_to_finalize_.store(true, std::memory_order_release);
-      async_flush();
-      if (sink_worker_ and sink_worker_->joinable()) {
-        sink_worker_->join();
-        sink_worker_.reset();
-      }
-    } else {
-      flush();
-    }
+    stop();
   }
 
-  void SinkToConsole::async_flush() noexcept {
-    if (latency_ != std::chrono::milliseconds::zero()) {
-      need_to_flush_.store(true, std::memory_order_release);
-      condvar_.notify_one();
-    } else {
-      flush();
-    }
+  void SinkToConsole::sync() noexcept {
+    stream_.flush();
   }
 
-  void SinkToConsole::flush() noexcept {
-    if (flush_in_progress_.test_and_set()) {
-      return;
-    }
-
-    auto *const begin = buff_.data();
-    auto *const end = buff_.data() + buff_.size();  // NOLINT
+  void SinkToConsole::write(const Batch &events, std::vector<char> &buffer) {
+    auto *const begin = buffer.data();
+    auto *const end = buffer.data() + buffer.size();  // NOLINT
     auto *ptr = begin;
 
     decltype(1s / 1s) psec = 0;
     std::tm tm{};
     std::array<char, 17> datetime{};  // "00.00.00 00:00:00"
 
-    while (true) {
-      bool appended = false;
-      if (auto node = events_.get()) {
-        const auto &event = *node;
-
-        const auto time = event.timestamp().time_since_epoch();
-        const auto sec = time / 1s;
-        const auto usec = time % 1s / 1us;
-
-        if (psec != sec) {
-          tm = fmt::localtime(sec);
-          fmt::format_to_n(datetime.data(),
-                           datetime.size(),
-                           "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}",
-                           tm.tm_year % 100,
-                           tm.tm_mon + 1,
-                           tm.tm_mday,
-                           tm.tm_hour,
-                           tm.tm_min,
-                           tm.tm_sec);
-          psec = sec;
-        }
-
-        // Timestamp
-
-        std::memcpy(ptr, datetime.data(), datetime.size());
-        ptr = ptr + datetime.size();  // NOLINT
-
-        if (with_color_) {
-          const auto &style =
-              fmt::detail::make_foreground_color<char>(fmt::color::gray);
-
-          auto size = std::end(style) - std::begin(style);
-          std::memcpy(
-              ptr, std::begin(style), std::end(style) - std::begin(style));
-          ptr = ptr + size;  // NOLINT
-        }
-
-        ptr = fmt::format_to_n(ptr, end - ptr, ".{:0>6}", usec).out;
-
-        if (with_color_) {
-          put_reset_style(ptr);
-        }
-
-        put_separator(ptr);
-
-        // Thread
+    for (const auto &node : events) {
+      const auto &event = *node;
+
+      const auto time = event.timestamp().time_since_epoch();
+      const auto sec = time / 1s;
+      const auto usec = time % 1s / 1us;
+
+      if (psec != sec) {
+        tm = fmt::localtime(sec);
+        fmt::format_to_n(datetime.data(),
+                         datetime.size(),
+                         "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}",
+                         tm.tm_year % 100,
+                         tm.tm_mon + 1,
+                         tm.tm_mday,
+                         tm.tm_hour,
+                         tm.tm_min,
+                         tm.tm_sec);
+        psec = sec;
+      }
 
-        switch (thread_info_type_) {
-          case ThreadInfoType::NAME:
-            put_string(ptr, event.thread_name(), 15);
-            put_separator(ptr);
-            break;
+      // Timestamp
 
-          case ThreadInfoType::ID:
-            ptr = fmt::format_to_n(
-                      ptr, end - ptr, "T:{:<6}", event.thread_number())
-                      .out;
-            put_separator(ptr);
-            break;
+      std::memcpy(ptr, datetime.data(), datetime.size());
+      ptr = ptr + datetime.size();  // NOLINT
 
-          default:
-            break;
-        }
+      if (with_color_) {
+        const auto &style =
+            fmt::detail::make_foreground_color<char>(fmt::color::gray);
 
-        // Level
+        auto size = std::end(style) - std::begin(style);
+        std::memcpy(
+            ptr, std::begin(style), std::end(style) - std::begin(style));
+        ptr = ptr + size;  // NOLINT
+      }
 
-        if (with_color_) {
-          put_level_style(ptr, event.level());
-        }
-        put_level(ptr, event.level());
-        if (with_color_) {
-          put_reset_style(ptr);
-        }
+      ptr = fmt::format_to_n(ptr, end - ptr, ".{:0>6}", usec).out;
 
-        put_separator(ptr);
+      if (with_color_) {
+        put_reset_style(ptr);
+      }
 
-        // Name
+      put_separator(ptr);
 
-        if (with_color_) {
-          put_name_style(ptr);
-        }
-        put_string(ptr, event.name());
-        if (with_color_) {
-          put_reset_style(ptr);
-        }
+      // Sequence
 
+      if (with_sequence_) {
+        ptr = fmt::format_to_n(
+                  ptr, end - ptr, "#{}.{:<6}", node.lane(), node.sequence())
+                  .out;
         put_separator(ptr);
+      }
 
-        // Message
-
-        if (with_color_) {
-          put_text_style(ptr, event.level());
-        }
-        put_string(ptr, event.message());
-        if (with_color_) {
-          put_reset_style(ptr);
-        }
+      // Thread
 
-        *ptr++ = '\n';  // NOLINT
+      switch (thread_info_type_) {
+        case ThreadInfoType::NAME:
+          put_string(ptr, event.thread_name(), 15);
+          put_separator(ptr);
+          break;
 
-        size_ -= event.message().size();
-        appended = true;
-      }
+        case ThreadInfoType::ID:
+          ptr =
+              fmt::format_to_n(ptr, end - ptr, "T:{:<6}", event.thread_number())
+                  .out;
+          put_separator(ptr);
+          break;
 
-      if ((end - ptr) < sizeof(Event) or appended
-          or std::chrono::steady_clock::now()
-                 >= next_flush_.load(std::memory_order_acquire)) {
-        next_flush_.store(std::chrono::steady_clock::now() + latency_,
-                          std::memory_order_release);
-        stream_.write(begin, ptr - begin);
-        ptr = begin;
+        default:
+          break;
       }
 
-      if (appended) {
-        bool true_v = true;
-        if (need_to_flush_.compare_exchange_weak(
-                true_v, false, std::memory_order_acq_rel)) {
-          stream_.flush();
-        }
+      // Level, name and style of message; they are rendered once by logger
+      // and level, and then just copied
+
+      const auto prefix =
+          prefixes_.get(event.name(), event.level(), [&](char *&out) {
+            if (with_color_) {
+              put_level_style(out, event.level());
+            }
+            put_level(out, event.level());
+            if (with_color_) {
+              put_reset_style(out);
+            }
+
+            put_separator(out);
+
+            if (with_color_) {
+              put_name_style(out);
+            }
+            put_string(out, event.name());
+            if (with_color_) {
+              put_reset_style(out);
+            }
+
+            put_separator(out);
+
+            if (with_color_) {
+              put_text_style(out, event.level());
+            }
+          });
+      std::memcpy(ptr, prefix.data(), prefix.size());
+      ptr += prefix.size();  // NOLINT
+
+      // Message
+
+      auto *const message = ptr;
+      put_string(ptr, messageOf(event));
+      redact(message, ptr);
+      if (with_color_) {
+        put_reset_style(ptr);
       }
 
-      break;
+      *ptr++ = '\n';  // NOLINT
     }
 
-    flush_in_progress_.clear();
+    stream_.write(begin, ptr - begin);
   }
 
-  void SinkToConsole::run() {
-    util::setThreadName("log:" + name_);
-
-    next_flush_.store(std::chrono::steady_clock::now(),
-                      std::memory_order_relaxed);
-
-    while (true) {
-      {
-        std::unique_lock lock(mutex_);
-        if (condvar_.wait_until(lock,
-                                next_flush_.load(std::memory_order_relaxed))
-            == std::cv_status::no_timeout) {
-          if (not need_to_flush_.load(std::memory_order_relaxed)
-              and not need_to_finalize_.load(std::memory_order_relaxed)) {
-            continue;
-          }
-        }
-      }
-
-      flush();
-
-      if (need_to_finalize_.load(std::memory_order_acquire)
-          && events_.size() == 0) {
-        return;
-      }
-    }
-  }
 }  // namespace soralog
@@ -7,7 +7,15 @@
 
 #include <soralog/impl/sink_to_file.hpp>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 #include <fmt/chrono.h>
@@ -23,6 +31,24 @@ namespace soralog {
     // Couple of space is selected to differ of single space
     constexpr std::string_view separator = "  ";
 
+    // Log file is opened for appending by each write
+    constexpr int open_flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC;
+    constexpr mode_t open_mode = 0644;
+
+#if defined(__linux__)
+    // In direct mode file is written by aligned blocks at own offsets, and
+    // partial last block is read back to be continued
+    constexpr int direct_open_flags = O_RDWR | O_CREAT | O_DIRECT | O_CLOEXEC;
+#endif
+
+    size_t align_down(size_t size) {
+      return size & ~(SinkToFile::direct_block_size - 1);
+    }
+
+    size_t align_up(size_t size) {
+      return align_down(size + SinkToFile::direct_block_size - 1);
+    }
+
     void put_separator(char *&ptr) {
       for (auto c : separator) {
         *ptr++ = c;  // NOLINT
@@ -68,82 +94,55 @@ namespace soralog {
       }
     }
 
-  }  // namespace
-
-  SinkToFile::SinkToFile(std::string name,
-                         Level level,
-                         std::filesystem::path path,
-                         std::optional<ThreadInfoType> thread_info_type,
-                         std::optional<size_t> capacity,
-                         std::optional<size_t> max_message_length,
-                         std::optional<size_t> buffer_size,
-                         std::optional<size_t> latency)
-      : Sink(std::move(name),
-             level,
-             thread_info_type.value_or(ThreadInfoType::NONE),
-             capacity.value_or(1u << 11),            // 2048 events
-             max_message_length.value_or(1u << 10),  // 1024 bytes
-             buffer_size.value_or(1u << 22),         // 4 Mb
-             latency.value_or(1000)),                // 1 sec
-        path_(std::move(path)),
-        buff_(max_buffer_size_) {
-    out_.open(path_, std::ios::app);
-    if (not out_.is_open()) {
-      std::cerr << "Can't open log file '" << path_ << "': " << strerror(errno)
-                << '\n';
-    } else if (latency_ != std::chrono::milliseconds::zero()) {
-      sink_worker_ = std::make_unique<std::thread>([this] { run(); });
-    }
-  }
-
-  SinkToFile::~SinkToFile() {
-    if (latency_ != std::chrono::milliseconds::zero()) {
-      need_to_finalize_.store(true, std::memory_order_release);
-      async_flush();
-      if (sink_worker_ and sink_worker_->joinable()) {
-        sink_worker_->join();
-        sink_worker_.reset();
+    // Number of events rendered by one task in parallel mode
+    constexpr size_t render_chunk_size = 64;
+
+    /**
+     * Renders events into text lines; caches formatted datetime
+     */
+    class Renderer {
+     public:
+      Renderer(bool with_sequence,
+               Sink::ThreadInfoType thread_info_type,
+               size_t max_message_length,
+               const Redactor *redactor,
+               PrefixCache &prefixes)
+          : with_sequence_(with_sequence),
+            thread_info_type_(thread_info_type),
+            max_message_length_(max_message_length),
+            redactor_(redactor),
+            prefixes_(prefixes) {}
+
+      /**
+       * Renders whole record of {@param event}
+       */
+      char *render(char *ptr,
+                   const char *end,
+                   const Event &event,
+                   uint32_t lane,
+                   uint64_t sequence) {
+        ptr = renderPrefix(ptr, end, event, lane, sequence);
+        ptr = renderMessage(ptr, event);
+        *ptr++ = '\n';  // NOLINT
+        return ptr;
       }
-    } else {
-      flush();
-    }
-  }
-
-  void SinkToFile::async_flush() noexcept {
-    if (latency_ != std::chrono::milliseconds::zero()) {
-      need_to_flush_.store(true, std::memory_order_release);
-      condvar_.notify_one();
-    } else {
-      flush();
-    }
-  }
-
-  void SinkToFile::flush() noexcept {
-    if (flush_in_progress_.test_and_set()) {
-      return;
-    }
-
-    auto *const begin = buff_.data();
-    auto *const end = buff_.data() + buff_.size();  // NOLINT
-    auto *ptr = begin;
-
-    decltype(1s / 1s) psec = 0;
-    std::tm tm{};
-    std::array<char, 17> datetime{};  // "00.00.00 00:00:00"
-
-    while (true) {
-      bool appended = false;
-      if (auto node = events_.get()) {
-        const auto &event = *node;
 
+      /**
+       * Renders record of {@param event} up to message
+       */
+      char *renderPrefix(char *ptr,
+                         const char *end,
+                         const Event &event,
+                         uint32_t lane,
+                         uint64_t sequence) {
         const auto time = event.timestamp().time_since_epoch();
         const auto sec = time / 1s;
         const auto usec = time % 1s / 1us;
 
-        if (psec != sec) {
-          tm = fmt::localtime(sec);
-          fmt::format_to_n(datetime.data(),
-                           datetime.size(),
+        if (psec_ != sec) {
+          auto tm = fmt::localtime(sec);
+          fmt::format_to_n(datetime_.data(),
+                           datetime_.size(),
                            "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}",
                            tm.tm_year % 100,
                            tm.tm_mon + 1,
@@ -151,27 +150,35 @@ namespace soralog {
                            tm.tm_hour,
                            tm.tm_min,
                            tm.tm_sec);
-          psec = sec;
+          psec_ = sec;
         }
 
         // Timestamp
 
-        std::memcpy(ptr, datetime.data(), datetime.size());
-        ptr = ptr + datetime.size();  // NOLINT
+        std::memcpy(ptr, datetime_.data(), datetime_.size());
+        ptr = ptr + datetime_.size();  // NOLINT
 
         ptr = fmt::format_to_n(ptr, end - ptr, ".{:0>6}", usec).out;
 
         put_separator(ptr);
 
+        // Sequence
+
+        if (with_sequence_) {
+          ptr = fmt::format_to_n(ptr, end - ptr, "#{}.{:<6}", lane, sequence)
+                    .out;
+          put_separator(ptr);
+        }
+
         // Thread
 
         switch (thread_info_type_) {
-          case ThreadInfoType::NAME:
+          case Sink::ThreadInfoType::NAME:
             put_string(ptr, event.thread_name(), 15);
             put_separator(ptr);
             break;
 
-          case ThreadInfoType::ID:
+          case Sink::ThreadInfoType::ID:
             ptr = fmt::format_to_n(
                       ptr, end - ptr, "T:{:<6}", event.thread_number())
                       .out;
@@ -182,97 +189,463 @@ namespace soralog {
             break;
         }
 
-        // Level
+        // Level and name; they are rendered once by logger and level
 
-        put_level(ptr, event.level());
-        put_separator(ptr);
+        const auto prefix =
+            prefixes_.get(event.name(), event.level(), [&](char *&out) {
+              put_level(out, event.level());
+              put_separator(out);
+              put_string(out, event.name());
+              put_separator(out);
+            });
+        std::memcpy(ptr, prefix.data(), prefix.size());
+        ptr += prefix.size();  // NOLINT
 
-        // Name
-
-        put_string(ptr, event.name());
-        put_separator(ptr);
-
-        // Message
+        return ptr;
+      }
 
-        put_string(ptr, event.message());
-        *ptr++ = '\n';  // NOLINT
+      /**
+       * @returns message of {@param event} cut to max message length
+       */
+      std::string_view messageOf(const Event &event) const noexcept {
+        auto message = event.message();
+        return {message.data(),
+                std::min(message.size(), max_message_length_)};
+      }
 
-        size_ -= event.message().size();
-        appended = true;
+      /**
+       * Copies message of {@param event} and masks secrets in it
+       */
+      char *renderMessage(char *ptr, const Event &event) {
+        auto *const message = ptr;
+        put_string(ptr, messageOf(event));
+        if (redactor_) {
+          redactor_->redact(message, ptr);
+        }
+        return ptr;
       }
 
-      if ((end - ptr) < sizeof(Event) or appended
-          or std::chrono::steady_clock::now()
-                 >= next_flush_.load(std::memory_order_acquire)) {
-        next_flush_.store(std::chrono::steady_clock::now() + latency_,
-                          std::memory_order_release);
-        out_.write(begin, ptr - begin);
-        ptr = begin;
+      bool hasRedactor() const noexcept {
+        return redactor_ != nullptr;
       }
 
-      if (appended) {
-        bool true_v = true;
-        if (need_to_flush_.compare_exchange_weak(
-                true_v, false, std::memory_order_acq_rel)) {
-          out_.flush();
-        }
+     private:
+      const bool with_sequence_;
+      const Sink::ThreadInfoType thread_info_type_;
+      const size_t max_message_length_;
+      const Redactor *const redactor_;
+      PrefixCache &prefixes_;
+      decltype(1s / 1s) psec_ = 0;
+      std::array<char, 17> datetime_{};  // "00.00.00 00:00:00"
+    };
+
+  }  // namespace
+
+  SinkToFile::SinkToFile(std::string name,
+                         Level level,
+                         std::filesystem::path path,
+                         std::optional<ThreadInfoType> thread_info_type,
+                         std::optional<size_t> capacity,
+                         std::optional<size_t> max_message_length,
+                         std::optional<size_t> buffer_size,
+                         std::optional<size_t> latency,
+                         std::optional<bool> with_sequence,
+                         std::optional<size_t> render_threads,
+                         std::optional<size_t> shards,
+                         std::optional<size_t> writeback_size,
+                         std::optional<size_t> preallocate_size,
+                         std::optional<bool> direct_io,
+                         std::optional<bool> polled)
+      : BatchSink(std::move(name),
+                  level,
+                  thread_info_type.value_or(ThreadInfoType::NONE),
+                  capacity.value_or(1u << 11),            // 2048 events
+                  max_message_length.value_or(1u << 10),  // 1024 bytes
+                  buffer_size.value_or(1u << 22),         // 4 Mb
+                  latency.value_or(1000),                 // 1 sec
+                  with_sequence.value_or(false),
+                  shards.value_or(Sink::default_shards),
+                  false,
+                  polled.value_or(false)),
+        path_(std::move(path)),
+        writeback_size_(writeback_size.value_or(0)),
+        preallocate_size_(preallocate_size.value_or(0)),
+        direct_io_(direct_io.value_or(false)) {
+    fd_ = openFile(direct_);
+    if (fd_ == -1) {
+      std::cerr << "Can't open log file '" << path_ << "': " << strerror(errno)
+                << '\n';
+    } else {
+      resetOffsets();
+    }
+    if (auto threads = render_threads.value_or(0); threads > 1) {
+      // Thread which flushes is participating in rendering too
+      render_pool_ = std::make_unique<RenderPool>("log:" + name_, threads - 1);
+    }
+    start();
+  }
+
+  SinkToFile::~SinkToFile() {
+    stop();
+    if (fd_ != -1) {
+      ::close(fd_);
+    }
+  }
+
+  void SinkToFile::write(const Batch &events, std::vector<char> &buffer) {
+    if (render_pool_ and events.size() >= render_chunk_size * 2) {
+      writeInParallel(events);
+    } else {
+      writeInSerial(events, buffer);
+    }
+    if (direct_) {
+      // Records aren't kept in memory between batches
+      writeDirectTail();
+    }
+  }
+
+  void SinkToFile::writeInSerial(const Batch &events,
+                                 std::vector<char> &buffer) {
+    auto *const end = buffer.data() + buffer.size();  // NOLINT
+    auto *ptr = buffer.data();
+
+    Renderer renderer(with_sequence_,
+                      thread_info_type_,
+                      max_message_length_,
+                      redactor(),
+                      prefixes_);
+
+    // Piece of buffer which isn't added to gathering write yet
+    auto *piece = ptr;
+    iov_.clear();
+
+    for (const auto &node : events) {
+      ptr = renderer.renderPrefix(
+          ptr, end, *node, node.lane(), node.sequence());
+
+      // Redacted message is masked in copy, because slot is read-only
+      const auto message = renderer.messageOf(*node);
+      if (message.size() < min_in_place_message_size
+          or renderer.hasRedactor()) {
+        ptr = renderer.renderMessage(ptr, *node);
+      } else {
+        iov_.push_back({piece, static_cast<size_t>(ptr - piece)});
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+        iov_.push_back({const_cast<char *>(message.data()), message.size()});
+        piece = ptr;
       }
+      *ptr++ = '\n';  // NOLINT
+    }
+    iov_.push_back({piece, static_cast<size_t>(ptr - piece)});
+
+    // Events stay in slots until batch is written
+    writeOut(iov_.data(), iov_.size());
+  }
 
-      break;
+  void SinkToFile::writeInParallel(const Batch &events) {
+    const auto chunks =
+        (events.size() + render_chunk_size - 1) / render_chunk_size;
+    if (chunks_.size() < chunks) {
+      chunks_.resize(chunks);
+      chunk_sizes_.resize(chunks);
+      chunk_prefixes_.resize(chunks);
     }
 
-    bool true_v = true;
-    if (need_to_rotate_.compare_exchange_weak(
-            true_v, false, std::memory_order_acq_rel)) {
-      std::ofstream out;
-      out.open(path_, std::ios::app);
-      if (not out.is_open()) {
-        if (out_.is_open()) {
-          std::cerr << "Can't re-open log file '" << path_
-                    << "': " << strerror(errno) << '\n';
-        } else {
-          std::cerr << "Can't open log file '" << path_
+    render_pool_->process(
+        chunks,
+        [&](size_t chunk) {
+          auto &buff = chunks_[chunk];
+          if (buff.empty()) {
+            buff.resize((max_message_length_ + max_record_overhead)
+                         * render_chunk_size);
+          }
+          auto *const begin = buff.data();
+          auto *const end = buff.data() + buff.size();  // NOLINT
+          auto *ptr = begin;
+
+          Renderer renderer(with_sequence_,
+                            thread_info_type_,
+                            max_message_length_,
+                            redactor(),
+                            chunk_prefixes_[chunk]);
+
+          const auto first = chunk * render_chunk_size;
+          const auto last =
+              std::min(first + render_chunk_size, events.size());
+          for (auto i = first; i < last; ++i) {
+            const auto &node = events[i];
+            ptr = renderer.render(
+                ptr, end, *node, node.lane(), node.sequence());
+          }
+          chunk_sizes_[chunk] = ptr - begin;
+        },
+        [&](size_t chunk) {
+          iovec iov{chunks_[chunk].data(), chunk_sizes_[chunk]};
+          writeOut(&iov, 1);
+        });
+  }
+
+  void SinkToFile::writeOut(iovec *iov, size_t count) noexcept {
+    if (fd_ == -1) {
+      return;
+    }
+    if (preallocate_size_ != 0) {
+      size_t size = 0;
+      for (size_t i = 0; i < count; ++i) {
+        size += iov[i].iov_len;  // NOLINT
+      }
+      preallocate(size);
+    }
+    if (direct_) {
+      writeDirect(iov, count);
+      return;
+    }
+    while (count > 0) {
+      const auto pieces = std::min<size_t>(count, IOV_MAX);
+      auto res = ::writev(fd_, iov, static_cast<int>(pieces));
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (not write_failed_) {
+          std::cerr << "Can't write to log file '" << path_
                     << "': " << strerror(errno) << '\n';
+          write_failed_ = true;
         }
-        std::cerr.flush();
-      } else {
-        std::swap(out_, out);
+        return;
+      }
+      write_failed_ = false;
+      offset_ += res;
+
+      // Skip written pieces and cut partially written one
+      auto written = static_cast<size_t>(res);
+      while (count > 0 and written >= iov->iov_len) {
+        written -= iov->iov_len;
+        ++iov;  // NOLINT
+        --count;
+      }
+      if (count > 0) {
+        iov->iov_base = static_cast<char *>(iov->iov_base) + written;  // NOLINT
+        iov->iov_len -= written;
       }
     }
+    writeBack();
+  }
 
-    flush_in_progress_.clear();
+  int SinkToFile::openFile(bool &direct) noexcept {
+#if defined(__linux__)
+    if (direct_io_) {
+      auto fd = ::open(path_.c_str(), direct_open_flags, open_mode);
+      if (fd != -1 or errno != EINVAL) {
+        direct = fd != -1;
+        return fd;
+      }
+      // Filesystem doesn't support direct I/O; page cache is used instead
+    }
+#endif
+    direct = false;
+    return ::open(path_.c_str(), open_flags, open_mode);
   }
 
-  void SinkToFile::rotate() noexcept {
-    need_to_rotate_.store(true, std::memory_order_release);
-    async_flush();
+  void SinkToFile::resetOffsets() noexcept {
+    const auto end = ::lseek(fd_, 0, SEEK_END);
+    offset_ = end < 0 ? 0 : static_cast<size_t>(end);
+    written_back_ = offset_;
+    dropped_ = offset_;
+    allocated_ = offset_;
+
+    if (direct_ and not prepareDirect()) {
+      // Direct writing is rejected by filesystem; page cache is used instead
+      ::close(fd_);
+      direct_ = false;
+      fd_ = ::open(path_.c_str(), open_flags, open_mode);
+      if (fd_ == -1) {
+        std::cerr << "Can't open log file '" << path_
+                  << "': " << strerror(errno) << '\n';
+      }
+    }
   }
 
-  void SinkToFile::run() {
-    util::setThreadName("log:" + name_);
-
-    next_flush_.store(std::chrono::steady_clock::now(),
-                      std::memory_order_relaxed);
-
-    while (true) {
-      {
-        std::unique_lock lock(mutex_);
-        if (condvar_.wait_until(lock,
-                                next_flush_.load(std::memory_order_relaxed))
-            == std::cv_status::no_timeout) {
-          if (not need_to_flush_.load(std::memory_order_relaxed)
-              and not need_to_finalize_.load(std::memory_order_relaxed)) {
-            continue;
-          }
+  bool SinkToFile::prepareDirect() noexcept {
+    if (not direct_buffer_) {
+      direct_buffer_.reset(static_cast<char *>(
+          std::aligned_alloc(direct_block_size, direct_buffer_size)));
+      if (not direct_buffer_) {
+        return false;
+      }
+    }
+    auto *const buffer = direct_buffer_.get();
+
+    // Partial last block is read to be continued and rewritten
+    direct_base_ = align_down(offset_);
+    direct_size_ = offset_ - direct_base_;
+    std::memset(buffer, 0, direct_block_size);
+    if (direct_size_ != 0
+        and ::pread(fd_,
+                    buffer,
+                    direct_block_size,
+                    static_cast<off_t>(direct_base_))
+                < static_cast<ssize_t>(direct_size_)) {
+      return false;
+    }
+
+    // Some filesystems accept O_DIRECT on opening, but reject direct writes;
+    // so the last block is rewritten by the same data as probe
+    return ::pwrite(fd_,
+                    buffer,
+                    direct_block_size,
+                    static_cast<off_t>(direct_base_))
+               == static_cast<ssize_t>(direct_block_size)
+       and ::ftruncate(fd_, static_cast<off_t>(offset_)) == 0;
+  }
+
+  void SinkToFile::writeDirect(const iovec *iov, size_t count) noexcept {
+    auto *const buffer = direct_buffer_.get();
+    for (size_t i = 0; i < count; ++i) {
+      const auto *data = static_cast<const char *>(iov[i].iov_base);  // NOLINT
+      auto size = iov[i].iov_len;  // NOLINT
+      while (size > 0) {
+        const auto part = std::min(size, direct_buffer_size - direct_size_);
+        std::memcpy(buffer + direct_size_, data, part);  // NOLINT
+        direct_size_ += part;
+        data += part;  // NOLINT
+        size -= part;
+
+        // Full buffer is written out as whole
+        if (direct_size_ == direct_buffer_size) {
+          writeBlocks(direct_buffer_size);
+          direct_base_ += direct_buffer_size;
+          direct_size_ = 0;
         }
       }
+    }
+    offset_ = direct_base_ + direct_size_;
+  }
 
-      flush();
+  void SinkToFile::writeDirectTail() noexcept {
+    if (direct_size_ == 0) {
+      return;
+    }
+    auto *const buffer = direct_buffer_.get();
+
+    // Partial block is padded to be written, then padding is cut off
+    const auto size = align_up(direct_size_);
+    std::memset(buffer + direct_size_, 0, size - direct_size_);  // NOLINT
+    if (writeBlocks(size) and size != direct_size_) {
+      ::ftruncate(fd_, static_cast<off_t>(direct_base_ + direct_size_));
+
+      // Truncation frees space reserved beyond end of file too, so it's
+      // reserved again for next batches
+      allocated_ = offset_;
+      if (preallocate_size_ != 0) {
+        preallocate(direct_block_size);
+      }
+    }
 
-      if (need_to_finalize_.load(std::memory_order_acquire)
-          && events_.size() == 0) {
-        return;
+    // Partial block is kept to be rewritten with next data
+    const auto full = align_down(direct_size_);
+    std::memmove(buffer, buffer + full, direct_size_ - full);  // NOLINT
+    direct_base_ += full;
+    direct_size_ -= full;
+  }
+
+  bool SinkToFile::writeBlocks(size_t size) noexcept {
+    size_t written = 0;
+    while (written < size) {
+      auto res = ::pwrite(fd_,
+                          direct_buffer_.get() + written,  // NOLINT
+                          size - written,
+                          static_cast<off_t>(direct_base_ + written));
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (not write_failed_) {
+          std::cerr << "Can't write to log file '" << path_
+                    << "': " << strerror(errno) << '\n';
+          write_failed_ = true;
+        }
+        return false;
       }
+      write_failed_ = false;
+      written += res;
     }
+    return true;
   }
+
+  void SinkToFile::preallocate(size_t size) noexcept {
+#if defined(__linux__)
+    if (offset_ + size <= allocated_) {
+      return;
+    }
+    // Space is reserved beyond end of file, so size of file isn't changed
+    const auto length = std::max(preallocate_size_, size);
+    if (::fallocate(fd_,
+                    FALLOC_FL_KEEP_SIZE,
+                    static_cast<off_t>(offset_),
+                    static_cast<off_t>(length))
+        == 0) {
+      allocated_ = offset_ + length;
+    } else {
+      // Filesystem doesn't support it
+      preallocate_size_ = 0;
+    }
+#endif
+  }
+
+  void SinkToFile::writeBack() noexcept {
+#if defined(__linux__)
+    if (writeback_size_ == 0 or offset_ - written_back_ < writeback_size_) {
+      return;
+    }
+    // Start writeback of just written data without waiting for it
+    ::sync_file_range(fd_,
+                      static_cast<off_t>(written_back_),
+                      static_cast<off_t>(offset_ - written_back_),
+                      SYNC_FILE_RANGE_WRITE);
+
+    // Writeback of previous range was started one step ago and mostly is
+    // done; after it is complete, pages of range are dropped from cache
+    if (written_back_ > dropped_) {
+      ::sync_file_range(fd_,
+                        static_cast<off_t>(dropped_),
+                        static_cast<off_t>(written_back_ - dropped_),
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE
+                            | SYNC_FILE_RANGE_WAIT_AFTER);
+      ::posix_fadvise(fd_,
+                      static_cast<off_t>(dropped_),
+                      static_cast<off_t>(written_back_ - dropped_),
+                      POSIX_FADV_DONTNEED);
+      dropped_ = written_back_;
+    }
+    written_back_ = offset_;
+#endif
+  }
+
+  void SinkToFile::sync() noexcept {
+    // Data is passed to kernel by each write, so there is nothing to flush
+  }
+
+  void SinkToFile::reopen() noexcept {
+    bool direct = false;
+    auto fd = openFile(direct);
+    if (fd == -1) {
+      if (fd_ != -1) {
+        std::cerr << "Can't re-open log file '" << path_
+                  << "': " << strerror(errno) << '\n';
+      } else {
+        std::cerr << "Can't open log file '" << path_
+                  << "': " << strerror(errno) << '\n';
+      }
+      std::cerr.flush();
+    } else {
+      std::swap(fd_, fd);
+      if (fd != -1) {
+        ::close(fd);
+      }
+      direct_ = direct;
+      resetOffsets();
+    }
+  }
+
 }  // namespace soralog
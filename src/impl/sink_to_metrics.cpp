@@ -0,0 +1,191 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_metrics.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace soralog {
+
+  namespace {
+
+    constexpr std::string_view metric_name = "soralog_events_total";
+
+    void put_label_value(fmt::memory_buffer &out, std::string_view value) {
+      out.push_back('"');
+      for (auto c : value) {
+        switch (c) {
+          case '\\':
+            out.append(std::string_view(R"(\\)"));
+            break;
+          case '"':
+            out.append(std::string_view(R"(\")"));
+            break;
+          case '\n':
+            out.append(std::string_view(R"(\n)"));
+            break;
+          default:
+            out.push_back(c);
+        }
+      }
+      out.push_back('"');
+    }
+
+    std::string_view level_label(Level level) {
+      switch (level) {
+        case Level::CRITICAL:
+          return "critical";
+        case Level::ERROR:
+          return "error";
+        case Level::WARN:
+          return "warning";
+        case Level::INFO:
+          return "info";
+        case Level::VERBOSE:
+          return "verbose";
+        case Level::DEBUG:
+          return "debug";
+        case Level::TRACE:
+          return "trace";
+        default:
+          return "unknown";
+      }
+    }
+
+  }  // namespace
+
+  SinkToMetrics::SinkToMetrics(std::string name,
+                               Level level,
+                               std::optional<std::filesystem::path> path,
+                               std::optional<size_t> period,
+                               std::optional<size_t> capacity)
+      : Sink(std::move(name),
+             level,
+             ThreadInfoType::NONE,
+             4,  // events are never queued
+             0,
+             0,
+             1000),
+        path_(path.value_or(std::filesystem::path{})),
+        period_(period.value_or(10000)) {  // 10 sec
+    counters_ = std::make_unique<EventCounters>(capacity.value_or(1024));
+    if (path_.empty() or period_ == std::chrono::milliseconds::zero()) {
+      return;
+    }
+    next_dump_ = std::chrono::steady_clock::now() + period_;
+    scheduler_.start(
+        "log:" + name_,
+        [this] {
+          flush();
+          next_dump_ = std::chrono::steady_clock::now() + period_;
+        },
+        [this] {
+          // Idle sink sleeps until the next event; it's dumped at once, if
+          // period is passed already
+          if (park([&] {
+                std::lock_guard lock(dump_mutex_);
+                return counters_->total() != dumped_total_;
+              })) {
+            return SinkScheduler::never;
+          }
+          return next_dump_;
+        });
+  }
+
+  SinkToMetrics::~SinkToMetrics() {
+    scheduler_.stop();
+    flush();
+  }
+
+  std::vector<SinkToMetrics::Counter> SinkToMetrics::counters() const {
+    return counters_->counters();
+  }
+
+  uint64_t SinkToMetrics::overflowed() const noexcept {
+    return counters_->overflowed();
+  }
+
+  std::string SinkToMetrics::render() const {
+    fmt::memory_buffer out;
+    auto it = std::back_inserter(out);
+
+    fmt::format_to(it,
+                   "# HELP {} Number of log events by logger, level and "
+                   "call site\n# TYPE {} counter\n",
+                   metric_name,
+                   metric_name);
+    for (const auto &counter : counters_->counters()) {
+      fmt::format_to(it, "{}{{sink=", metric_name);
+      put_label_value(out, name_);
+      out.append(std::string_view(",logger="));
+      put_label_value(out, counter.logger);
+      fmt::format_to(it, ",level=\"{}\",site=", level_label(counter.level));
+      put_label_value(out, counter.site);
+      fmt::format_to(it, "}} {}\n", counter.count);
+    }
+
+    fmt::format_to(it,
+                   "# HELP {0}_overflowed Number of log events not counted "
+                   "by key\n# TYPE {0}_overflowed counter\n"
+                   "{0}_overflowed{{sink=",
+                   metric_name);
+    put_label_value(out, name_);
+    fmt::format_to(it, "}} {}\n", counters_->overflowed());
+
+    return fmt::to_string(out);
+  }
+
+  void SinkToMetrics::flush() noexcept {
+    dump(false);
+  }
+
+  void SinkToMetrics::dump(bool forced) noexcept {
+    if (path_.empty()) {
+      return;
+    }
+    std::lock_guard lock(dump_mutex_);
+    const auto total = counters_->total();
+    if (not forced and total == dumped_total_) {
+      return;
+    }
+    try {
+      // Write and rename, so reader never sees partial file
+      auto tmp_path = path_;
+      tmp_path += ".tmp";
+      {
+        std::ofstream out(tmp_path, std::ios::trunc);
+        if (not out.is_open()) {
+          std::cerr << "Can't open metrics file '" << tmp_path
+                    << "': " << strerror(errno) << '\n';
+          return;
+        }
+        out << render();
+      }
+      std::filesystem::rename(tmp_path, path_);
+      dumped_total_ = total;
+    } catch (const std::exception &exception) {
+      std::cerr << "Can't dump metrics of sink '" << name_
+                << "': " << exception.what() << '\n';
+    }
+  }
+
+  void SinkToMetrics::async_flush() noexcept {
+    // Dumps are periodic; counters are always actual
+  }
+
+  void SinkToMetrics::rotate() noexcept {
+    // File might be moved away
+    dump(true);
+  }
+
+  void SinkToMetrics::wakeUp() noexcept {
+    scheduler_.wake();
+  }
+
+}  // namespace soralog
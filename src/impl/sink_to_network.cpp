@@ -0,0 +1,617 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_network.hpp>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <fmt/chrono.h>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace std::chrono_literals;
+
+    // Separator is using between logical parts of log record.
+    // Might be any substring or symbol: space, tab, etc.
+    // Couple of space is selected to differ of single space
+    constexpr std::string_view separator = "  ";
+
+    // Size of frame header (length of payload) for TCP
+    constexpr size_t frame_header_size = 4;
+
+    // Max size of rendered record without message
+    constexpr size_t max_prefix_size = 128;
+
+    // Reconnection delays
+    constexpr auto min_backoff = 100ms;
+    constexpr auto max_backoff = 30s;
+
+    // Limit of time to establish connection
+    constexpr auto connect_timeout = 5s;
+
+    // Interval of checking for connection is established
+    constexpr auto connect_poll_interval = 10ms;
+
+    // How long worker tries to send remaining data on finalization
+    constexpr auto finalize_timeout = 1s;
+
+#if defined(MSG_NOSIGNAL)
+    constexpr int send_flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+#else
+    constexpr int send_flags = MSG_DONTWAIT;
+#endif
+
+    void put_separator(char *&ptr) {
+      for (auto c : separator) {
+        *ptr++ = c;  // NOLINT
+      }
+    }
+
+    void put_level(char *&ptr, Level level) {
+      const char *const end = ptr + 8;  // NOLINT
+      const char *str = levelToStr(level);
+      while (auto c = *str++) {  // NOLINT
+        *ptr++ = c;              // NOLINT
+      }
+      while (ptr < end) {
+        *ptr++ = ' ';  // NOLINT
+      }
+    }
+
+    template <typename T>
+    void put_string(char *&ptr, const T &name) {
+      for (auto c : name) {
+        *ptr++ = c;  // NOLINT
+      }
+    }
+
+    template <typename T>
+    void put_string(char *&ptr, const T &name, size_t width) {
+      if (width == 0) {
+        return;
+      }
+      for (auto c : name) {
+        if (c == '\0' or width == 0) {
+          break;
+        }
+        *ptr++ = c;  // NOLINT
+        --width;
+      }
+      while (width--) {
+        *ptr++ = ' ';  // NOLINT
+      }
+    }
+
+  }  // namespace
+
+  SinkToNetwork::SinkToNetwork(
+      std::string name,
+      Level level,
+      Protocol protocol,
+      std::string host,
+      uint16_t port,
+      std::optional<ThreadInfoType> thread_info_type,
+      std::optional<size_t> capacity,
+      std::optional<size_t> max_message_length,
+      std::optional<size_t> buffer_size,
+      std::optional<size_t> latency,
+      std::optional<size_t> max_pending_size,
+      std::optional<size_t> max_datagram_size,
+      std::optional<std::filesystem::path> spool_path,
+      std::optional<bool> with_sequence,
+      std::optional<size_t> shards)
+      : Sink(std::move(name),
+             level,
+             thread_info_type.value_or(ThreadInfoType::NONE),
+             capacity.value_or(1u << 11),            // 2048 events
+             max_message_length.value_or(1u << 10),  // 1024 bytes
+             buffer_size.value_or(1u << 16),         // 64 Kb
+             latency.value_or(100),                  // 100 ms
+             with_sequence.value_or(false),
+             shards.value_or(Sink::default_shards)),
+        protocol_(protocol),
+        host_(std::move(host)),
+        port_(port),
+        max_pending_size_(max_pending_size.value_or(1u << 22)),  // 4 Mb
+        max_batch_size_(protocol_ == Protocol::UDP
+                            ? max_datagram_size.value_or(1400)  // MTU-safe
+                            : max_buffer_size_),
+        spool_path_(std::move(spool_path)),
+        buff_(max_message_length_ + max_prefix_size),
+        backoff_(min_backoff) {
+    if (spool_path_) {
+      // Data spooled by previous run is sent after connect
+      std::error_code ec;
+      auto size = std::filesystem::file_size(*spool_path_, ec);
+      spool_size_ = ec ? 0 : size;
+    }
+    // Connection is managed by worker even without latency, so resolving
+    // of host (blocking getaddrinfo) and connecting never hold producers
+    scheduler_.start(
+        "log:" + name_,
+        [this] { flush(true); },
+        [this] { return nextDeadline(); });
+    // The first pass connects at once
+    scheduler_.request();
+  }
+
+  SinkToNetwork::~SinkToNetwork() {
+    scheduler_.stop();
+    // Try to deliver the rest while connection is alive
+    flush(true);
+    deliverRest();
+
+    // Keep undelivered data for next run, if it's possible
+    for (auto &batch : pending_) {
+      auto data = payload(batch.data);
+      if (spool_path_) {
+        if (not spool_.is_open()) {
+          spool_.open(*spool_path_, std::ios::app | std::ios::binary);
+        }
+        spool_.write(data.data(), static_cast<std::streamsize>(data.size()));
+      } else {
+        dropped_ += batch.events;
+      }
+    }
+    pending_.clear();
+
+    disconnect(false);
+  }
+
+  void SinkToNetwork::async_flush() noexcept {
+    scheduler_.request();
+  }
+
+  void SinkToNetwork::wakeUp() noexcept {
+    // Worker is either waiting already or sees event before parking
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_relaxed);
+    scheduler_.wake();
+  }
+
+  void SinkToNetwork::flush() noexcept {
+    // Connection is managed by worker to don't block producers
+    flush(false);
+  }
+
+  void SinkToNetwork::flush(bool can_connect) noexcept {
+    // Flush by other thread might miss events pushed by this one, so it
+    // does one more pass for them
+    combiner_.combine([this, can_connect] { drain(can_connect); });
+  }
+
+  void SinkToNetwork::drain(bool can_connect) noexcept {
+    if (can_connect) {
+      connect();
+    }
+
+    auto *const begin = buff_.data();
+    auto *const end = buff_.data() + buff_.size();  // NOLINT
+    const auto header_size =
+        protocol_ == Protocol::TCP ? frame_header_size : 0;
+
+    decltype(1s / 1s) psec = 0;
+    std::tm tm{};
+    std::array<char, 17> datetime{};  // "00.00.00 00:00:00"
+
+    while (true) {
+      auto node = nextEvent();
+      if (not node) {
+        break;
+      }
+      const auto &event = *node;
+      auto *ptr = begin;
+
+      const auto time = event.timestamp().time_since_epoch();
+      const auto sec = time / 1s;
+      const auto usec = time % 1s / 1us;
+
+      if (psec != sec) {
+        tm = fmt::localtime(sec);
+        fmt::format_to_n(datetime.data(),
+                         datetime.size(),
+                         "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}",
+                         tm.tm_year % 100,
+                         tm.tm_mon + 1,
+                         tm.tm_mday,
+                         tm.tm_hour,
+                         tm.tm_min,
+                         tm.tm_sec);
+        psec = sec;
+      }
+
+      // Timestamp
+
+      std::memcpy(ptr, datetime.data(), datetime.size());
+      ptr = ptr + datetime.size();  // NOLINT
+
+      ptr = fmt::format_to_n(ptr, end - ptr, ".{:0>6}", usec).out;
+
+      put_separator(ptr);
+
+      // Sequence
+
+      if (with_sequence_) {
+        ptr = fmt::format_to_n(
+                  ptr, end - ptr, "#{}.{:<6}", node.lane(), node.sequence())
+                  .out;
+        put_separator(ptr);
+      }
+
+      // Thread
+
+      switch (thread_info_type_) {
+        case ThreadInfoType::NAME:
+          put_string(ptr, event.thread_name(), 15);
+          put_separator(ptr);
+          break;
+
+        case ThreadInfoType::ID:
+          ptr = fmt::format_to_n(
+                    ptr, end - ptr, "T:{:<6}", event.thread_number())
+                    .out;
+          put_separator(ptr);
+          break;
+
+        default:
+          break;
+      }
+
+      // Level
+
+      put_level(ptr, event.level());
+      put_separator(ptr);
+
+      // Name
+
+      put_string(ptr, event.name());
+      put_separator(ptr);
+
+      // Message
+
+      put_string(ptr, messageOf(event));
+      *ptr++ = '\n';  // NOLINT
+
+      accountWritten(node);
+
+      // Line must fit into batch (actual for datagram)
+      auto size = std::min<size_t>(ptr - begin, max_batch_size_);
+      begin[size - 1] = '\n';  // NOLINT
+
+      if (batch_.size() + size > header_size + max_batch_size_) {
+        enqueue(std::move(batch_), batch_events_);
+        batch_.clear();
+        batch_events_ = 0;
+      }
+      if (batch_.empty()) {
+        batch_.resize(header_size);
+      }
+      batch_.append(begin, size);
+      ++batch_events_;
+    }
+
+    if (batch_.size() > header_size) {
+      enqueue(std::move(batch_), batch_events_);
+      batch_.clear();
+      batch_events_ = 0;
+    }
+
+    send();
+
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_release);
+
+    // Sequentially consistent with parking of worker (see Sink::park())
+    const bool unsent = not pending_.empty() or spool_offset_ < spool_size_
+                     or not spooled_batch_.empty();
+    has_unsent_.store(unsent, std::memory_order_seq_cst);
+    if (unsent) {
+      unpark();
+    }
+  }
+
+  void SinkToNetwork::enqueue(std::string data, size_t events) noexcept {
+    if (protocol_ == Protocol::TCP) {
+      auto size = data.size() - frame_header_size;
+      data[0] = static_cast<char>((size >> 24) & 0xff);
+      data[1] = static_cast<char>((size >> 16) & 0xff);
+      data[2] = static_cast<char>((size >> 8) & 0xff);
+      data[3] = static_cast<char>(size & 0xff);
+    }
+    pending_size_ += data.size();
+    pending_.emplace_back(Batch{std::move(data), events});
+    restrictPending();
+  }
+
+  void SinkToNetwork::restrictPending() noexcept {
+    // Partially sent batch must be finished to keep stream consistent
+    const size_t first = sent_offset_ != 0 ? 1 : 0;
+
+    while (pending_size_ > max_pending_size_ and pending_.size() > first) {
+      auto it = std::next(pending_.begin(), static_cast<ptrdiff_t>(first));
+      auto data = payload(it->data);
+      if (spool_path_) {
+        if (not spool_.is_open()) {
+          spool_.open(*spool_path_, std::ios::app | std::ios::binary);
+          if (not spool_.is_open()) {
+            std::cerr << "Can't open spool file '" << *spool_path_
+                      << "': " << strerror(errno) << '\n';
+          }
+        }
+      }
+      if (spool_.is_open()) {
+        spool_.write(data.data(), static_cast<std::streamsize>(data.size()));
+        spool_.flush();
+        spool_size_ += data.size();
+      } else {
+        dropped_ += it->events;
+      }
+      pending_size_ -= it->data.size();
+      pending_.erase(it);
+    }
+  }
+
+  std::string_view SinkToNetwork::payload(
+      const std::string &batch) const noexcept {
+    std::string_view data(batch);
+    if (protocol_ == Protocol::TCP) {
+      data.remove_prefix(frame_header_size);
+    }
+    return data;
+  }
+
+  void SinkToNetwork::connect() noexcept {
+    auto now = std::chrono::steady_clock::now();
+
+    if (state_ == State::DISCONNECTED) {
+      if (now < next_connect_.load(std::memory_order_relaxed)) {
+        return;
+      }
+
+      addrinfo hints{};
+      hints.ai_family = AF_UNSPEC;
+      hints.ai_socktype =
+          protocol_ == Protocol::TCP ? SOCK_STREAM : SOCK_DGRAM;
+      addrinfo *addresses = nullptr;
+      if (::getaddrinfo(host_.c_str(),
+                        std::to_string(port_).c_str(),
+                        &hints,
+                        &addresses)
+              != 0
+          or addresses == nullptr) {
+        disconnect(true);
+        return;
+      }
+
+      socket_ = ::socket(addresses->ai_family,
+                         addresses->ai_socktype,
+                         addresses->ai_protocol);
+      if (socket_ == -1) {
+        ::freeaddrinfo(addresses);
+        disconnect(true);
+        return;
+      }
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+      ::fcntl(socket_, F_SETFL, ::fcntl(socket_, F_GETFL) | O_NONBLOCK);
+#if defined(SO_NOSIGPIPE)
+      int on = 1;
+      ::setsockopt(socket_, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+      auto res =
+          ::connect(socket_, addresses->ai_addr, addresses->ai_addrlen);
+      ::freeaddrinfo(addresses);
+
+      if (res == 0) {
+        state_ = State::CONNECTED;
+        backoff_ = min_backoff;
+        return;
+      }
+      if (errno != EINPROGRESS) {
+        disconnect(true);
+        return;
+      }
+      state_ = State::CONNECTING;
+      connect_deadline_ = now + connect_timeout;
+    }
+
+    if (state_ == State::CONNECTING) {
+      pollfd pfd{socket_, POLLOUT, 0};
+      auto res = ::poll(&pfd, 1, 0);
+      if (res == 0) {
+        if (now > connect_deadline_) {
+          disconnect(true);
+        }
+        return;
+      }
+      int error = 0;
+      socklen_t len = sizeof(error);
+      if (res < 0
+          or ::getsockopt(socket_, SOL_SOCKET, SO_ERROR, &error, &len) != 0
+          or error != 0) {
+        disconnect(true);
+        return;
+      }
+      state_ = State::CONNECTED;
+      backoff_ = min_backoff;
+    }
+  }
+
+  void SinkToNetwork::disconnect(bool failed) noexcept {
+    if (socket_ != -1) {
+      ::close(socket_);
+      socket_ = -1;
+    }
+    state_ = State::DISCONNECTED;
+
+    // Partially sent batches will be sent entirely over new connection
+    sent_offset_ = 0;
+    spooled_sent_offset_ = 0;
+
+    if (failed) {
+      next_connect_ = std::chrono::steady_clock::now() + backoff_;
+      backoff_ = std::min<std::chrono::milliseconds>(backoff_ * 2, max_backoff);
+    }
+  }
+
+  void SinkToNetwork::send() noexcept {
+    if (state_ != State::CONNECTED) {
+      return;
+    }
+
+    // Spooled data are older than pending, so they must be sent first
+    if (not sendSpooled()) {
+      return;
+    }
+
+    while (not pending_.empty()) {
+      const auto &batch = pending_.front().data;
+      auto res = ::send(socket_,
+                        batch.data() + sent_offset_,  // NOLINT
+                        batch.size() - sent_offset_,
+                        send_flags);
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno == EAGAIN or errno == EWOULDBLOCK) {
+          return;
+        }
+        if (protocol_ == Protocol::UDP and errno == EMSGSIZE) {
+          dropped_ += pending_.front().events;
+          res = static_cast<ssize_t>(batch.size() - sent_offset_);
+        } else {
+          disconnect(true);
+          return;
+        }
+      }
+      sent_offset_ += res;
+      if (sent_offset_ == batch.size()) {
+        pending_size_ -= batch.size();
+        pending_.pop_front();
+        sent_offset_ = 0;
+      }
+    }
+  }
+
+  bool SinkToNetwork::sendSpooled() noexcept {
+    const auto header_size =
+        protocol_ == Protocol::TCP ? frame_header_size : 0;
+
+    while (spool_offset_ < spool_size_ or not spooled_batch_.empty()) {
+      if (spooled_batch_.empty()) {
+        std::ifstream in(*spool_path_, std::ios::binary);
+        in.seekg(static_cast<std::streamoff>(spool_offset_));
+        std::string chunk(std::min(spool_size_ - spool_offset_,
+                                   max_batch_size_),
+                          '\0');
+        in.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        if (static_cast<size_t>(in.gcount()) != chunk.size()) {
+          // Spool is damaged - forget it
+          spool_offset_ = spool_size_;
+          break;
+        }
+        // Keep lines entire, if it's possible
+        if (auto pos = chunk.rfind('\n');
+            pos != std::string::npos and pos + 1 < chunk.size()) {
+          chunk.resize(pos + 1);
+        }
+        spool_offset_ += chunk.size();
+        spooled_batch_.resize(header_size);
+        spooled_batch_.append(chunk);
+        if (protocol_ == Protocol::TCP) {
+          auto size = chunk.size();
+          spooled_batch_[0] = static_cast<char>((size >> 24) & 0xff);
+          spooled_batch_[1] = static_cast<char>((size >> 16) & 0xff);
+          spooled_batch_[2] = static_cast<char>((size >> 8) & 0xff);
+          spooled_batch_[3] = static_cast<char>(size & 0xff);
+        }
+      }
+
+      auto res = ::send(socket_,
+                        spooled_batch_.data() + spooled_sent_offset_,  // NOLINT
+                        spooled_batch_.size() - spooled_sent_offset_,
+                        send_flags);
+      if (res < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        if (errno != EAGAIN and errno != EWOULDBLOCK) {
+          disconnect(true);
+        }
+        return false;
+      }
+      spooled_sent_offset_ += res;
+      if (spooled_sent_offset_ == spooled_batch_.size()) {
+        spooled_batch_.clear();
+        spooled_sent_offset_ = 0;
+      }
+    }
+
+    if (spool_size_ != 0) {
+      // Spool is sent entirely - truncate it
+      spool_.close();
+      spool_.open(*spool_path_, std::ios::trunc | std::ios::binary);
+      spool_.close();
+      spool_size_ = 0;
+      spool_offset_ = 0;
+    }
+    return true;
+  }
+
+  std::chrono::steady_clock::time_point SinkToNetwork::nextDeadline() noexcept {
+    if (state_.load(std::memory_order_relaxed) != State::CONNECTING
+        and park([&] {
+              return has_unsent_.load(std::memory_order_relaxed);
+            })) {
+      return SinkScheduler::never;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    // Without latency producers send events themselves, and worker retries
+    // to send the rest only
+    const bool no_latency = latency_ == std::chrono::milliseconds::zero();
+    auto deadline = no_latency ? now + connect_poll_interval
+                               : next_flush_.load(std::memory_order_relaxed);
+    switch (state_.load(std::memory_order_relaxed)) {
+      case State::DISCONNECTED: {
+        const auto next_connect =
+            next_connect_.load(std::memory_order_relaxed);
+        deadline = no_latency ? next_connect : std::min(deadline, next_connect);
+        break;
+      }
+      case State::CONNECTING:
+        deadline = std::min(deadline, now + connect_poll_interval);
+        break;
+      default:
+        break;
+    }
+    return deadline;
+  }
+
+  void SinkToNetwork::deliverRest() noexcept {
+    auto deadline = std::chrono::steady_clock::now() + finalize_timeout;
+    while ((not pending_.empty() or spool_offset_ < spool_size_)
+           and state_ != State::DISCONNECTED
+           and std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(connect_poll_interval);
+      flush(true);
+    }
+  }
+
+}  // namespace soralog
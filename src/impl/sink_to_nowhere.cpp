@@ -25,8 +25,8 @@ namespace soralog {
   }
 
   void SinkToNowhere::flush() noexcept {
-    while (events_.size() > 0) {
-      std::ignore = events_.get();
+    while (hasEvents()) {
+      std::ignore = nextEvent();
     }
   }
 
@@ -0,0 +1,593 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_otlp.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <fmt/format.h>
+
+namespace soralog {
+
+  namespace {
+
+    // Limit of time to establish connection, send request and get response
+    constexpr auto io_timeout = 5s;
+
+    // Max size of response header
+    constexpr size_t max_response_header_size = 1u << 14;
+
+#if defined(MSG_NOSIGNAL)
+    constexpr int send_flags = MSG_NOSIGNAL;
+#else
+    constexpr int send_flags = 0;
+#endif
+
+    /**
+     * Appends {@param str} into {@param out} as JSON string
+     */
+    void put_json_string(std::string &out, std::string_view str) {
+      out.push_back('"');
+      for (auto c : str) {
+        switch (c) {
+          case '"':
+            out.append("\\\"");
+            break;
+          case '\\':
+            out.append("\\\\");
+            break;
+          case '\n':
+            out.append("\\n");
+            break;
+          case '\r':
+            out.append("\\r");
+            break;
+          case '\t':
+            out.append("\\t");
+            break;
+          default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+              fmt::format_to(std::back_inserter(out),
+                             "\\u{:04x}",
+                             static_cast<unsigned>(c));
+            } else {
+              out.push_back(c);
+            }
+        }
+      }
+      out.push_back('"');
+    }
+
+    bool iequals(std::string_view a, std::string_view b) {
+      return a.size() == b.size()
+         and std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x))
+                   == std::tolower(static_cast<unsigned char>(y));
+             });
+    }
+
+  }  // namespace
+
+  SinkToOtlp::SinkToOtlp(std::string name,
+                         Level level,
+                         const std::string &endpoint,
+                         std::optional<ThreadInfoType> thread_info_type,
+                         std::optional<size_t> capacity,
+                         std::optional<size_t> max_message_length,
+                         std::optional<size_t> buffer_size,
+                         std::optional<size_t> latency,
+                         std::optional<bool> compression,
+                         std::optional<std::string> service_name)
+      : Sink(std::move(name),
+             level,
+             thread_info_type.value_or(ThreadInfoType::NONE),
+             capacity.value_or(1u << 11),            // 2048 events
+             max_message_length.value_or(1u << 10),  // 1024 bytes
+             buffer_size.value_or(1u << 20),         // 1 Mb
+             latency.value_or(1000)),                // 1 sec
+        compression_(compression.value_or(true)),
+        service_name_(std::move(service_name)) {
+    // Parse endpoint: http://host[:port][/path]
+    constexpr std::string_view scheme = "http://";
+    if (endpoint.compare(0, scheme.size(), scheme) != 0) {
+      throw std::invalid_argument("Endpoint of OTLP sink '" + name_
+                                  + "' must start with 'http://': "
+                                  + endpoint);
+    }
+    auto authority_end = endpoint.find('/', scheme.size());
+    auto authority =
+        endpoint.substr(scheme.size(), authority_end - scheme.size());
+    path_ = authority_end == std::string::npos ? "/v1/logs"
+                                               : endpoint.substr(authority_end);
+
+    auto port_pos = authority.rfind(':');
+    if (port_pos != std::string::npos
+        and authority.find(']', port_pos) == std::string::npos) {
+      auto port_str = authority.substr(port_pos + 1);
+      int port = 0;
+      try {
+        port = std::stoi(port_str);
+      } catch (const std::exception &) {
+        port = 0;
+      }
+      if (port <= 0 or port > 65535
+          or std::to_string(port) != port_str) {
+        throw std::invalid_argument("Wrong port in endpoint of OTLP sink '"
+                                    + name_ + "': " + endpoint);
+      }
+      port_ = static_cast<uint16_t>(port);
+      authority.resize(port_pos);
+    }
+    if (authority.size() > 2 and authority.front() == '['
+        and authority.back() == ']') {
+      authority = authority.substr(1, authority.size() - 2);
+    }
+    if (authority.empty()) {
+      throw std::invalid_argument("Empty host in endpoint of OTLP sink '"
+                                  + name_ + "': " + endpoint);
+    }
+    host_ = std::move(authority);
+
+    scheduler_.start(
+        "log:" + name_,
+        [this] {
+          flush();
+          exportPending();
+        },
+        [this] { return nextExport(); });
+  }
+
+  SinkToOtlp::~SinkToOtlp() {
+    scheduler_.stop();
+    flush();
+    exportPending();
+    disconnect();
+  }
+
+  int SinkToOtlp::severityNumber(Level level) noexcept {
+    switch (level) {
+      case Level::CRITICAL:
+        return 21;  // FATAL
+      case Level::ERROR:
+        return 17;  // ERROR
+      case Level::WARN:
+        return 13;  // WARN
+      case Level::INFO:
+        return 9;  // INFO
+      case Level::VERBOSE:
+        return 8;  // DEBUG4
+      case Level::DEBUG:
+        return 5;  // DEBUG
+      case Level::TRACE:
+        return 1;  // TRACE
+      default:
+        return 0;  // UNSPECIFIED
+    }
+  }
+
+  void SinkToOtlp::async_flush() noexcept {
+    scheduler_.request();
+  }
+
+  void SinkToOtlp::wakeUp() noexcept {
+    // Worker is either waiting already or sees event before parking
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_relaxed);
+    scheduler_.wake();
+  }
+
+  std::chrono::steady_clock::time_point SinkToOtlp::nextExport() noexcept {
+    // Without latency events are flushed by producers, which request export
+    if (park([] { return false; }) or latency_ == 0ms) {
+      return SinkScheduler::never;
+    }
+    return next_flush_.load(std::memory_order_relaxed);
+  }
+
+  void SinkToOtlp::flush() noexcept {
+    // Events of concurrent producers are moved into batches by one of them;
+    // batches are exported by worker, so producers never wait for collector
+    combiner_.combine([this] { drain(); });
+  }
+
+  void SinkToOtlp::drain() noexcept {
+    while (true) {
+      auto node = nextEvent();
+      if (not node) {
+        break;
+      }
+      append(*node, node.lane(), node.sequence());
+
+      accountWritten(node);
+
+      if (batch_size_ >= max_buffer_size_) {
+        seal();
+      }
+    }
+
+    if (records_count_ != 0) {
+      seal();
+    }
+
+    next_flush_.store(std::chrono::steady_clock::now() + latency_,
+                      std::memory_order_release);
+  }
+
+  void SinkToOtlp::append(const Event &event,
+                          uint32_t lane,
+                          uint64_t sequence) {
+    auto name = event.name();
+    auto it = std::find_if(
+        scopes_.begin(), scopes_.end(), [&](const Scope &scope) {
+          return scope.name == name;
+        });
+    if (it == scopes_.end()) {
+      it = scopes_.emplace(scopes_.end(), Scope{std::string(name), {}});
+      batch_size_ += name.size();
+    }
+
+    auto &out = it->records;
+    auto size_before = out.size();
+    if (not out.empty()) {
+      out.push_back(',');
+    }
+
+    const auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        event.timestamp().time_since_epoch());
+    fmt::format_to(std::back_inserter(out),
+                   R"({{"timeUnixNano":"{}","severityNumber":{},)"
+                   R"("severityText":"{}","body":{{"stringValue":)",
+                   time.count(),
+                   severityNumber(event.level()),
+                   levelToStr(event.level()));
+    put_json_string(out, messageOf(event));
+    out.push_back('}');
+
+    out.append(R"(,"attributes":[{"key":"logger.name","value":)"
+               R"({"stringValue":)");
+    put_json_string(out, name);
+    out.append("}}");
+    switch (thread_info_type_) {
+      case ThreadInfoType::NAME:
+        out.append(R"(,{"key":"thread.name","value":{"stringValue":)");
+        put_json_string(out, event.thread_name());
+        out.append("}}");
+        break;
+
+      case ThreadInfoType::ID:
+        fmt::format_to(std::back_inserter(out),
+                       R"(,{{"key":"thread.id","value":{{"intValue":"{}"}}}})",
+                       event.thread_number());
+        break;
+
+      default:
+        break;
+    }
+    // Events are numbered per lane (see Sink::laneOfThread)
+    fmt::format_to(std::back_inserter(out),
+                   R"(,{{"key":"soralog.lane","value":{{"intValue":"{}"}}}})"
+                   R"(,{{"key":"soralog.sequence","value":)"
+                   R"({{"intValue":"{}"}}}}]}})",
+                   lane,
+                   sequence);
+
+    batch_size_ += out.size() - size_before;
+    ++records_count_;
+  }
+
+  void SinkToOtlp::seal() noexcept {
+    Batch batch;
+    batch.records = records_count_;
+
+    auto &body = batch.body;
+    body.append(R"({"resourceLogs":[{"resource":{"attributes":[)");
+    fmt::format_to(std::back_inserter(body),
+                   R"({{"key":"process.pid","value":{{"intValue":"{}"}}}})",
+                   ::getpid());
+    if (service_name_) {
+      body.append(R"(,{"key":"service.name","value":{"stringValue":)");
+      put_json_string(body, *service_name_);
+      body.append("}}");
+    }
+    body.append(R"(]},"scopeLogs":[)");
+    bool first = true;
+    for (auto &scope : scopes_) {
+      if (not first) {
+        body.push_back(',');
+      }
+      first = false;
+      body.append(R"({"scope":{"name":)");
+      put_json_string(body, scope.name);
+      body.append(R"(},"logRecords":[)");
+      body.append(scope.records);
+      body.append("]}");
+    }
+    body.append("]}]}");
+
+    scopes_.clear();
+    records_count_ = 0;
+    batch_size_ = 0;
+
+    {
+      std::lock_guard lock(mutex_);
+      // The oldest batch is dropped, if collector doesn't keep up
+      if (pending_.size() >= max_pending_batches) {
+        dropped_ += pending_.front().records;
+        pending_.pop_front();
+      }
+      pending_.emplace_back(std::move(batch));
+    }
+
+    if (not scheduler_.isRunning()) {
+      async_flush();
+    }
+  }
+
+  void SinkToOtlp::exportPending() noexcept {
+    while (true) {
+      size_t count = 0;
+      {
+        std::lock_guard lock(mutex_);
+        if (pending_.empty()) {
+          return;
+        }
+        body_ = std::move(pending_.front().body);
+        count = pending_.front().records;
+        pending_.pop_front();
+      }
+
+      bool success = false;
+      try {
+        const bool compressed = compression_ and compress();
+        const auto &body = compressed ? compressed_ : body_;
+        const char *encoding = compressed ? "gzip" : nullptr;
+
+        // Connection might be closed by collector while it was idle
+        const bool reused = socket_ != -1;
+        success = post(body, encoding);
+        if (not success and reused and socket_ == -1) {
+          success = post(body, encoding);
+        }
+      } catch (const std::exception &) {
+        success = false;
+      }
+
+      if (success) {
+        exported_ += count;
+      } else {
+        dropped_ += count;
+      }
+    }
+  }
+
+  bool SinkToOtlp::compress() {
+    z_stream stream{};
+    // windowBits 15 + 16 means gzip wrapper
+    if (deflateInit2(&stream,
+                     Z_DEFAULT_COMPRESSION,
+                     Z_DEFLATED,
+                     15 + 16,
+                     8,
+                     Z_DEFAULT_STRATEGY)
+        != Z_OK) {
+      return false;
+    }
+    compressed_.resize(deflateBound(&stream, body_.size()));
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    stream.next_in = reinterpret_cast<Bytef *>(body_.data());
+    stream.avail_in = body_.size();
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    stream.next_out = reinterpret_cast<Bytef *>(compressed_.data());
+    stream.avail_out = compressed_.size();
+
+    auto res = deflate(&stream, Z_FINISH);
+    compressed_.resize(stream.total_out);
+    deflateEnd(&stream);
+    return res == Z_STREAM_END;
+  }
+
+  bool SinkToOtlp::connect() noexcept {
+    if (socket_ != -1) {
+      return true;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo *addresses = nullptr;
+    if (::getaddrinfo(
+            host_.c_str(), std::to_string(port_).c_str(), &hints, &addresses)
+            != 0
+        or addresses == nullptr) {
+      return false;
+    }
+
+    socket_ = ::socket(
+        addresses->ai_family, addresses->ai_socktype, addresses->ai_protocol);
+    if (socket_ == -1) {
+      ::freeaddrinfo(addresses);
+      return false;
+    }
+
+#if defined(SO_NOSIGPIPE)
+    int on = 1;
+    ::setsockopt(socket_, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+
+    // Connect with timeout
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    auto flags = ::fcntl(socket_, F_GETFL);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    ::fcntl(socket_, F_SETFL, flags | O_NONBLOCK);
+    auto res = ::connect(socket_, addresses->ai_addr, addresses->ai_addrlen);
+    ::freeaddrinfo(addresses);
+    if (res != 0) {
+      if (errno != EINPROGRESS) {
+        disconnect();
+        return false;
+      }
+      pollfd pfd{socket_, POLLOUT, 0};
+      int error = 0;
+      socklen_t len = sizeof(error);
+      if (::poll(&pfd, 1, static_cast<int>(io_timeout / 1ms)) != 1
+          or ::getsockopt(socket_, SOL_SOCKET, SO_ERROR, &error, &len) != 0
+          or error != 0) {
+        disconnect();
+        return false;
+      }
+    }
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    ::fcntl(socket_, F_SETFL, flags);
+
+    timeval timeout{io_timeout / 1s, 0};
+    ::setsockopt(socket_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(socket_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return true;
+  }
+
+  void SinkToOtlp::disconnect() noexcept {
+    if (socket_ != -1) {
+      ::close(socket_);
+      socket_ = -1;
+    }
+  }
+
+  bool SinkToOtlp::post(const std::string &body,
+                        const char *content_encoding) noexcept {
+    if (not connect()) {
+      return false;
+    }
+
+    request_.clear();
+    fmt::format_to(std::back_inserter(request_),
+                   "POST {} HTTP/1.1\r\n"
+                   "Host: {}:{}\r\n"
+                   "Content-Type: application/json\r\n"
+                   "Content-Length: {}\r\n",
+                   path_,
+                   host_,
+                   port_,
+                   body.size());
+    if (content_encoding != nullptr) {
+      fmt::format_to(std::back_inserter(request_),
+                     "Content-Encoding: {}\r\n",
+                     content_encoding);
+    }
+    request_.append("Connection: keep-alive\r\n\r\n");
+
+    // Send request
+
+    const std::array<const std::string *, 2> parts{&request_, &body};
+    for (const auto *part : parts) {
+      size_t offset = 0;
+      while (offset < part->size()) {
+        auto res = ::send(socket_,
+                          part->data() + offset,  // NOLINT
+                          part->size() - offset,
+                          send_flags);
+        if (res < 0) {
+          if (errno == EINTR) {
+            continue;
+          }
+          disconnect();
+          return false;
+        }
+        offset += res;
+      }
+    }
+
+    // Receive response header
+
+    std::string response;
+    size_t header_end = std::string::npos;
+    std::array<char, 4096> chunk{};
+    while (header_end == std::string::npos) {
+      auto res = ::recv(socket_, chunk.data(), chunk.size(), 0);
+      if (res < 0 and errno == EINTR) {
+        continue;
+      }
+      if (res <= 0 or response.size() > max_response_header_size) {
+        disconnect();
+        return false;
+      }
+      response.append(chunk.data(), res);
+      header_end = response.find("\r\n\r\n");
+    }
+
+    // Status line: HTTP/1.1 200 OK
+    int status = 0;
+    if (auto pos = response.find(' '); pos != std::string::npos) {
+      status = std::atoi(response.c_str() + pos + 1);
+    }
+
+    // Headers
+    std::optional<size_t> content_length;
+    bool keep_alive = true;
+    auto line_begin = response.find("\r\n") + 2;
+    while (line_begin < header_end) {
+      auto line_end = response.find("\r\n", line_begin);
+      std::string_view line(response.data() + line_begin,  // NOLINT
+                            line_end - line_begin);
+      line_begin = line_end + 2;
+      auto colon = line.find(':');
+      if (colon == std::string_view::npos) {
+        continue;
+      }
+      auto key = line.substr(0, colon);
+      auto value = line.substr(colon + 1);
+      while (not value.empty() and value.front() == ' ') {
+        value.remove_prefix(1);
+      }
+      if (iequals(key, "Content-Length")) {
+        content_length = std::strtoull(std::string(value).c_str(), nullptr, 10);
+      } else if (iequals(key, "Connection") and iequals(value, "close")) {
+        keep_alive = false;
+      }
+    }
+
+    // Skip response body; without known length connection can't be reused
+    if (content_length) {
+      auto received = response.size() - header_end - 4;
+      while (received < *content_length) {
+        auto res = ::recv(socket_,
+                          chunk.data(),
+                          std::min(chunk.size(), *content_length - received),
+                          0);
+        if (res < 0 and errno == EINTR) {
+          continue;
+        }
+        if (res <= 0) {
+          keep_alive = false;
+          break;
+        }
+        received += res;
+      }
+    } else {
+      keep_alive = false;
+    }
+
+    if (not keep_alive) {
+      disconnect();
+    }
+
+    return status >= 200 and status < 300;
+  }
+
+}  // namespace soralog
@@ -0,0 +1,88 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_shared_memory.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace soralog {
+
+  SinkToSharedMemory::SinkToSharedMemory(
+      std::string name,
+      Level level,
+      std::string segment,
+      std::optional<ThreadInfoType> thread_info_type,
+      [[maybe_unused]] std::optional<size_t> capacity,
+      std::optional<size_t> max_message_length,
+      [[maybe_unused]] std::optional<size_t> buffer_size,
+      [[maybe_unused]] std::optional<size_t> latency,
+      std::optional<size_t> segment_capacity)
+      : Sink(std::move(name),
+             level,
+             thread_info_type.value_or(ThreadInfoType::NONE),
+             0,                                      // no queue
+             max_message_length.value_or(1u << 10),  // 1024 bytes
+             0,                                      // no buffer
+             0) {                                    // no latency
+    direct_ = true;
+    try {
+      ring_ = std::make_unique<SharedMemoryRing>(
+          std::move(segment),
+          segment_capacity.value_or(1u << 14),  // 16384 records
+          max_message_length_);
+    } catch (const std::exception &exception) {
+      std::cerr << "Can't open shared memory segment for sink '" << name_
+                << "': " << exception.what() << '\n';
+    }
+  }
+
+  Sink::DirectSlot SinkToSharedMemory::claimDirect() noexcept {
+    if (not ring_) {
+      return {};
+    }
+    auto claim = ring_->claim();
+    return {claim.record, claim.position, claim.message};
+  }
+
+  void SinkToSharedMemory::publishDirect(
+      const DirectSlot &slot,
+      std::chrono::system_clock::time_point timestamp,
+      std::string_view name,
+      Level level,
+      size_t message_size,
+      uint64_t sequence) noexcept {
+    auto &record = *static_cast<SharedMemoryRing::Record *>(slot.place);
+    record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           timestamp.time_since_epoch())
+                           .count();
+    record.sequence = sequence;
+    record.level = level;
+    record.message_size = message_size;
+
+    record.thread_number = 0;
+    record.thread_name_size = 0;
+    switch (thread_info_type_) {
+      case ThreadInfoType::NAME:
+        util::getThreadName(record.thread_name);
+        record.thread_name_size = ::strnlen(record.thread_name.data(), 15);
+        [[fallthrough]];
+      case ThreadInfoType::ID:
+        record.thread_number = util::getThreadNumber();
+        [[fallthrough]];
+      default:
+        break;
+    }
+
+    record.name_size = std::min(name.size(), record.name.size());
+    std::copy_n(name.begin(), record.name_size, record.name.begin());
+
+    ring_->publish({&record, slot.message, slot.tag});
+  }
+
+}  // namespace soralog
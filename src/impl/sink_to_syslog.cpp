@@ -8,6 +8,7 @@
 #include <soralog/impl/sink_to_syslog.hpp>
 
 #include <chrono>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 
@@ -79,16 +80,22 @@ namespace soralog {
                              std::optional<size_t> capacity,
                              std::optional<size_t> max_message_length,
                              std::optional<size_t> buffer_size,
-                             std::optional<size_t> latency)
-      : Sink(std::move(name),
-             level,
-             thread_info_type.value_or(ThreadInfoType::NONE),
-             capacity.value_or(1u << 11),            // 2048 events
-             max_message_length.value_or(1u << 10),  // 1024 bytes
-             buffer_size.value_or(1u << 22),         // 4 Mb
-             latency.value_or(1000)),                // 1 sec
-        ident_(std::move(ident)),
-        buff_(max_buffer_size_) {
+                             std::optional<size_t> latency,
+                             std::optional<bool> with_sequence,
+                             std::optional<size_t> shards,
+                             std::optional<bool> polled)
+      : BatchSink(std::move(name),
+                  level,
+                  thread_info_type.value_or(ThreadInfoType::NONE),
+                  capacity.value_or(1u << 11),            // 2048 events
+                  max_message_length.value_or(1u << 10),  // 1024 bytes
+                  buffer_size.value_or(1u << 22),         // 4 Mb
+                  latency.value_or(1000),                 // 1 sec
+                  with_sequence.value_or(false),
+                  shards.value_or(Sink::default_shards),
+                  false,
+                  polled.value_or(false)),
+        ident_(std::move(ident)) {
     bool false_v = false;
     if (not syslog_is_opened_.compare_exchange_strong(
             false_v, true, std::memory_order_acq_rel)) {
@@ -97,187 +104,138 @@ namespace soralog {
     }
     openlog(ident_.c_str(), LOG_PID | LOG_NDELAY, LOG_USER);
 
-    if (latency_ != std::chrono::milliseconds::zero()) {
-      sink_worker_ = std::make_unique<std::thread>([this] { run(); });
-    }
+    start();
   }
 
   SinkToSyslog::~SinkToSyslog() {
-    if (latency_ != std::chrono::milliseconds::zero()) {
-      need_to_finalize_.store(true, std::memory_order_release);
-      async_flush();
-      if (sink_worker_ and sink_worker_->joinable()) {
-        sink_worker_->join();
-        sink_worker_.reset();
-      }
-    } else {
-      flush();
-    }
+    stop();
     closelog();
-    syslog_is_opened_.store(true, std::memory_order_release);
+    syslog_is_opened_.store(false, std::memory_order_release);
   }
 
-  void SinkToSyslog::async_flush() noexcept {
-    if (latency_ != std::chrono::milliseconds::zero()) {
-      need_to_flush_.store(true, std::memory_order_release);
-      condvar_.notify_one();
-    } else {
-      flush();
-    }
-  }
-
-  void SinkToSyslog::flush() noexcept {
-    if (flush_in_progress_.test_and_set()) {
-      return;
-    }
-
-    auto *const begin = buff_.data();
-    auto *const end = buff_.data() + buff_.size();  // NOLINT
-    auto *ptr = begin;
+  void SinkToSyslog::write(const Batch &events, std::vector<char> &buffer) {
+    auto *const begin = buffer.data();
+    auto *const end = buffer.data() + buffer.size();  // NOLINT
 
     decltype(1s / 1s) psec = 0;
     std::tm tm{};
     std::array<char, 17> datetime{};  // "00.00.00 00:00:00"
 
-    while (true) {
-      auto node = events_.get();
-      if (node) {
-        const auto &event = *node;
-
-        const auto time = event.timestamp().time_since_epoch();
-        const auto sec = time / 1s;
-        const auto usec = time % 1s / 1us;
-
-        if (psec != sec) {
-          tm = fmt::localtime(sec);
-          fmt::format_to_n(datetime.data(),
-                           datetime.size(),
-                           "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}",
-                           tm.tm_year % 100,
-                           tm.tm_mon + 1,
-                           tm.tm_mday,
-                           tm.tm_hour,
-                           tm.tm_min,
-                           tm.tm_sec);
-          psec = sec;
-        }
-
-        // Timestamp
-
-        std::memcpy(ptr, datetime.data(), datetime.size());
-        ptr = ptr + datetime.size();  // NOLINT
-
-        ptr = fmt::format_to_n(ptr, end - ptr, ".{:0>6}", usec).out;
-
-        put_separator(ptr);
-
-        // Thread
-
-        switch (thread_info_type_) {
-          case ThreadInfoType::NAME:
-            put_string(ptr, event.thread_name());
-            put_separator(ptr);
-            break;
+    for (const auto &node : events) {
+      auto *ptr = begin;
+
+      const auto &event = *node;
+
+      const auto time = event.timestamp().time_since_epoch();
+      const auto sec = time / 1s;
+      const auto usec = time % 1s / 1us;
+
+      if (psec != sec) {
+        tm = fmt::localtime(sec);
+        fmt::format_to_n(datetime.data(),
+                         datetime.size(),
+                         "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}",
+                         tm.tm_year % 100,
+                         tm.tm_mon + 1,
+                         tm.tm_mday,
+                         tm.tm_hour,
+                         tm.tm_min,
+                         tm.tm_sec);
+        psec = sec;
+      }
 
-          case ThreadInfoType::ID:
-            ptr =
-                fmt::format_to_n(ptr, end - ptr, "T:{}", event.thread_number())
-                    .out;
-            put_separator(ptr);
-            break;
+      // Timestamp
 
-          default:
-            break;
-        }
+      std::memcpy(ptr, datetime.data(), datetime.size());
+      ptr = ptr + datetime.size();  // NOLINT
 
-        // Level
+      ptr = fmt::format_to_n(ptr, end - ptr, ".{:0>6}", usec).out;
 
-        put_level(ptr, event.level());
-        put_separator(ptr);
+      put_separator(ptr);
 
-        // Name
+      // Sequence
 
-        put_string(ptr, event.name());
+      if (with_sequence_) {
+        ptr = fmt::format_to_n(
+                  ptr, end - ptr, "#{}.{:<6}", node.lane(), node.sequence())
+                  .out;
         put_separator(ptr);
+      }
 
-        // Message
-
-        put_string(ptr, event.message());
-        *ptr++ = '\0';  // NOLINT
-
-        bool must_log = true;
-        int priority = 8;
-        switch (event.level()) {
-          case Level::OFF:
-            must_log = false;
-            break;
-          case Level::CRITICAL:
-            priority = LOG_EMERG;  // system is unusable
-            break;
-          case Level::ERROR:  // error conditions
-            priority = LOG_ALERT;
-            break;
-          case Level::WARN:  // warning conditions
-            priority = LOG_WARNING;
-            break;
-          case Level::INFO:  // normal but significant condition
-            priority = LOG_NOTICE;
-            break;
-          case Level::VERBOSE:  // informational
-            priority = LOG_INFO;
-            break;
-          case Level::DEBUG:  // debug-level messages
-            priority = LOG_DEBUG;
-            break;
-          case Level::TRACE:  // trace messages must not be logged by syslog
-            [[fallthrough]];
-          default:
-            must_log = false;
-            break;
-        }
+      // Thread
 
-        if (must_log) {
-          // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
-          syslog(priority, "%s", begin);
-        }
+      switch (thread_info_type_) {
+        case ThreadInfoType::NAME:
+          put_string(ptr, event.thread_name());
+          put_separator(ptr);
+          break;
 
-        size_ -= event.message().size();
-      }
+        case ThreadInfoType::ID:
+          ptr =
+              fmt::format_to_n(ptr, end - ptr, "T:{}", event.thread_number())
+                  .out;
+          put_separator(ptr);
+          break;
 
-      if (not node) {
-        need_to_flush_.store(false, std::memory_order_release);
-        break;
+        default:
+          break;
       }
-    }
-
-    flush_in_progress_.clear();
-  }
 
-  void SinkToSyslog::run() {
-    util::setThreadName("log:" + name_);
-
-    next_flush_.store(std::chrono::steady_clock::now(),
-                      std::memory_order_relaxed);
-
-    while (true) {
-      {
-        std::unique_lock lock(mutex_);
-        if (condvar_.wait_until(lock,
-                                next_flush_.load(std::memory_order_relaxed))
-            == std::cv_status::no_timeout) {
-          if (not need_to_flush_.load(std::memory_order_relaxed)
-              and not need_to_finalize_.load(std::memory_order_relaxed)) {
-            continue;
-          }
-        }
+      // Level and name; they are rendered once by logger and level
+
+      const auto prefix =
+          prefixes_.get(event.name(), event.level(), [&](char *&out) {
+            put_level(out, event.level());
+            put_separator(out);
+            put_string(out, event.name());
+            put_separator(out);
+          });
+      std::memcpy(ptr, prefix.data(), prefix.size());
+      ptr += prefix.size();  // NOLINT
+
+      // Message
+
+      auto *const message = ptr;
+      put_string(ptr, messageOf(event));
+      redact(message, ptr);
+      *ptr++ = '\0';  // NOLINT
+
+      bool must_log = true;
+      int priority = 8;
+      switch (event.level()) {
+        case Level::OFF:
+          must_log = false;
+          break;
+        case Level::CRITICAL:
+          priority = LOG_EMERG;  // system is unusable
+          break;
+        case Level::ERROR:  // error conditions
+          priority = LOG_ALERT;
+          break;
+        case Level::WARN:  // warning conditions
+          priority = LOG_WARNING;
+          break;
+        case Level::INFO:  // normal but significant condition
+          priority = LOG_NOTICE;
+          break;
+        case Level::VERBOSE:  // informational
+          priority = LOG_INFO;
+          break;
+        case Level::DEBUG:  // debug-level messages
+          priority = LOG_DEBUG;
+          break;
+        case Level::TRACE:  // trace messages must not be logged by syslog
+          [[fallthrough]];
+        default:
+          must_log = false;
+          break;
       }
 
-      flush();
-
-      if (need_to_finalize_.load(std::memory_order_acquire)
-          && events_.size() == 0) {
-        return;
+      if (must_log) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+        syslog(priority, "%s", begin);
       }
     }
   }
+
 }  // namespace soralog
@@ -0,0 +1,258 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/sink_to_trace.hpp>
+
+#include <unistd.h>
+
+#include <array>
+#include <cctype>
+#include <cstring>
+#include <iostream>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace std::chrono_literals;
+
+    void put_json_string(fmt::memory_buffer &out, std::string_view str) {
+      out.push_back('"');
+      for (auto c : str) {
+        switch (c) {
+          case '"':
+            out.append(std::string_view(R"(\")"));
+            break;
+          case '\\':
+            out.append(std::string_view(R"(\\)"));
+            break;
+          case '\n':
+            out.append(std::string_view(R"(\n)"));
+            break;
+          case '\r':
+            out.append(std::string_view(R"(\r)"));
+            break;
+          case '\t':
+            out.append(std::string_view(R"(\t)"));
+            break;
+          default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+              fmt::format_to(std::back_inserter(out),
+                             "\\u{:04x}",
+                             static_cast<unsigned>(c));
+            } else {
+              out.push_back(c);
+            }
+        }
+      }
+      out.push_back('"');
+    }
+
+  }  // namespace
+
+  SinkToTrace::SinkToTrace(std::string name,
+                           Level level,
+                           std::filesystem::path path,
+                           std::optional<ThreadInfoType> thread_info_type,
+                           std::optional<size_t> capacity,
+                           std::optional<size_t> max_message_length,
+                           std::optional<size_t> buffer_size,
+                           std::optional<size_t> latency,
+                           std::optional<size_t> shards,
+                           std::optional<bool> polled)
+      : BatchSink(std::move(name),
+                  level,
+                  thread_info_type.value_or(ThreadInfoType::NAME),
+                  capacity.value_or(1u << 11),            // 2048 events
+                  max_message_length.value_or(1u << 10),  // 1024 bytes
+                  buffer_size.value_or(1u << 22),         // 4 Mb
+                  latency.value_or(1000),                 // 1 sec
+                  false,
+                  shards.value_or(Sink::default_shards),
+                  false,
+                  polled.value_or(false)),
+        path_(std::move(path)),
+        pid_(::getpid()) {
+    open();
+    start();
+  }
+
+  SinkToTrace::~SinkToTrace() {
+    stop();
+    close();
+  }
+
+  void SinkToTrace::open() {
+    named_threads_.clear();
+    is_first_record_ = true;
+
+    // Existing trace is continued, instead of being rewritten
+    const auto resumed = resume();
+    if (not resumed) {
+      return;
+    }
+
+    out_.open(path_, std::ios::app);
+    if (not out_.is_open()) {
+      std::cerr << "Can't open trace file '" << path_
+                << "': " << strerror(errno) << '\n';
+      return;
+    }
+    if (resumed == Resumed::NEW) {
+      out_ << "[\n";
+    } else {
+      is_first_record_ = resumed == Resumed::EMPTY;
+    }
+  }
+
+  std::optional<SinkToTrace::Resumed> SinkToTrace::resume() {
+    std::error_code ec;
+    const auto size = std::filesystem::file_size(path_, ec);
+    if (ec or size == 0) {
+      return Resumed::NEW;
+    }
+
+    // Only tail of file is read: whitespaces and closing bracket of array
+    std::ifstream in(path_, std::ios::binary);
+    char first = 0;
+    in.get(first);
+    std::array<char, 64> tail{};
+    const auto tail_size = std::min<uintmax_t>(size, tail.size());
+    in.seekg(static_cast<std::streamoff>(size - tail_size));
+    in.read(tail.data(), static_cast<std::streamsize>(tail_size));
+    if (not in or first != '[') {
+      std::cerr << "Can't continue trace file '" << path_
+                << "': it isn't JSON array of trace events\n";
+      return std::nullopt;
+    }
+
+    auto end = static_cast<size_t>(tail_size);
+    auto skip_spaces = [&] {
+      while (end > 0
+             and std::isspace(static_cast<unsigned char>(tail[end - 1]))) {
+        --end;
+      }
+    };
+    skip_spaces();
+    if (end > 0 and tail[end - 1] == ']') {
+      --end;
+      skip_spaces();
+    }
+    if (end == 0 or (tail[end - 1] != '[' and tail[end - 1] != '}')) {
+      std::cerr << "Can't continue trace file '" << path_
+                << "': it is ended by incomplete record\n";
+      return std::nullopt;
+    }
+
+    // Closing bracket is dropped; array is closed again by close()
+    std::filesystem::resize_file(path_, size - tail_size + end, ec);
+    if (ec) {
+      std::cerr << "Can't continue trace file '" << path_
+                << "': " << ec.message() << '\n';
+      return std::nullopt;
+    }
+    return tail[end - 1] == '[' ? Resumed::EMPTY : Resumed::CONTINUED;
+  }
+
+  void SinkToTrace::close() {
+    if (out_.is_open()) {
+      out_ << "\n]\n";
+      out_.close();
+    }
+  }
+
+  void SinkToTrace::write(const Batch &events, std::vector<char> &) {
+    records_.clear();
+    for (const auto &node : events) {
+      render(*node);
+    }
+    out_.write(records_.data(), static_cast<std::streamsize>(records_.size()));
+  }
+
+  void SinkToTrace::render(const Event &event) {
+    auto out = std::back_inserter(records_);
+    const auto tid = event.thread_number();
+
+    auto separate = [&] {
+      if (is_first_record_) {
+        is_first_record_ = false;
+      } else {
+        records_.append(std::string_view(",\n"));
+      }
+    };
+
+    // Name of track by thread name, once per thread
+    if (thread_info_type_ == ThreadInfoType::NAME
+        and not event.thread_name().empty()
+        and named_threads_.emplace(tid).second) {
+      separate();
+      fmt::format_to(out,
+                     R"({{"name":"thread_name","ph":"M","pid":{},"tid":{},)"
+                     R"("args":{{"name":)",
+                     pid_,
+                     tid);
+      put_json_string(records_, event.thread_name());
+      records_.append(std::string_view("}}"));
+    }
+
+    const auto message = messageOf(event);
+    const double timestamp =
+        static_cast<double>(event.timestamp().time_since_epoch() / 1ns) / 1e3;
+
+    separate();
+    records_.append(std::string_view(R"({"name":)"));
+
+    switch (event.span_kind()) {
+      case SpanKind::BEGIN:
+        put_json_string(records_, event.span_name());
+        fmt::format_to(out, R"(,"ph":"B","ts":{:.3f})", timestamp);
+        break;
+
+      case SpanKind::END:
+        put_json_string(records_, event.span_name());
+        fmt::format_to(out, R"(,"ph":"E","ts":{:.3f})", timestamp);
+        break;
+
+      case SpanKind::COMPLETE: {
+        // Event of scope timer is made at the end of scope
+        const double duration =
+            static_cast<double>(event.span_duration() / 1ns) / 1e3;
+        put_json_string(records_, event.span_name());
+        fmt::format_to(out,
+                       R"(,"ph":"X","ts":{:.3f},"dur":{:.3f})",
+                       timestamp - duration,
+                       duration);
+        break;
+      }
+
+      default: {
+        const auto start = records_.size();
+        put_json_string(records_, message);
+        redact(records_.data() + start, records_.data() + records_.size());
+        fmt::format_to(out, R"(,"ph":"i","s":"t","ts":{:.3f})", timestamp);
+      }
+    }
+
+    records_.append(std::string_view(R"(,"cat":)"));
+    put_json_string(records_, event.name());
+    fmt::format_to(out,
+                   R"(,"pid":{},"tid":{},"args":{{"level":"{}"}}}})",
+                   pid_,
+                   tid,
+                   levelToStr(event.level()));
+  }
+
+  void SinkToTrace::sync() noexcept {
+    out_.flush();
+  }
+
+  void SinkToTrace::reopen() noexcept {
+    close();
+    open();
+  }
+
+}  // namespace soralog
@@ -0,0 +1,99 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/impl/thread_pool_executor.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+#include <soralog/util.hpp>
+
+namespace soralog {
+
+  ThreadPoolExecutor::ThreadPoolExecutor(const std::string &name,
+                                         size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+      threads_.emplace_back(
+          [this, thread_name = name + ":" + std::to_string(i + 1)] {
+            run(thread_name);
+          });
+    }
+  }
+
+  ThreadPoolExecutor::~ThreadPoolExecutor() {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    condvar_.notify_all();
+    for (auto &thread : threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+  void ThreadPoolExecutor::post(Task task) {
+    {
+      std::lock_guard lock(mutex_);
+      ready_.emplace_back(std::move(task));
+    }
+    condvar_.notify_one();
+  }
+
+  void ThreadPoolExecutor::postAfter(Duration delay, Task task) {
+    {
+      std::lock_guard lock(mutex_);
+      delayed_.push_back(
+          {std::chrono::steady_clock::now() + delay, std::move(task)});
+      std::push_heap(delayed_.begin(), delayed_.end());
+    }
+    // Deadline of sleeping thread might be later
+    condvar_.notify_one();
+  }
+
+  void ThreadPoolExecutor::run(const std::string &name) {
+    util::setThreadName(name);
+
+    while (true) {
+      Task task;
+      {
+        std::unique_lock lock(mutex_);
+        while (true) {
+          const auto now = std::chrono::steady_clock::now();
+          while (not delayed_.empty() and delayed_.front().deadline <= now) {
+            std::pop_heap(delayed_.begin(), delayed_.end());
+            ready_.emplace_back(std::move(delayed_.back().task));
+            delayed_.pop_back();
+          }
+          if (not ready_.empty()) {
+            task = std::move(ready_.front());
+            ready_.pop_front();
+            break;
+          }
+          if (stop_) {
+            return;
+          }
+          condvar_.wait_until(
+              lock,
+              delayed_.empty() ? std::chrono::steady_clock::time_point::max()
+                               : delayed_.front().deadline);
+        }
+      }
+
+      try {
+        task();
+      } catch (const std::exception &exception) {
+        std::cerr << "Task of executor '" << name
+                  << "' is failed: " << exception.what() << '\n';
+      }
+    }
+  }
+
+}  // namespace soralog
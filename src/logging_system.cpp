@@ -9,6 +9,7 @@
 
 #include <cassert>
 #include <functional>
+#include <iterator>
 #include <iostream>
 #include <set>
 
@@ -19,8 +20,10 @@
 using std::literals::string_literals::operator""s;
 
 namespace soralog {
-  LoggingSystem::LoggingSystem(std::shared_ptr<Configurator> configurator)
-      : configurator_(std::move(configurator)) {
+  LoggingSystem::LoggingSystem(std::shared_ptr<Configurator> configurator,
+                               std::shared_ptr<Executor> executor)
+      : configurator_(std::move(configurator)),
+        executor_(std::move(executor)) {
     makeSink<SinkToNowhere>("*");
   }
 
@@ -163,6 +166,23 @@ namespace soralog {
     return it->second;
   }
 
+  size_t LoggingSystem::poll(size_t budget) {
+    std::lock_guard guard(mutex_);
+    if (sinks_.empty()) {
+      return 0;
+    }
+    auto it = sinks_.begin();
+    std::advance(it, poll_cursor_++ % sinks_.size());
+    size_t written = 0;
+    for (size_t i = 0; i < sinks_.size() and written < budget; ++i) {
+      written += it->second->poll(budget - written);
+      if (++it == sinks_.end()) {
+        it = sinks_.begin();
+      }
+    }
+    return written;
+  }
+
   [[nodiscard]] std::shared_ptr<Group> LoggingSystem::getGroup(
       const std::string &group_name) {
     std::lock_guard guard(mutex_);
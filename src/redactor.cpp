@@ -0,0 +1,176 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/redactor.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <queue>
+#include <stdexcept>
+
+namespace soralog {
+
+  namespace {
+
+    // Bytes which separate words for masking of word or value
+    constexpr auto delimiters = [] {
+      std::array<bool, 256> table{};
+      for (int c = 0; c < 0x20; ++c) {
+        table[c] = true;  // Control characters including escape sequences
+      }
+      for (unsigned char c : std::string_view(" \"'`,;&|<>()[]{}\\")) {
+        table[c] = true;
+      }
+      table[0x7f] = true;
+      return table;
+    }();
+
+  }  // namespace
+
+  Redactor::Redactor(std::vector<Pattern> patterns)
+      : patterns_(std::move(patterns)) {
+    constexpr State absent = UINT32_MAX;
+
+    // Trie of patterns
+    transitions_.assign(256, absent);
+    outputs_.assign(1, no_pattern);
+    for (uint32_t index = 0; index < patterns_.size(); ++index) {
+      const auto &text = patterns_[index].text;
+      if (text.empty()) {
+        throw std::invalid_argument("Pattern of redaction is empty");
+      }
+      State state = 0;
+      for (auto c : text) {
+        auto &to = transitions_[state * 256 + static_cast<uint8_t>(c)];
+        if (to == absent) {
+          to = outputs_.size();
+          transitions_.resize(transitions_.size() + 256, absent);
+          outputs_.push_back(no_pattern);
+        }
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-constant-array-index)
+        state = transitions_[state * 256 + static_cast<uint8_t>(c)];
+      }
+      outputs_[state] = index;
+    }
+
+    // Links of failure are folded into transitions breadth-first, so each
+    // state gets full row of transitions
+    std::vector<State> failures(outputs_.size(), 0);
+    std::queue<State> queue;
+    for (size_t c = 0; c < 256; ++c) {
+      auto &to = transitions_[c];
+      if (to == absent) {
+        to = 0;
+      } else {
+        queue.push(to);
+      }
+    }
+    while (not queue.empty()) {
+      const auto state = queue.front();
+      queue.pop();
+      const auto failure = failures[state];
+
+      // Keep the longest pattern ending here
+      if (outputs_[state] == no_pattern) {
+        outputs_[state] = outputs_[failure];
+      }
+
+      for (size_t c = 0; c < 256; ++c) {
+        auto &to = transitions_[state * 256 + c];
+        if (to == absent) {
+          to = transitions_[failure * 256 + c];
+        } else {
+          failures[to] = transitions_[failure * 256 + c];
+          queue.push(to);
+        }
+      }
+    }
+
+    // Mark states with output right in transitions to check them for free
+    for (auto &to : transitions_) {
+      if (outputs_[to] != no_pattern) {
+        to |= has_output;
+      }
+    }
+    size_t starts = 0;
+    for (size_t c = 0; c < 256; ++c) {
+      starts_[c] = transitions_[c] != 0;
+      if (starts_[c]) {
+        single_start_ = static_cast<char>(c);
+        ++starts;
+      }
+    }
+    is_single_start_ = starts == 1;
+  }
+
+  bool Redactor::isDelimiter(char c) noexcept {
+    return delimiters[static_cast<uint8_t>(c)];
+  }
+
+  char *Redactor::skip(char *ptr, char *end) const noexcept {
+    // The only first byte (e.g. "@") is searched by vectorized libc
+    if (is_single_start_) {
+      auto *found = std::memchr(ptr, single_start_, end - ptr);
+      return found != nullptr ? static_cast<char *>(found) : end;
+    }
+    while (ptr < end and not starts_[static_cast<uint8_t>(*ptr)]) {
+      ++ptr;  // NOLINT
+    }
+    return ptr;
+  }
+
+  size_t Redactor::redact(char *begin, char *end) const noexcept {
+    size_t found = 0;
+    State state = 0;
+    for (auto *ptr = begin; ptr < end; ++ptr) {  // NOLINT
+      // Clean text is skipped without walking through automaton
+      if (state == 0) {
+        ptr = skip(ptr, end);
+        if (ptr == end) {
+          break;
+        }
+      }
+
+      state = next(state, *ptr);
+      if ((state & has_output) == 0) {
+        continue;
+      }
+      const auto index = outputs_[state & ~has_output];
+      ++found;
+
+      const auto &pattern = patterns_[index];
+      auto *last = ptr + 1;                        // NOLINT
+      auto *first = last - pattern.text.size();    // NOLINT
+      switch (pattern.mask) {
+        case Mask::MATCH:
+          break;
+        case Mask::WORD:
+          while (first > begin and not isDelimiter(first[-1])) {  // NOLINT
+            --first;                                              // NOLINT
+          }
+          while (last < end and not isDelimiter(*last)) {
+            ++last;  // NOLINT
+          }
+          break;
+        case Mask::VALUE:
+          first = last;
+          while (last < end and not isDelimiter(*last)) {
+            ++last;  // NOLINT
+          }
+          break;
+      }
+      std::fill(first, last, mask_char);
+
+      // Continue after masked part
+      ptr = last - 1;  // NOLINT
+      state = 0;
+    }
+    return found;
+  }
+
+}  // namespace soralog
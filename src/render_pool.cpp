@@ -0,0 +1,170 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/render_pool.hpp>
+
+#include <algorithm>
+
+#include <soralog/util.hpp>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace std::chrono_literals;
+
+    // Waits for tasks are bounded to be safe against lost notification
+    constexpr auto wait_timeout = 100ms;
+
+  }  // namespace
+
+  RenderPool::RenderPool(const std::string &name, size_t threads)
+      : helpers_(threads), executor_(Executor::current()) {
+    if (executor_) {
+      return;
+    }
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+      threads_.emplace_back(
+          [this, thread_name = name + ":" + std::to_string(i + 1)] {
+            run(thread_name);
+          });
+    }
+  }
+
+  RenderPool::~RenderPool() {
+    {
+      std::lock_guard lock(mutex_);
+      stop_ = true;
+    }
+    job_condvar_.notify_all();
+    for (auto &thread : threads_) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+  }
+
+  void RenderPool::process(size_t count, const Task &task, const Task &consume) {
+    {
+      std::lock_guard lock(mutex_);
+      if (done_capacity_ < count) {
+        // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays,hicpp-avoid-c-arrays,modernize-avoid-c-arrays)
+        done_ = std::make_unique<std::atomic_bool[]>(count);
+        done_capacity_ = count;
+      }
+      for (size_t i = 0; i < count; ++i) {
+        done_[i].store(false, std::memory_order_relaxed);
+      }
+      task_ = &task;
+      count_ = count;
+      next_.store(0, std::memory_order_relaxed);
+      ++generation_;
+    }
+    if (not threads_.empty()) {
+      job_condvar_.notify_all();
+    }
+    if (executor_) {
+      try {
+        for (size_t i = 1; i < std::min(count, helpers_ + 1); ++i) {
+          posted_.emplace_back(executor_->schedule(
+              Executor::Duration::zero(), [this] { help(); }));
+        }
+      } catch (const std::exception &) {
+        // Calling thread does the rest by itself
+      }
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+      while (not done_[i].load(std::memory_order_acquire)) {
+        // Help to do tasks, or wait for ones which are in progress
+        if (not execute()) {
+          std::unique_lock lock(mutex_);
+          done_condvar_.wait_for(lock, wait_timeout, [&] {
+            return done_[i].load(std::memory_order_acquire);
+          });
+        }
+      }
+      consume(i);
+    }
+
+    // Helping tasks which are not started yet are not needed anymore
+    size_t started = 0;
+    for (const auto &helper : posted_) {
+      if (not helper->cancel()) {
+        ++started;
+      }
+    }
+    posted_.clear();
+
+    // Task must not be touched by workers after return
+    std::unique_lock lock(mutex_);
+    while (active_ != 0 or helped_ < started) {
+      done_condvar_.wait_for(lock, wait_timeout);
+    }
+    helped_ = 0;
+    task_ = nullptr;
+    count_ = 0;
+  }
+
+  bool RenderPool::execute() {
+    auto index = next_.fetch_add(1, std::memory_order_relaxed);
+    if (index >= count_) {
+      return false;
+    }
+    (*task_)(index);
+    {
+      std::lock_guard lock(mutex_);
+      done_[index].store(true, std::memory_order_release);
+    }
+    done_condvar_.notify_all();
+    return true;
+  }
+
+  void RenderPool::help() {
+    while (execute()) {
+    }
+
+    {
+      std::lock_guard lock(mutex_);
+      ++helped_;
+    }
+    done_condvar_.notify_all();
+  }
+
+  void RenderPool::run(const std::string &name) {
+    util::setThreadName(name);
+
+    size_t generation = 0;
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        // Job and stop are published under the mutex, so idle worker may
+        // sleep without deadline
+        while (not stop_ and generation_ == generation) {
+          job_condvar_.wait_until(
+              lock, std::chrono::steady_clock::time_point::max());
+        }
+        if (stop_) {
+          return;
+        }
+        generation = generation_;
+        ++active_;
+      }
+
+      while (execute()) {
+      }
+
+      {
+        std::lock_guard lock(mutex_);
+        --active_;
+      }
+      done_condvar_.notify_all();
+    }
+  }
+
+}  // namespace soralog
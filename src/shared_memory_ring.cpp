@@ -0,0 +1,547 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/shared_memory_ring.hpp>
+
+#include <array>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace soralog {
+
+  namespace {
+
+    using namespace std::chrono_literals;
+
+    // "SORALOG" + version of layout
+    constexpr uint64_t magic_number = 0x534f52414c4f4704;
+
+    // Sequence of slot captured by producer has this bit; the rest is
+    // position which slot is captured for
+    constexpr uint64_t captured_bit = uint64_t(1) << 63;
+
+    // How many times producer retries free slot tagged by other one before it
+    // checks if that producer is alive
+    constexpr size_t max_spins_before_check = 1u << 10;
+
+    // Slots are aligned to cache line to avoid false sharing
+    constexpr size_t slot_alignment = 64;
+
+    // How long attaching side waits for initialization by creator
+    constexpr auto init_timeout = 1s;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                  "Lock-free 64-bit atomic is required for shared memory");
+
+    size_t roundUpToPowerOfTwo(size_t value) {
+      size_t result = 2;
+      while (result < value) {
+        result <<= 1;
+      }
+      return result;
+    }
+
+    std::string normalizeName(std::string name) {
+      if (name.empty() or name.front() != '/') {
+        name.insert(name.begin(), '/');
+      }
+      return name;
+    }
+
+    [[noreturn]] void throwSystemError(const std::string &what) {
+      throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    /**
+     * @returns start time of process {@param pid} in clock ticks since boot,
+     * or 0 if it is unknown (e.g. there is no procfs)
+     */
+    uint64_t processStartTime(pid_t pid) noexcept {
+      const auto path = "/proc/" + std::to_string(pid) + "/stat";
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+      auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd == -1) {
+        return 0;
+      }
+      std::array<char, 1024> buffer{};
+      auto size = ::read(fd, buffer.data(), buffer.size() - 1);
+      ::close(fd);
+      if (size <= 0) {
+        return 0;
+      }
+      // Name of process might contain spaces and parentheses, so fields are
+      // counted since the last ')'; start time is 22nd field, 20th after it
+      std::string_view stat(buffer.data(), size);
+      auto pos = stat.rfind(')');
+      for (int field = 2; field < 22 and pos != std::string_view::npos;
+           ++field) {
+        pos = stat.find(' ', pos + 1);
+      }
+      if (pos == std::string_view::npos) {
+        return 0;
+      }
+      return std::strtoull(stat.data() + pos + 1, nullptr, 10);
+    }
+
+    /**
+     * @returns token of process {@param pid}: pid and low bits of its start
+     * time, so pid reused by other process gives other token
+     */
+    uint64_t processToken(pid_t pid) noexcept {
+      return (processStartTime(pid) << 32) | static_cast<uint32_t>(pid);
+    }
+
+    uint32_t pidOfToken(uint64_t token) noexcept {
+      return static_cast<uint32_t>(token);
+    }
+
+    /**
+     * @returns true if process with {@param token} does not exist anymore
+     */
+    bool isGone(uint64_t token) noexcept {
+      const auto pid = static_cast<pid_t>(pidOfToken(token));
+      if (pid == 0) {
+        return false;
+      }
+      if (::kill(pid, 0) == -1 and errno == ESRCH) {
+        return true;
+      }
+      // Pid might be reused by other process already
+      const auto start_time = token >> 32;
+      return start_time != 0 and processToken(pid) != token;
+    }
+
+  }  // namespace
+
+  struct SharedMemoryRing::Header final {
+    std::atomic<uint64_t> magic;
+    uint64_t capacity;
+    uint64_t slot_size;
+    uint64_t max_message_length;
+    alignas(slot_alignment) std::atomic<uint64_t> enqueue_pos;
+    alignas(slot_alignment) std::atomic<uint64_t> dequeue_pos;
+    alignas(slot_alignment) std::atomic<uint64_t> dropped;
+    std::atomic<uint64_t> abandoned;
+  };
+
+  struct SharedMemoryRing::Slot final {
+    std::atomic<uint64_t> sequence;
+    /// Token of producer (see processToken()) which tagged slot to capture it;
+    /// captured slot always has owner
+    std::atomic<uint64_t> owner;
+    Record record;
+  };
+
+  SharedMemoryRing::RecordRef::~RecordRef() noexcept {
+    if (slot_) {
+      slot_->owner.store(0, std::memory_order_relaxed);
+      slot_->sequence.store(release_sequence_, std::memory_order_release);
+    }
+  }
+
+  const SharedMemoryRing::Record &SharedMemoryRing::RecordRef::operator*()
+      const noexcept(IF_RELEASE) {
+    assert(slot_);
+    return slot_->record;
+  }
+
+  std::string_view SharedMemoryRing::RecordRef::message() const
+      noexcept(IF_RELEASE) {
+    assert(slot_);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    const auto *data = reinterpret_cast<const char *>(slot_) + sizeof(Slot);
+    return {data,  // NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            std::min<size_t>(slot_->record.message_size, max_message_length_)};
+  }
+
+  SharedMemoryRing::SharedMemoryRing(std::string name,
+                                     size_t capacity,
+                                     size_t max_message_length)
+      : name_(normalizeName(std::move(name))),
+        pid_(::getpid()),
+        token_(processToken(::getpid())) {
+    capacity = roundUpToPowerOfTwo(capacity);
+    auto slot_size = sizeof(Slot) + max_message_length;
+    if (auto offset = slot_size % slot_alignment) {
+      slot_size += slot_alignment - offset;
+    }
+    const auto size = sizeof(Header) + capacity * slot_size;
+
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    auto fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+      if (errno != EEXIST) {
+        throwSystemError("Can't create shared memory segment '" + name_ + "'");
+      }
+      // Segment already exists - attach to it and check geometry
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+      fd = ::shm_open(name_.c_str(), O_RDWR, 0600);
+      if (fd == -1) {
+        throwSystemError("Can't open shared memory segment '" + name_ + "'");
+      }
+      map(fd, 0);
+      if (mask_ + 1 != capacity or slot_size_ != slot_size) {
+        ::munmap(header_, mapped_size_);
+        header_ = nullptr;
+        throw std::runtime_error("Shared memory segment '" + name_
+                                 + "' already exists with other geometry");
+      }
+      return;
+    }
+
+    if (::ftruncate(fd, static_cast<off_t>(size)) == -1) {
+      auto error = errno;
+      ::close(fd);
+      ::shm_unlink(name_.c_str());
+      errno = error;
+      throwSystemError("Can't resize shared memory segment '" + name_ + "'");
+    }
+
+    map(fd, size);
+
+    new (header_) Header{};
+    header_->capacity = capacity;
+    header_->slot_size = slot_size;
+    header_->max_message_length = max_message_length;
+    mask_ = capacity - 1;
+    slot_size_ = slot_size;
+    max_message_length_ = max_message_length;
+
+    for (uint64_t index = 0; index < capacity; ++index) {
+      auto &slot = *new (&this->slot(index)) Slot{};
+      slot.sequence.store(index, std::memory_order_relaxed);
+    }
+
+    // Segment becomes usable for others since this moment
+    header_->magic.store(magic_number, std::memory_order_release);
+  }
+
+  SharedMemoryRing::SharedMemoryRing(std::string name)
+      : name_(normalizeName(std::move(name))),
+        pid_(::getpid()),
+        token_(processToken(::getpid())) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-vararg,hicpp-vararg)
+    auto fd = ::shm_open(name_.c_str(), O_RDWR, 0600);
+    if (fd == -1) {
+      throwSystemError("Can't open shared memory segment '" + name_ + "'");
+    }
+    map(fd, 0);
+  }
+
+  SharedMemoryRing::~SharedMemoryRing() {
+    if (header_ != nullptr) {
+      ::munmap(header_, mapped_size_);
+    }
+  }
+
+  void SharedMemoryRing::map(int fd, size_t size) {
+    const auto deadline = std::chrono::steady_clock::now() + init_timeout;
+    const bool attaching = size == 0;
+
+    // Size is unknown for attaching side: wait until creator resizes segment
+    while (size == 0) {
+      struct stat st {};
+      if (::fstat(fd, &st) == -1) {
+        auto error = errno;
+        ::close(fd);
+        errno = error;
+        throwSystemError("Can't stat shared memory segment '" + name_ + "'");
+      }
+      if (static_cast<size_t>(st.st_size) >= sizeof(Header)) {
+        size = st.st_size;
+        break;
+      }
+      if (std::chrono::steady_clock::now() > deadline) {
+        ::close(fd);
+        throw std::runtime_error("Shared memory segment '" + name_
+                                 + "' is not initialized");
+      }
+      std::this_thread::sleep_for(1ms);
+    }
+
+    auto *addr =
+        ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto error = errno;
+    ::close(fd);
+    if (addr == MAP_FAILED) {  // NOLINT(cppcoreguidelines-pro-type-cstyle-cast)
+      errno = error;
+      throwSystemError("Can't map shared memory segment '" + name_ + "'");
+    }
+    header_ = static_cast<Header *>(addr);
+    mapped_size_ = size;
+
+    if (not attaching) {
+      return;  // Segment is being created by this object
+    }
+
+    while (header_->magic.load(std::memory_order_acquire) != magic_number) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        ::munmap(header_, mapped_size_);
+        header_ = nullptr;
+        throw std::runtime_error("Shared memory segment '" + name_
+                                 + "' is not a soralog ring");
+      }
+      std::this_thread::sleep_for(1ms);
+    }
+
+    if (header_->capacity < 2 or (header_->capacity & (header_->capacity - 1))
+        or sizeof(Header) + header_->capacity * header_->slot_size
+               > mapped_size_
+        or sizeof(Slot) + header_->max_message_length > header_->slot_size) {
+      ::munmap(header_, mapped_size_);
+      header_ = nullptr;
+      throw std::runtime_error("Shared memory segment '" + name_
+                               + "' has broken header");
+    }
+
+    mask_ = header_->capacity - 1;
+    slot_size_ = header_->slot_size;
+    max_message_length_ = header_->max_message_length;
+  }
+
+  SharedMemoryRing::Slot &SharedMemoryRing::slot(
+      uint64_t position) const noexcept {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto *slots = reinterpret_cast<std::byte *>(header_) + sizeof(Header);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    return *reinterpret_cast<Slot *>(slots + (position & mask_) * slot_size_);
+  }
+
+  size_t SharedMemoryRing::capacity() const noexcept {
+    return mask_ + 1;
+  }
+
+  size_t SharedMemoryRing::maxMessageLength() const noexcept {
+    return max_message_length_;
+  }
+
+  size_t SharedMemoryRing::size() const noexcept {
+    auto head = header_->enqueue_pos.load(std::memory_order_relaxed);
+    auto tail = header_->dequeue_pos.load(std::memory_order_relaxed);
+    return head > tail ? head - tail : 0;
+  }
+
+  uint64_t SharedMemoryRing::dropped() const noexcept {
+    return header_->dropped.load(std::memory_order_relaxed);
+  }
+
+  uint64_t SharedMemoryRing::abandoned() const noexcept {
+    return header_->abandoned.load(std::memory_order_relaxed);
+  }
+
+  SharedMemoryRing::Claim SharedMemoryRing::claim() noexcept {
+    auto position = header_->enqueue_pos.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+    uint64_t stuck_owner = 0;
+    size_t spins = 0;
+    while (true) {
+      slot = &this->slot(position);
+      auto slot_sequence = slot->sequence.load(std::memory_order_acquire);
+
+      if (slot_sequence & captured_bit) {
+        if (slot_sequence == (captured_bit | position)) {
+          // Captured by other producer, which hasn't advanced position yet
+          header_->enqueue_pos.compare_exchange_strong(
+              position, position + 1, std::memory_order_relaxed);
+          position = header_->enqueue_pos.load(std::memory_order_relaxed);
+          continue;
+        }
+        // Slot of previous lap is not published yet - ring is full
+        header_->dropped.fetch_add(1, std::memory_order_relaxed);
+        return {};
+      }
+
+      auto diff =
+          static_cast<int64_t>(slot_sequence) - static_cast<int64_t>(position);
+      if (diff < 0) {
+        // Tail is caught up - ring is full
+        header_->dropped.fetch_add(1, std::memory_order_relaxed);
+        return {};
+      }
+      if (diff > 0) {
+        // Slot is captured by other producer - try next one
+        position = header_->enqueue_pos.load(std::memory_order_relaxed);
+        continue;
+      }
+
+      // Slot is free. It's tagged by own token before capturing, so slot
+      // captured by producer, which has died at any moment, has owner
+      uint64_t owner = 0;
+      if (slot->owner.compare_exchange_strong(owner,
+                                              token_,
+                                              std::memory_order_acquire,
+                                              std::memory_order_relaxed)) {
+        auto expected = position;
+        if (slot->sequence.compare_exchange_strong(expected,
+                                                   captured_bit | position,
+                                                   std::memory_order_acq_rel,
+                                                   std::memory_order_relaxed)) {
+          // Position might be advanced by other producer already
+          header_->enqueue_pos.compare_exchange_strong(
+              position, position + 1, std::memory_order_relaxed);
+          break;
+        }
+        // Slot was already passed to next lap, while it was being tagged
+        slot->owner.store(0, std::memory_order_release);
+      } else if (owner != stuck_owner) {
+        stuck_owner = owner;
+        spins = 0;
+      } else if (++spins == max_spins_before_check) {
+        spins = 0;
+        // Other producer has died between tagging and capturing of slot
+        if (isGone(owner)) {
+          slot->owner.compare_exchange_strong(
+              owner, 0, std::memory_order_relaxed);
+        }
+      }
+      position = header_->enqueue_pos.load(std::memory_order_relaxed);
+    }
+
+    slot->record.pid = pid_;
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast,cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    auto *message = reinterpret_cast<char *>(slot) + sizeof(Slot);
+    return {&slot->record, message, position};
+  }
+
+  bool SharedMemoryRing::publish(const Claim &claim) noexcept {
+    assert(claim);
+    auto &slot = this->slot(claim.position);
+    // Consumer skips only slots of disappeared processes, so this is just a
+    // safeguard: record is dropped if slot is not ours anymore
+    auto expected = captured_bit | claim.position;
+    if (not slot.sequence.compare_exchange_strong(
+            expected, claim.position + 1, std::memory_order_release)) {
+      header_->dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  bool SharedMemoryRing::put(const Event &event, uint64_t sequence) noexcept {
+    auto claim = this->claim();
+    if (not claim) {
+      return false;
+    }
+
+    auto &record = *claim.record;
+    record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                           event.timestamp().time_since_epoch())
+                           .count();
+    record.thread_number = event.thread_number();
+    record.sequence = sequence;
+    record.level = event.level();
+
+    auto thread_name = event.thread_name();
+    record.thread_name_size =
+        std::min(thread_name.size(), record.thread_name.size());
+    std::copy_n(thread_name.begin(),
+                record.thread_name_size,
+                record.thread_name.begin());
+
+    auto name = event.name();
+    record.name_size = std::min(name.size(), record.name.size());
+    std::copy_n(name.begin(), record.name_size, record.name.begin());
+
+    auto message = event.message();
+    record.message_size = std::min(message.size(), max_message_length_);
+    std::copy_n(message.begin(), record.message_size, claim.message);
+
+    return publish(claim);
+  }
+
+  SharedMemoryRing::RecordRef SharedMemoryRing::get() noexcept {
+    auto position = header_->dequeue_pos.load(std::memory_order_relaxed);
+    while (true) {
+      auto &slot = this->slot(position);
+      auto sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence & captured_bit) {
+        // Record is captured by producer, but not published yet
+        return {};
+      }
+      auto diff =
+          static_cast<int64_t>(sequence) - static_cast<int64_t>(position + 1);
+      if (diff == 0) {
+        // Record is published - capture it
+        if (header_->dequeue_pos.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          return {slot, position + mask_ + 1, max_message_length_};
+        }
+      } else if (diff < 0) {
+        // Head is caught up - ring is empty
+        return {};
+      } else {
+        // Record is captured by other consumer - try next one
+        position = header_->dequeue_pos.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool SharedMemoryRing::skipAbandoned() noexcept {
+    auto position = header_->dequeue_pos.load(std::memory_order_relaxed);
+    if (header_->enqueue_pos.load(std::memory_order_relaxed) <= position) {
+      stalled_since_ = {};
+      return false;  // Ring is empty
+    }
+
+    auto &slot = this->slot(position);
+    if (slot.sequence.load(std::memory_order_acquire)
+        != (captured_bit | position)) {
+      stalled_since_ = {};
+      return false;  // Record is published, or slot is taken by consumer
+    }
+
+    // Slot is captured, but not published yet
+    if (stalled_position_ != position
+        or stalled_since_ == std::chrono::steady_clock::time_point{}) {
+      stalled_position_ = position;
+      stalled_since_ = std::chrono::steady_clock::now();
+    }
+
+    // Slot is tagged before capturing, so captured one always has owner
+    auto owner = slot.owner.load(std::memory_order_relaxed);
+    stalled_owner_ = pidOfToken(owner);
+    if (not isGone(owner)) {
+      // Live producer might write into slot any moment, so it can't be reused
+      return false;
+    }
+
+    // Take slot like a consumer, and release it at once for next lap
+    if (not header_->dequeue_pos.compare_exchange_strong(
+            position, position + 1, std::memory_order_relaxed)) {
+      return false;
+    }
+    slot.owner.store(0, std::memory_order_relaxed);
+    slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+    header_->abandoned.fetch_add(1, std::memory_order_relaxed);
+    stalled_since_ = {};
+    return true;
+  }
+
+  std::optional<uint32_t> SharedMemoryRing::stalledBy(
+      std::chrono::milliseconds timeout) const noexcept {
+    if (stalled_since_ == std::chrono::steady_clock::time_point{}
+        or std::chrono::steady_clock::now() - stalled_since_ < timeout) {
+      return std::nullopt;
+    }
+    return stalled_owner_;
+  }
+
+  bool SharedMemoryRing::unlink(const std::string &name) noexcept {
+    return ::shm_unlink(normalizeName(name).c_str()) == 0;
+  }
+
+}  // namespace soralog
@@ -0,0 +1,156 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <soralog/sink_scheduler.hpp>
+
+#include <cassert>
+#include <iostream>
+
+#include <soralog/util.hpp>
+
+namespace soralog {
+
+  namespace {
+
+    // Scheduler which pass is running by current thread
+    thread_local const SinkScheduler *running_scheduler = nullptr;
+
+  }  // namespace
+
+  SinkScheduler::~SinkScheduler() {
+    assert(not worker_);
+  }
+
+  void SinkScheduler::start(std::string thread_name,
+                            Pass pass,
+                            Deadline deadline) {
+    thread_name_ = std::move(thread_name);
+    pass_ = std::move(pass);
+    deadline_ = std::move(deadline);
+
+    executor_ = Executor::current();
+    if (executor_) {
+      std::lock_guard lock(mutex_);
+      schedule(deadline_());
+      return;
+    }
+    worker_ = std::make_unique<std::thread>([this] { run(); });
+  }
+
+  void SinkScheduler::request() noexcept {
+    std::lock_guard lock(mutex_);
+    requested_ = true;
+    if (executor_) {
+      schedule(Clock::now());
+      return;
+    }
+    condvar_.notify_one();
+  }
+
+  void SinkScheduler::wake() noexcept {
+    std::lock_guard lock(mutex_);
+    if (executor_) {
+      if (not scheduled_) {
+        schedule(deadline_());
+      }
+      return;
+    }
+    condvar_.notify_one();
+  }
+
+  void SinkScheduler::stop() noexcept {
+    std::unique_lock lock(mutex_);
+    stopping_ = true;
+    if (worker_) {
+      lock.unlock();
+      condvar_.notify_one();
+      if (worker_->joinable()) {
+        worker_->join();
+      }
+      worker_.reset();
+    } else if (executor_) {
+      if (scheduled_ and scheduled_->cancel()) {
+        scheduled_.reset();
+      }
+      // Task in progress must not outlive sink
+      while (scheduled_) {
+        condvar_.wait_until(lock, never);
+      }
+      executor_.reset();
+    }
+  }
+
+  bool SinkScheduler::isRunning() const noexcept {
+    return running_scheduler == this;
+  }
+
+  void SinkScheduler::schedule(Clock::time_point deadline) noexcept {
+    if (stopping_ or deadline == never) {
+      return;
+    }
+    const auto delay =
+        std::max(deadline - Clock::now(), Executor::Duration::zero());
+    try {
+      if (scheduled_) {
+        if (delay == Executor::Duration::zero()) {
+          scheduled_->wake();
+        }
+        return;
+      }
+      scheduled_ = executor_->schedule(delay, [this] { runScheduled(); });
+    } catch (const std::exception &exception) {
+      std::cerr << "Can't schedule task of '" << thread_name_
+                << "': " << exception.what() << '\n';
+    }
+  }
+
+  void SinkScheduler::runScheduled() noexcept {
+    {
+      std::lock_guard lock(mutex_);
+      requested_ = false;
+    }
+
+    runPass();
+
+    std::lock_guard lock(mutex_);
+    scheduled_.reset();
+    if (not stopping_) {
+      schedule(requested_ ? Clock::now() : deadline_());
+    }
+    condvar_.notify_all();
+  }
+
+  void SinkScheduler::runPass() noexcept {
+    running_scheduler = this;
+    pass_();
+    running_scheduler = nullptr;
+  }
+
+  void SinkScheduler::run() {
+    util::setThreadName(thread_name_);
+
+    while (true) {
+      {
+        std::unique_lock lock(mutex_);
+        if (not requested_ and not stopping_) {
+          if (condvar_.wait_until(lock, deadline_())
+              == std::cv_status::no_timeout) {
+            // Woken up; deadline might be changed
+            continue;
+          }
+        }
+        if (stopping_) {
+          return;
+        }
+        requested_ = false;
+      }
+
+      runPass();
+    }
+  }
+
+}  // namespace soralog
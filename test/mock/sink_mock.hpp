@@ -51,6 +51,11 @@ namespace soralog {
       mocked_rotate();
     }
     MOCK_METHOD0(mocked_rotate, void());
+
+    size_t poll(size_t budget) noexcept override {
+      return mocked_poll(budget);
+    }
+    MOCK_METHOD1(mocked_poll, size_t(size_t));
   };
 
 }  // namespace soralog
@@ -0,0 +1,118 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include "soralog/impl/asio_executor.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace {
+
+  /**
+   * Waits for {@param condition} for a second at most
+   * @returns value of condition
+   */
+  template <typename Condition>
+  bool waitFor(const Condition &condition) {
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (not condition() and std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+    return condition();
+  }
+
+}  // namespace
+
+class AsioExecutorTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    thread_ = std::thread([this] { io_context_.run(); });
+  }
+  void TearDown() override {
+    // Timers of cancelled tasks are still pending
+    io_context_.stop();
+    thread_.join();
+  }
+
+ protected:
+  boost::asio::io_context io_context_;
+  boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+      work_guard_ = boost::asio::make_work_guard(io_context_);
+  std::thread thread_;
+};
+
+/**
+ * @given Executor of Asio io_context
+ * @when Post tasks at once and with delays
+ * @then Immediate tasks run at once, delayed ones in order of deadlines not
+ * before their delays
+ */
+TEST_F(AsioExecutorTest, PostAndPostAfter) {
+  AsioExecutor executor(io_context_.get_executor());
+  std::atomic_int immediate = 0;
+  std::mutex mutex;
+  std::vector<int> order;
+
+  auto start = std::chrono::steady_clock::now();
+  std::atomic<std::chrono::steady_clock::duration> elapsed{};
+  executor.postAfter(60ms, [&] {
+    std::lock_guard lock(mutex);
+    order.push_back(2);
+    elapsed = std::chrono::steady_clock::now() - start;
+  });
+  executor.postAfter(20ms, [&] {
+    std::lock_guard lock(mutex);
+    order.push_back(1);
+  });
+  for (int i = 0; i < 10; ++i) {
+    executor.post([&] { ++immediate; });
+  }
+
+  EXPECT_TRUE(waitFor([&] { return immediate == 10; }));
+  ASSERT_TRUE(waitFor([&] {
+    std::lock_guard lock(mutex);
+    return order.size() == 2;
+  }));
+  EXPECT_EQ(order, (std::vector<int>{1, 2}));
+  EXPECT_GE(elapsed.load(), 60ms);
+}
+
+/**
+ * @given Executor of Asio io_context and tasks scheduled with long delay
+ * @when Wake up one of them and cancel another one
+ * @then Woken task runs at once and only once; cancelled one never runs
+ */
+TEST_F(AsioExecutorTest, WakeAndCancel) {
+  AsioExecutor executor(io_context_.get_executor());
+  std::atomic_int woken = 0;
+  std::atomic_int cancelled = 0;
+
+  auto handle1 = executor.schedule(1h, [&] { ++woken; });
+  auto handle2 = executor.schedule(1h, [&] { ++cancelled; });
+
+  handle1->wake();
+  handle1->wake();
+  EXPECT_TRUE(waitFor([&] { return woken != 0; }));
+  EXPECT_TRUE(handle2->cancel());
+  handle2->wake();
+
+  std::this_thread::sleep_for(20ms);
+  EXPECT_EQ(woken, 1);
+  EXPECT_EQ(cancelled, 0);
+  EXPECT_FALSE(handle1->cancel());
+}
@@ -0,0 +1,359 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <map>
+#include <thread>
+
+#include "soralog/batch_sink.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+/**
+ * User-defined sink, which just collects messages
+ */
+class CollectingSink final : public BatchSink {
+ public:
+  explicit CollectingSink(size_t latency,
+                          size_t shards = 1,
+                          bool polled = false)
+      : BatchSink("collector",
+                  Level::TRACE,
+                  ThreadInfoType::NONE,
+                  64,        // capacity: 64 events
+                  64,        // max message length: 64 byte
+                  1u << 16,  // buffers size: 64 Kb
+                  latency,
+                  false,
+                  shards,
+                  false,
+                  polled) {
+    start();
+  }
+
+  ~CollectingSink() override {
+    stop();
+  }
+
+  /**
+   * @returns true if worker sleeps without deadline
+   */
+  bool parked() const noexcept {
+    return is_parked_.load();
+  }
+
+  std::vector<std::string> messages;
+  std::vector<uint64_t> sequences;
+  std::vector<uint32_t> lanes;
+  size_t batches = 0;
+  size_t syncs = 0;
+  size_t reopens = 0;
+
+ protected:
+  void write(const Batch &events, std::vector<char> &buffer) override {
+    EXPECT_FALSE(events.empty());
+    EXPECT_GE(buffer.size(),
+              events.size() * (max_message_length_ + max_record_overhead));
+    for (const auto &node : events) {
+      messages.emplace_back(node->message());
+      sequences.emplace_back(node.sequence());
+      lanes.emplace_back(node.lane());
+    }
+    ++batches;
+  }
+
+  void sync() noexcept override {
+    ++syncs;
+  }
+
+  void reopen() noexcept override {
+    ++reopens;
+  }
+};
+
+/**
+ * @given User-defined sink based on BatchSink
+ * @when Push events and flush them
+ * @then All events are delivered by batches in original order
+ */
+TEST(BatchSinkTest, DeliverByBatches) {
+  CollectingSink sink(10000);
+  for (int i = 1; i <= 40; ++i) {
+    sink.push("logger", Level::INFO, "message {}", i);
+  }
+  sink.flush();
+
+  ASSERT_EQ(sink.messages.size(), 40);
+  for (size_t i = 0; i < 40; ++i) {
+    EXPECT_EQ(sink.messages[i], fmt::format("message {}", i + 1));
+    EXPECT_EQ(sink.sequences[i], i + 1);
+  }
+  EXPECT_LT(sink.batches, 40);
+}
+
+/**
+ * @given Synchronous user-defined sink
+ * @when Request rotation
+ * @then Sink is asked to reopen destination
+ */
+TEST(BatchSinkTest, Rotate) {
+  CollectingSink sink(0);
+  sink.push("logger", Level::INFO, "message");
+  sink.rotate();
+  EXPECT_EQ(sink.messages.size(), 1);
+  EXPECT_EQ(sink.reopens, 1);
+}
+
+/**
+ * @given Sink with sharded queue of events
+ * @when Several threads push events one after another
+ * @then Events of all shards are merged in order of pushing, and each shard
+ * numbers own events without gaps
+ */
+TEST(BatchSinkTest, ShardedQueue) {
+  CollectingSink sink(10000, 4);
+  for (int t = 0; t < 4; ++t) {
+    std::thread([&, t] {
+      for (int i = 1; i <= 10; ++i) {
+        sink.push("logger", Level::INFO, "message {}.{}", t, i);
+      }
+    }).join();
+  }
+  sink.flush();
+
+  ASSERT_EQ(sink.messages.size(), 40);
+  std::map<uint32_t, uint64_t> last;
+  for (size_t i = 0; i < 40; ++i) {
+    EXPECT_EQ(sink.messages[i],
+              fmt::format("message {}.{}", i / 10, i % 10 + 1));
+    EXPECT_EQ(sink.sequences[i], ++last[sink.lanes[i]]);
+  }
+  uint64_t total = 0;
+  for (auto [lane, count] : last) {
+    total += count;
+  }
+  EXPECT_EQ(sink.lastSequence(), total);
+}
+
+/**
+ * @given Asynchronous sink without events
+ * @when Some time passes, then event is pushed
+ * @then Idle worker sleeps without deadline; event wakes it up, is written
+ * after latency, and worker sleeps again
+ */
+TEST(BatchSinkTest, IdleWorkerParks) {
+  CollectingSink sink(20);
+
+  auto wait_parked = [&] {
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (not sink.parked() and std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+    return sink.parked();
+  };
+
+  ASSERT_TRUE(wait_parked());
+  // Timed wait would have unparked worker at its deadline
+  std::this_thread::sleep_for(100ms);
+  EXPECT_TRUE(sink.parked());
+  EXPECT_EQ(sink.batches, 0);
+
+  sink.push("logger", Level::INFO, "message after idle");
+  EXPECT_FALSE(sink.parked());
+
+  std::this_thread::sleep_for(50ms);
+  ASSERT_TRUE(wait_parked());
+  ASSERT_EQ(sink.messages.size(), 1);
+  EXPECT_EQ(sink.messages[0], "message after idle");
+}
+
+/**
+ * @given Polled sink, which has no worker
+ * @when Push events and poll sink with limited budget
+ * @then Events are written by polling only, after deadline armed by the first
+ * event, and not more than budget per poll; urgent event is written at once
+ */
+TEST(BatchSinkTest, PollMode) {
+  CollectingSink sink(20, 1, true);
+  EXPECT_EQ(sink.poll(100), 0);
+
+  for (int i = 1; i <= 12; ++i) {
+    sink.push("logger", Level::INFO, "message {}", i);
+  }
+  // The first poll after idle arms deadline
+  EXPECT_EQ(sink.poll(100), 0);
+  std::this_thread::sleep_for(50ms);
+  EXPECT_TRUE(sink.messages.empty());
+
+  EXPECT_EQ(sink.poll(5), 5);
+  // The rest is due at once
+  EXPECT_EQ(sink.poll(5), 5);
+  EXPECT_EQ(sink.poll(5), 2);
+  EXPECT_EQ(sink.poll(5), 0);
+  ASSERT_EQ(sink.messages.size(), 12);
+  EXPECT_EQ(sink.messages[11], "message 12");
+
+  sink.push("logger", Level::ERROR, "urgent");
+  EXPECT_EQ(sink.poll(5), 1);
+  EXPECT_EQ(sink.messages.back(), "urgent");
+}
+
+/**
+ * Executor, which runs posted tasks on demand of test
+ */
+class ManualExecutor final : public Executor {
+ public:
+  void post(Task task) override {
+    ready.emplace_back(std::move(task));
+  }
+
+  void postAfter(Duration delay, Task task) override {
+    delayed.emplace_back(delay, std::move(task));
+  }
+
+  static void runAll(std::vector<Task> &tasks) {
+    auto running = std::move(tasks);
+    tasks.clear();
+    for (auto &task : running) {
+      task();
+    }
+  }
+
+  void runDelayed() {
+    std::vector<Task> tasks;
+    for (auto &[delay, task] : delayed) {
+      tasks.emplace_back(std::move(task));
+    }
+    delayed.clear();
+    runAll(tasks);
+  }
+
+  std::vector<Task> ready;
+  std::vector<std::pair<Duration, Task>> delayed;
+};
+
+/**
+ * @given Sink created while executor is set
+ * @when Push events, including urgent ones, and run tasks of executor
+ * @then Sink has no worker; the first event after idle schedules flush after
+ * latency, urgent event wakes it up at once, and idle sink schedules nothing
+ */
+TEST(BatchSinkTest, Executor) {
+  auto executor = std::make_shared<ManualExecutor>();
+  std::unique_ptr<CollectingSink> sink;
+  {
+    Executor::Scope scope(executor);
+    sink = std::make_unique<CollectingSink>(20);
+  }
+  EXPECT_TRUE(executor->ready.empty());
+  EXPECT_TRUE(executor->delayed.empty());
+
+  sink->push("logger", Level::INFO, "message 1");
+  sink->push("logger", Level::INFO, "message 2");
+  ASSERT_EQ(executor->delayed.size(), 1);
+  // Deadline is taken when the first event is pushed
+  EXPECT_LE(executor->delayed[0].first, 20ms);
+  EXPECT_GT(executor->delayed[0].first, 10ms);
+
+  executor->runDelayed();
+  EXPECT_EQ(sink->messages.size(), 2);
+  // Idle sink doesn't schedule anything
+  EXPECT_TRUE(executor->ready.empty());
+  EXPECT_TRUE(executor->delayed.empty());
+
+  sink->push("logger", Level::INFO, "message 3");
+  sink->push("logger", Level::ERROR, "urgent");
+  ASSERT_EQ(executor->ready.size(), 1);
+  ManualExecutor::runAll(executor->ready);
+  ASSERT_EQ(sink->messages.size(), 4);
+  // Urgent event keeps its place
+  EXPECT_EQ(sink->messages[2], "message 3");
+  EXPECT_EQ(sink->messages[3], "urgent");
+
+  // Woken task is not run again by timer
+  executor->runDelayed();
+  EXPECT_EQ(sink->batches, 2);
+  EXPECT_TRUE(executor->ready.empty());
+  EXPECT_TRUE(executor->delayed.empty());
+
+  // Pending task of destroyed sink does nothing
+  sink->push("logger", Level::INFO, "message 5");
+  ASSERT_EQ(executor->delayed.size(), 1);
+  sink.reset();
+  executor->runDelayed();
+}
+
+/**
+ * Synchronous sink, which remembers the last written number of each thread
+ */
+class LastNumberSink final : public BatchSink {
+ public:
+  static constexpr size_t threads = 4;
+
+  LastNumberSink()
+      : BatchSink("last_number",
+                  Level::TRACE,
+                  ThreadInfoType::NONE,
+                  16,        // capacity: 16 events
+                  64,        // max message length: 64 byte
+                  1u << 16,  // buffers size: 64 Kb
+                  0,         // latency: synchronous
+                  false) {
+    start();
+  }
+
+  ~LastNumberSink() override {
+    stop();
+  }
+
+  std::array<std::atomic_int, threads> last{};
+
+ protected:
+  void write(const Batch &events, std::vector<char> &) override {
+    for (const auto &node : events) {
+      auto message = node->message();
+      auto space = message.find(' ');
+      auto thread = std::stoul(std::string(message.substr(0, space)));
+      last[thread] = std::stoi(std::string(message.substr(space + 1)));
+    }
+  }
+};
+
+/**
+ * @given Synchronous sink (latency is 0) and several producing threads
+ * @when Each thread pushes events concurrently with others
+ * @then Event is written when push returns, even if other thread was
+ * flushing at the moment
+ */
+TEST(BatchSinkTest, SynchronousFlushCombining) {
+  LastNumberSink sink;
+  std::atomic_size_t lost = 0;
+
+  std::vector<std::thread> producers;
+  for (size_t thread = 0; thread < LastNumberSink::threads; ++thread) {
+    producers.emplace_back([&, thread] {
+      for (int i = 1; i <= 2000; ++i) {
+        sink.push("logger", Level::INFO, "{} {}", thread, i);
+        if (sink.last[thread] != i) {
+          ++lost;
+        }
+      }
+    });
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+
+  EXPECT_EQ(lost, 0);
+  for (const auto &last : sink.last) {
+    EXPECT_EQ(last, 2000);
+  }
+}
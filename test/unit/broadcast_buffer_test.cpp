@@ -0,0 +1,227 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <sstream>
+
+#include "soralog/batch_sink.hpp"
+#include "soralog/broadcast_buffer.hpp"
+#include "soralog/impl/multisink.hpp"
+#include "soralog/impl/sink_to_console.hpp"
+
+using namespace soralog;
+using namespace testing;
+
+using Buffer = BroadcastBuffer<int>;
+
+/**
+ * @given Broadcast buffer with two consumers
+ * @when Put items
+ * @then Each consumer gets each item; place is reclaimed after both read it
+ */
+TEST(BroadcastBufferTest, EachConsumerGetsEachItem) {
+  Buffer buffer(2, 0, 2, Buffer::LagPolicy::BLOCK);
+
+  ASSERT_TRUE(buffer.put(1));
+  ASSERT_TRUE(buffer.put(2));
+  EXPECT_FALSE(buffer.put(3));
+  EXPECT_EQ(buffer.size(), 2);
+
+  for (size_t consumer = 0; consumer < 2; ++consumer) {
+    auto first = buffer.get(consumer);
+    ASSERT_TRUE(first);
+    EXPECT_EQ(*first, 1);
+    EXPECT_EQ(first.sequence(), 1);
+  }
+  ASSERT_TRUE(buffer.put(3));
+
+  for (size_t consumer = 0; consumer < 2; ++consumer) {
+    EXPECT_EQ(*buffer.get(consumer), 2);
+    EXPECT_EQ(*buffer.get(consumer), 3);
+    EXPECT_FALSE(buffer.get(consumer));
+  }
+  EXPECT_EQ(buffer.size(), 0);
+}
+
+/**
+ * @given Broadcast buffer with drop policy
+ * @when The slowest consumer doesn't read items
+ * @then New items are dropped
+ */
+TEST(BroadcastBufferTest, DropPolicy) {
+  Buffer buffer(2, 0, 2, Buffer::LagPolicy::DROP);
+
+  for (int i = 1; i <= 4; ++i) {
+    std::ignore = buffer.put(i);
+    std::ignore = buffer.get(0);
+  }
+  EXPECT_EQ(buffer.dropped(), 2);
+  EXPECT_EQ(*buffer.get(1), 1);
+}
+
+/**
+ * @given Broadcast buffer with detach policy
+ * @when The slowest consumer doesn't read items
+ * @then It is detached, and others continue to get items
+ */
+TEST(BroadcastBufferTest, DetachPolicy) {
+  Buffer buffer(2, 0, 2, Buffer::LagPolicy::DETACH);
+
+  for (int i = 1; i <= 4; ++i) {
+    ASSERT_TRUE(buffer.put(i));
+    EXPECT_EQ(*buffer.get(0), i);
+  }
+  EXPECT_FALSE(buffer.isDetached(0));
+  EXPECT_TRUE(buffer.isDetached(1));
+  EXPECT_FALSE(buffer.get(1));
+  EXPECT_EQ(buffer.pending(1), 0);
+}
+
+/**
+ * Sink which just collects messages
+ */
+class CollectingSink final : public BatchSink {
+ public:
+  CollectingSink(std::string name,
+                 std::vector<std::string> &messages,
+                 Level level = Level::TRACE)
+      : BatchSink(std::move(name),
+                  level,
+                  ThreadInfoType::NONE,
+                  16,        // capacity: 16 events
+                  64,        // max message length: 64 byte
+                  1u << 16,  // buffers size: 64 Kb
+                  10,        // latency: 10 ms
+                  false),
+        messages_(messages) {
+    start();
+  }
+
+  ~CollectingSink() override {
+    stop();
+  }
+
+ protected:
+  void write(const Batch &events, std::vector<char> &) override {
+    for (const auto &node : events) {
+      messages_.emplace_back(node->message());
+    }
+  }
+
+ private:
+  std::vector<std::string> &messages_;
+};
+
+/**
+ * @given Multisink in broadcast mode over two sinks
+ * @when Push more events than capacity of shared buffer
+ * @then Each sink gets all events in order
+ */
+TEST(BroadcastBufferTest, Multisink) {
+  std::vector<std::string> first_messages;
+  std::vector<std::string> second_messages;
+  {
+    auto first = std::make_shared<CollectingSink>("first", first_messages);
+    auto second = std::make_shared<CollectingSink>("second", second_messages);
+    Multisink multisink("multisink",
+                        Level::TRACE,
+                        {first, second},
+                        Multisink::LagPolicy::BLOCK,
+                        8);  // capacity: 8 events
+    for (int i = 1; i <= 100; ++i) {
+      multisink.push("logger", Level::INFO, "message #{}", i);
+    }
+    multisink.flush();
+  }
+
+  ASSERT_EQ(first_messages.size(), 100);
+  ASSERT_EQ(second_messages, first_messages);
+  for (int i = 1; i <= 100; ++i) {
+    EXPECT_EQ(first_messages[i - 1], fmt::format("message #{}", i));
+  }
+}
+
+/**
+ * @given Multisink of level TRACE in broadcast mode over sinks of levels
+ * WARN and TRACE
+ * @when Push events of all levels
+ * @then Each sink gets only events of its own level and more important
+ */
+TEST(BroadcastBufferTest, MixedLevels) {
+  std::vector<std::string> warn_messages;
+  std::vector<std::string> trace_messages;
+  {
+    auto warn =
+        std::make_shared<CollectingSink>("warn", warn_messages, Level::WARN);
+    auto trace = std::make_shared<CollectingSink>(
+        "trace", trace_messages, Level::TRACE);
+    Multisink multisink("multisink",
+                        Level::TRACE,
+                        {warn, trace},
+                        Multisink::LagPolicy::BLOCK,
+                        8);  // capacity: 8 events
+    for (int i = 1; i <= 10; ++i) {
+      multisink.push("logger", Level::TRACE, "trace #{}", i);
+      multisink.push("logger", Level::DEBUG, "debug #{}", i);
+      multisink.push("logger", Level::WARN, "warn #{}", i);
+      multisink.push("logger", Level::ERROR, "error #{}", i);
+    }
+    multisink.flush();
+  }
+
+  ASSERT_EQ(trace_messages.size(), 40);
+  ASSERT_EQ(warn_messages.size(), 20);
+  for (int i = 1; i <= 10; ++i) {
+    EXPECT_EQ(warn_messages[i * 2 - 2], fmt::format("warn #{}", i));
+    EXPECT_EQ(warn_messages[i * 2 - 1], fmt::format("error #{}", i));
+  }
+}
+
+/**
+ * @given Multisink in broadcast mode over console sinks with max message
+ * length of 16 and 8192 bytes
+ * @when Push events with messages of 4000 bytes
+ * @then Each sink writes messages cut to its own limit
+ */
+TEST(BroadcastBufferTest, MixedMaxMessageLength) {
+  auto createSink = [](std::string name, size_t max_message_length) {
+    return std::make_shared<SinkToConsole>(std::move(name),
+                                           Level::TRACE,
+                                           SinkToConsole::Stream::STDOUT,
+                                           false,  // no color
+                                           Sink::ThreadInfoType::NONE,
+                                           4,  // capacity: 4 events
+                                           max_message_length,
+                                           4096,  // buffers size: 4 Kb
+                                           10);   // latency: 10 ms
+  };
+  const std::string message(4000, 'x');
+
+  testing::internal::CaptureStdout();
+  {
+    Multisink multisink("multisink",
+                        Level::TRACE,
+                        {createSink("short", 16), createSink("long", 8192)},
+                        Multisink::LagPolicy::BLOCK,
+                        8);  // capacity: 8 events
+    for (int i = 1; i <= 10; ++i) {
+      multisink.push("logger", Level::INFO, "{}", message);
+    }
+    multisink.flush();
+  }
+  std::istringstream output(testing::internal::GetCapturedStdout());
+
+  std::map<size_t, size_t> lengths;
+  for (std::string line; std::getline(output, line);) {
+    ++lengths[line.size() - line.find_last_not_of('x') - 1];
+  }
+  EXPECT_EQ(lengths.size(), 2);
+  EXPECT_EQ(lengths[16], 10);
+  EXPECT_EQ(lengths[4000], 10);
+}
@@ -113,6 +113,34 @@ TEST_F(CircularBufferTest, Get) {
   EXPECT_EQ(testee.capacity(), capacity);
 }
 
+TEST_F(CircularBufferTest, Sequence) {
+  size_t capacity = 3;
+
+  CircularBuffer<Data> testee(capacity);
+
+  EXPECT_EQ(testee.lastSequence(), 0);
+
+  // Several rounds over buffer: numbers keep growing
+  for (auto round = 0; round < 3; ++round) {
+    for (auto i = 0; i < capacity; ++i) {
+      auto ref = testee.put('1' + i);
+      ASSERT_TRUE(ref);
+      EXPECT_EQ(ref.sequence(), round * capacity + i + 1);
+    }
+
+    // Overfill does not consume number
+    EXPECT_FALSE(testee.put('*'));
+    EXPECT_EQ(testee.lastSequence(), (round + 1) * capacity);
+
+    for (auto i = 0; i < capacity; ++i) {
+      auto ref = testee.get();
+      ASSERT_TRUE(ref);
+      EXPECT_EQ(ref.sequence(), round * capacity + i + 1);
+      EXPECT_EQ(*ref, Data('1' + i));
+    }
+  }
+}
+
 TEST_F(CircularBufferTest, PutGet) {
   size_t capacity = 10;
 
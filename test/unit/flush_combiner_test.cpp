@@ -0,0 +1,129 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <thread>
+#include <vector>
+
+#include "soralog/flush_combiner.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace {
+
+  /**
+   * @returns CPU time consumed by {@param thread}
+   */
+  std::chrono::nanoseconds cpuTime(std::thread &thread) {
+    clockid_t clock{};
+    timespec ts{};
+    if (pthread_getcpuclockid(thread.native_handle(), &clock) != 0
+        or clock_gettime(clock, &ts) != 0) {
+      return {};
+    }
+    return std::chrono::seconds(ts.tv_sec)
+         + std::chrono::nanoseconds(ts.tv_nsec);
+  }
+
+}  // namespace
+
+/**
+ * @given Many threads which request passes concurrently
+ * @when Each of them marks its data and calls combine
+ * @then Each call returns only after pass which has seen its data, and all
+ * threads finish (no wakeup is lost)
+ */
+TEST(FlushCombinerTest, PassSeesDataOfEachRequest) {
+  constexpr size_t threads = 8;
+  constexpr size_t iterations = 5000;
+
+  FlushCombiner combiner;
+  std::atomic<uint64_t> pushed = 0;
+  std::atomic<uint64_t> seen = 0;
+  std::atomic<size_t> passes = 0;
+  std::atomic<size_t> missed = 0;
+
+  std::vector<std::thread> workers;
+  for (size_t t = 0; t < threads; ++t) {
+    workers.emplace_back([&] {
+      for (size_t i = 0; i < iterations; ++i) {
+        const auto mine = pushed.fetch_add(1) + 1;
+        combiner.combine([&] {
+          seen.store(pushed.load());
+          ++passes;
+        });
+        if (seen.load() < mine) {
+          ++missed;
+        }
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  EXPECT_EQ(missed, 0);
+  EXPECT_EQ(seen, threads * iterations);
+  // Requests of concurrent threads are served by common passes
+  EXPECT_LE(passes, threads * iterations);
+}
+
+/**
+ * @given Pass in progress, which takes long time
+ * @when Other thread requests pass, and another one waits for exclusive one
+ * @then They sleep instead of spinning, and are done after the long pass
+ */
+TEST(FlushCombinerTest, WaitersSleep) {
+  FlushCombiner combiner;
+  std::atomic_bool started = false;
+  std::atomic_bool finished = false;
+
+  std::thread combiner_thread([&] {
+    combiner.combine([&] {
+      started = true;
+      std::this_thread::sleep_for(300ms);
+      finished = true;
+    });
+  });
+  while (not started) {
+    std::this_thread::sleep_for(1ms);
+  }
+
+  // Exclusive pass isn't run without waiting, while other one is in progress
+  EXPECT_FALSE(combiner.exclusive([] {}, false));
+
+  std::atomic_bool combined = false;
+  std::atomic_bool exclusive = false;
+  std::thread waiter([&] {
+    combiner.combine([] {});
+    combined = finished.load();
+  });
+  std::thread exclusive_waiter([&] {
+    exclusive = combiner.exclusive([] {}, true) and finished.load();
+  });
+
+  std::this_thread::sleep_for(200ms);
+  const auto waiter_cpu = cpuTime(waiter);
+  const auto exclusive_cpu = cpuTime(exclusive_waiter);
+
+  combiner_thread.join();
+  waiter.join();
+  exclusive_waiter.join();
+
+  EXPECT_TRUE(combined);
+  EXPECT_TRUE(exclusive);
+  EXPECT_LT(waiter_cpu, 20ms);
+  EXPECT_LT(exclusive_cpu, 20ms);
+}
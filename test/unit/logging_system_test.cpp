@@ -83,6 +83,26 @@ TEST_F(LoggingSystemTest, MakeSink) {
   EXPECT_TRUE(system_->getSink("sink") != nullptr);
 }
 
+/**
+ * @given Logging system with two polled sinks, each writes up to 3 events
+ * @when Poll it twice with budget of 4 events
+ * @then Budget is shared by sinks, and each poll starts from another sink
+ */
+TEST_F(LoggingSystemTest, Poll) {
+  auto sink1 = system_->makeSink<SinkMock>("sink1");
+  auto sink2 = system_->makeSink<SinkMock>("sink2");
+  auto write_up_to_3 = [](size_t budget) {
+    return std::min<size_t>(budget, 3);
+  };
+  for (const auto &sink : {sink1, sink2}) {
+    EXPECT_CALL(*sink, mocked_poll(4)).WillOnce(Invoke(write_up_to_3));
+    EXPECT_CALL(*sink, mocked_poll(1)).WillOnce(Invoke(write_up_to_3));
+  }
+
+  EXPECT_EQ(system_->poll(4), 4);
+  EXPECT_EQ(system_->poll(4), 4);
+}
+
 TEST_F(LoggingSystemTest, GetGroup) {
   configure();
 
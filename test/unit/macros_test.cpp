@@ -23,15 +23,16 @@ class MacrosTest : public ::testing::Test {
       size_t len =
           ::fmt::vformat_to_n(
               message_buf.begin(), message_buf.size(),
-              ::fmt::detail_exported::compile_string_to_view<char>(format),
+              soralog::formatToView(format),
               ::fmt::make_format_args(args...))
               .size;
       last_message = std::string_view(message_buf.data(),
                                       std::min(len, message_buf.size()));
     }
-    static Level level() {
-      return Level::TRACE;
+    Level level() const {
+      return current_level;
     }
+    Level current_level = Level::TRACE;
     Level last_level = Level::OFF;
     std::array<char, 100> message_buf;
     std::string_view last_message;
@@ -47,6 +48,20 @@ class MacrosTest : public ::testing::Test {
   std::shared_ptr<FakeLogger> logger() const {
     return logger_;
   }
+
+  /**
+   * Makes event by {@param format} and {@param args} in storage with place
+   * for message of 64 bytes, as sink does
+   * @returns message of event
+   */
+  template <typename Format, typename... Args>
+  std::string eventMessage(const Format &format, const Args &...args) {
+    auto *event = new (event_storage_.data()) Event(
+        "logger", Sink::ThreadInfoType::NONE, Level::INFO, format, 64, args...);
+    return std::string(event->message());
+  }
+
+  alignas(Event) std::array<char, sizeof(Event) + 64> event_storage_;
 };
 
 TEST_F(MacrosTest, NoArg) {
@@ -259,3 +274,144 @@ TEST_F(MacrosTest, StructuredBinding) {
   SL_DEBUG_DF(logger(), df, x);
   EXPECT_TRUE(logger_->last_message == "x: 1");
 }
+
+/**
+ * @given Place for message of 64 bytes
+ * @when Make events with precompiled format, short and too long
+ * @then Messages are the same as by runtime format; long one is truncated
+ */
+TEST_F(MacrosTest, CompiledFormat) {
+  EXPECT_EQ(eventMessage(FMT_COMPILE("{} and {:.1f}"), "one", 2.0),
+            "one and 2.0");
+  EXPECT_EQ(eventMessage(FMT_COMPILE("{:->100}"), 'x'), std::string(64, '-'));
+  EXPECT_EQ(eventMessage("{:->100}", 'x'), std::string(64, '-'));
+}
+
+/**
+ * @given Precompiled formats without arguments
+ * @when Make events by them
+ * @then Plain literal is referred by event without copying; literal with
+ * escaped braces is formatted as usual
+ */
+TEST_F(MacrosTest, LiteralMessage) {
+  constexpr auto literal = FMT_COMPILE("Connection closed");
+  Event event("logger", Sink::ThreadInfoType::NONE, Level::INFO, literal, 64);
+  EXPECT_EQ(event.message().data(), formatToView(literal).data());
+  EXPECT_EQ(event.message(), "Connection closed");
+
+  EXPECT_EQ(eventMessage(FMT_COMPILE("Set {{}} is empty")), "Set {} is empty");
+}
+
+/**
+ * @given Logger with enough and not enough level
+ * @when Leave scope measured by SL_SCOPE_TIMER
+ * @then Event with duration is logged only if level is enough; timer
+ * doesn't take ownership of logger
+ */
+TEST_F(MacrosTest, ScopeTimer) {
+  {
+    SL_SCOPE_TIMER(logger(), "scope");
+    EXPECT_EQ(logger_.use_count(), 1);
+  }
+  EXPECT_TRUE(logger_->last_level == Level::DEBUG);
+  EXPECT_TRUE(logger_->last_message.substr(0, 11) == "scope took ")
+      << logger_->last_message;
+  EXPECT_TRUE(logger_->last_message.substr(logger_->last_message.size() - 3)
+              == " ms");
+
+  logger_->current_level = Level::INFO;
+  logger_->last_message = {};
+  {
+    SL_SCOPE_TIMER(logger(), "scope");
+  }
+  EXPECT_TRUE(logger_->last_message.empty());
+}
+
+/**
+ * @given Formats of span events, as macros and scope timer make them
+ * @when Make events by them and by usual format of the same text
+ * @then Span events keep kind, duration and name of span besides message;
+ * usual event isn't span one
+ */
+TEST_F(MacrosTest, SpanEvent) {
+  Event begin("logger",
+              Sink::ThreadInfoType::NONE,
+              Level::DEBUG,
+              spanFormat(SpanKind::BEGIN, FMT_COMPILE("{}{}")),
+              64,
+              span_begin_prefix,
+              "request");
+  EXPECT_TRUE(begin.span_kind() == SpanKind::BEGIN);
+  EXPECT_EQ(begin.message(), ">>> request");
+  EXPECT_EQ(begin.span_name(), "request");
+
+  Event complete("logger",
+                 Sink::ThreadInfoType::NONE,
+                 Level::DEBUG,
+                 spanFormat(SpanKind::COMPLETE,
+                            FMT_COMPILE("{} took {:.3f} ms"),
+                            std::chrono::microseconds(1500),
+                            5),
+                 64,
+                 "parse",
+                 1.5);
+  EXPECT_TRUE(complete.span_kind() == SpanKind::COMPLETE);
+  EXPECT_EQ(complete.message(), "parse took 1.500 ms");
+  EXPECT_EQ(complete.span_name(), "parse");
+  EXPECT_EQ(complete.span_duration(), std::chrono::microseconds(1500));
+
+  Event usual("logger",
+              Sink::ThreadInfoType::NONE,
+              Level::DEBUG,
+              FMT_COMPILE("{}{}"),
+              64,
+              span_begin_prefix,
+              "request");
+  EXPECT_TRUE(usual.span_kind() == SpanKind::NONE);
+  EXPECT_EQ(usual.message(), ">>> request");
+  EXPECT_TRUE(usual.span_name().empty());
+}
+
+/**
+ * @given Latency histogram
+ * @when Record known durations and collect them
+ * @then Summary is consistent with recorded durations, histogram is reset
+ */
+TEST_F(MacrosTest, LatencyHistogram) {
+  using std::chrono::nanoseconds;
+  LatencyHistogram histogram("site");
+  for (int i = 0; i < 98; ++i) {
+    histogram.record(nanoseconds(1000));  // bucket [512, 1024)
+  }
+  histogram.record(nanoseconds(100000));
+  histogram.record(nanoseconds(200000));
+  EXPECT_EQ(histogram.count(), 100);
+
+  auto summary = histogram.collect();
+  EXPECT_EQ(summary.count, 100);
+  EXPECT_EQ(summary.avg, nanoseconds((98 * 1000 + 300000) / 100));
+  EXPECT_EQ(summary.p50, nanoseconds(1023));
+  EXPECT_EQ(summary.p90, nanoseconds(1023));
+  EXPECT_GE(summary.p99, nanoseconds(100000));
+  EXPECT_LE(summary.p99, nanoseconds(200000));
+  EXPECT_EQ(summary.max, nanoseconds(200000));
+  EXPECT_EQ(histogram.count(), 0);
+
+  auto now = LatencyHistogram::Clock::now();
+  EXPECT_FALSE(histogram.isTimeToDump(now));
+  EXPECT_TRUE(histogram.isTimeToDump(now + LatencyHistogram::default_period));
+  EXPECT_FALSE(histogram.isTimeToDump(now + LatencyHistogram::default_period));
+}
+
+/**
+ * @given Logger
+ * @when Pass scope measured by SL_SCOPE_HISTOGRAM many times
+ * @then Durations are aggregated, nothing is logged before period is over
+ */
+TEST_F(MacrosTest, ScopeHistogram) {
+  logger_->last_message = {};
+  for (int i = 0; i < 10; ++i) {
+    SL_SCOPE_HISTOGRAM(logger(), "loop");
+  }
+  EXPECT_TRUE(logger_->last_message.empty());
+}
@@ -0,0 +1,47 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "soralog/prefix_cache.hpp"
+
+using namespace soralog;
+using namespace testing;
+
+/**
+ * @given Prefix cache
+ * @when Get prefixes of several loggers and levels many times
+ * @then Each prefix is rendered once and is the same as rendered directly
+ */
+TEST(PrefixCacheTest, RenderOnce) {
+  PrefixCache cache;
+  size_t renders = 0;
+
+  auto get = [&](std::string_view name, Level level) {
+    return std::string(cache.get(name, level, [&](char *&ptr) {
+      ++renders;
+      for (auto c : std::string(levelToStr(level)) + "  " + std::string(name)) {
+        *ptr++ = c;  // NOLINT
+      }
+    }));
+  };
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(get("main", Level::INFO), "Info  main");
+    EXPECT_EQ(get("main", Level::WARN), "Warning  main");
+    EXPECT_EQ(get("network", Level::INFO), "Info  network");
+  }
+  EXPECT_EQ(renders, 3);
+
+  // Name, which is too long for cache, is rendered each time
+  const std::string long_name(PrefixCache::max_name_size + 1, 'x');
+  EXPECT_EQ(get(long_name, Level::INFO), "Info  " + long_name);
+  EXPECT_EQ(get(long_name, Level::INFO), "Info  " + long_name);
+  EXPECT_EQ(renders, 5);
+}
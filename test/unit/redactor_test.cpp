@@ -0,0 +1,84 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "soralog/impl/sink_to_file.hpp"
+#include "soralog/redactor.hpp"
+
+using namespace soralog;
+using namespace testing;
+
+namespace {
+  std::string redact(const Redactor &redactor, std::string text) {
+    redactor.redact(text.data(), text.data() + text.size());
+    return text;
+  }
+}  // namespace
+
+/**
+ * @given Redactor with overlapping patterns of every mask
+ * @when Redact text containing them
+ * @then Only corresponding parts are masked, length is kept
+ */
+TEST(RedactorTest, Masks) {
+  Redactor redactor({
+      {"secret", Redactor::Mask::MATCH},
+      {"token=", Redactor::Mask::VALUE},
+      {"access_token=", Redactor::Mask::VALUE},
+      {"@", Redactor::Mask::WORD},
+  });
+
+  EXPECT_EQ(redact(redactor, "clean message"), "clean message");
+  EXPECT_EQ(redact(redactor, "my secret is here"), "my ****** is here");
+  EXPECT_EQ(redact(redactor, "url?token=abc123&x=1"),
+            "url?token=******&x=1");
+  EXPECT_EQ(redact(redactor, "access_token=xyz, next"),
+            "access_token=***, next");
+  EXPECT_EQ(redact(redactor, "mail to \"john.doe@example.com\"!"),
+            "mail to \"********************\"!");
+  EXPECT_EQ(redact(redactor, "secretsecret"), "************");
+  EXPECT_EQ(redact(redactor, "token="), "token=");
+}
+
+/**
+ * @given Redactor
+ * @when It's constructed with empty pattern
+ * @then Exception is thrown
+ */
+TEST(RedactorTest, EmptyPattern) {
+  EXPECT_THROW(Redactor({{"", Redactor::Mask::MATCH}}), std::invalid_argument);
+}
+
+/**
+ * @given Sink to file with redactor
+ * @when Push event with secret
+ * @then Secret is masked in written message only
+ */
+TEST(RedactorTest, SinkToFile) {
+  std::string path(
+      (std::filesystem::temp_directory_path() / "soralog_test_XXXXXX").c_str());
+  ASSERT_NE(mkstemp(path.data()), -1);
+  {
+    SinkToFile sink("password", Level::TRACE, path);
+    sink.setRedactor(std::make_shared<Redactor>(std::vector<Redactor::Pattern>{
+        {"password=", Redactor::Mask::VALUE}}));
+    sink.push("password", Level::INFO, "login with password={}", "qwerty");
+  }
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  std::remove(path.c_str());
+
+  auto line = ss.str();
+  EXPECT_NE(line.find("  password  login with password=******\n"),
+            std::string::npos)
+      << line;
+}
@@ -0,0 +1,117 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+
+#include "soralog/impl/thread_pool_executor.hpp"
+#include "soralog/sink_scheduler.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace {
+
+  /**
+   * Waits for {@param condition} for a second at most
+   * @returns value of condition
+   */
+  template <typename Condition>
+  bool waitFor(const Condition &condition) {
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (not condition() and std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+    return condition();
+  }
+
+  /**
+   * Counts passes and deadline requests of scheduler; it has work (deadline
+   * in 10 ms) while {@param busy} is set
+   */
+  struct Counting {
+    std::atomic_size_t passes = 0;
+    std::atomic_size_t deadlines = 0;
+    std::atomic_bool busy = false;
+
+    void start(SinkScheduler &scheduler) {
+      scheduler.start(
+          "test",
+          [this] { ++passes; },
+          [this] {
+            ++deadlines;
+            return busy ? SinkScheduler::Clock::now() + 10ms
+                        : SinkScheduler::never;
+          });
+    }
+  };
+
+}  // namespace
+
+/**
+ * @given Scheduler with own worker, which has nothing to do
+ * @when Time passes, then pass is requested, then work appears
+ * @then Idle worker doesn't wake up; requested pass is run at once; passes
+ * are run by deadlines while there is work
+ */
+TEST(SinkSchedulerTest, Worker) {
+  Counting counting;
+  SinkScheduler scheduler;
+  counting.start(scheduler);
+  EXPECT_TRUE(scheduler.active());
+
+  std::this_thread::sleep_for(50ms);
+  EXPECT_EQ(counting.passes, 0);
+  EXPECT_EQ(counting.deadlines, 1);
+
+  scheduler.request();
+  EXPECT_TRUE(waitFor([&] { return counting.passes == 1; }));
+
+  counting.busy = true;
+  scheduler.wake();
+  EXPECT_TRUE(waitFor([&] { return counting.passes >= 4; }));
+
+  scheduler.stop();
+  EXPECT_FALSE(scheduler.active());
+  const size_t passes = counting.passes;
+  std::this_thread::sleep_for(30ms);
+  EXPECT_EQ(counting.passes, passes);
+}
+
+/**
+ * @given Scheduler created while executor is set
+ * @when Pass is requested, then work appears, then scheduler is stopped
+ * @then Passes are run by tasks of executor; idle scheduler posts nothing;
+ * nothing is run after stop
+ */
+TEST(SinkSchedulerTest, Executor) {
+  auto executor = std::make_shared<ThreadPoolExecutor>("test");
+  Counting counting;
+  SinkScheduler scheduler;
+  {
+    Executor::Scope scope(executor);
+    counting.start(scheduler);
+  }
+
+  scheduler.request();
+  EXPECT_TRUE(waitFor([&] { return counting.passes == 1; }));
+  std::this_thread::sleep_for(30ms);
+  EXPECT_EQ(counting.passes, 1);
+
+  counting.busy = true;
+  scheduler.wake();
+  EXPECT_TRUE(waitFor([&] { return counting.passes >= 4; }));
+
+  scheduler.stop();
+  EXPECT_FALSE(scheduler.active());
+  const size_t passes = counting.passes;
+  std::this_thread::sleep_for(30ms);
+  EXPECT_EQ(counting.passes, passes);
+}
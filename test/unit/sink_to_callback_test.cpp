@@ -0,0 +1,157 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include "soralog/impl/sink_to_callback.hpp"
+
+using namespace soralog;
+using namespace testing;
+
+/**
+ * @given Sink to callback with subscriber
+ * @when Events are pushed from several threads, with overflowing queue
+ * @then Subscriber gets each event once, in worker thread only
+ */
+TEST(SinkToCallbackTest, CallbacksInWorker) {
+  constexpr size_t threads_number = 4;
+  constexpr size_t count = 1000;
+
+  std::vector<std::string> messages;
+  std::set<std::thread::id> callers;
+  std::set<std::thread::id> producers;
+  {
+    SinkToCallback sink("callback",
+                        Level::TRACE,
+                        {},                          // without ring
+                        Sink::ThreadInfoType::NONE,  // ignore thread info
+                        16,                          // capacity: 16 events
+                        64,                          // max message length
+                        4096,                        // buffers size
+                        10);                         // latency: 10 ms
+    sink.subscribe([&](const BatchSink::Batch &events) {
+      callers.insert(std::this_thread::get_id());
+      for (const auto &event : events) {
+        messages.emplace_back(event->message());
+      }
+    });
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    for (size_t t = 0; t < threads_number; ++t) {
+      threads.emplace_back([&, t] {
+        {
+          std::lock_guard lock(mutex);
+          producers.insert(std::this_thread::get_id());
+        }
+        for (size_t i = 0; i < count; ++i) {
+          sink.push("logger", Level::INFO, "{}:{}", t, i);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    sink.flush();
+  }
+
+  EXPECT_EQ(messages.size(), threads_number * count);
+  EXPECT_EQ(std::set(messages.begin(), messages.end()).size(),
+            threads_number * count);
+  ASSERT_EQ(callers.size(), 1);
+  EXPECT_EQ(producers.count(*callers.begin()), 0);
+  EXPECT_NE(*callers.begin(), std::this_thread::get_id());
+}
+
+/**
+ * @given Sink to callback with subscriber
+ * @when Subscriber is unsubscribed
+ * @then It doesn't get events pushed after that
+ */
+TEST(SinkToCallbackTest, Unsubscribe) {
+  size_t calls = 0;
+  {
+    SinkToCallback sink("callback", Level::TRACE);
+    auto id = sink.subscribe(
+        [&](const BatchSink::Batch &events) { calls += events.size(); });
+    sink.push("logger", Level::INFO, "one");
+    sink.flush();
+    sink.unsubscribe(id);
+    sink.push("logger", Level::INFO, "two");
+    sink.flush();
+  }
+  EXPECT_EQ(calls, 1);
+}
+
+/**
+ * @given Sink to callback with ring of 3 recent events
+ * @when 5 events are pushed
+ * @then Ring returns last 3 rendered events in order
+ */
+TEST(SinkToCallbackTest, RecentEvents) {
+  SinkToCallback sink("callback", Level::TRACE, 3);
+  EXPECT_TRUE(sink.recent().empty());
+
+  for (int i = 1; i <= 5; ++i) {
+    sink.push("logger", Level::ERROR, "error #{}", i);
+  }
+  sink.flush();
+
+  auto recent = sink.recent();
+  ASSERT_EQ(recent.size(), 3);
+  for (size_t i = 0; i < recent.size(); ++i) {
+    EXPECT_NE(recent[i].find(fmt::format("Error     logger  error #{}", i + 3)),
+              std::string::npos)
+        << recent[i];
+  }
+
+  recent = sink.recent(1);
+  ASSERT_EQ(recent.size(), 1);
+  EXPECT_NE(recent[0].find("error #5"), std::string::npos);
+}
+
+/**
+ * @given Sink to callback with small ring of recent events
+ * @when Events are pushed and flushed, while other thread reads ring
+ * @then Each returned record is complete record of one event, never mix of
+ * overwritten and new ones
+ */
+TEST(SinkToCallbackTest, RecentEventsWhileWriting) {
+  SinkToCallback sink("callback", Level::TRACE, 2);
+
+  std::atomic_bool done = false;
+  std::atomic_size_t torn = 0;
+  std::thread reader([&] {
+    while (not done) {
+      for (const auto &record : sink.recent()) {
+        // Message is "<number>:<number>" with the same number twice
+        const auto colon = record.rfind(':');
+        const auto space = record.rfind(' ', colon);
+        if (colon == std::string::npos or space == std::string::npos
+            or record.substr(space + 1, colon - space - 1)
+                   != record.substr(colon + 1)) {
+          ++torn;
+        }
+      }
+    }
+  });
+
+  for (size_t i = 1; i <= 20000; ++i) {
+    sink.push("logger", Level::INFO, "{0:0>{1}}:{0:0>{1}}", i, i % 200);
+    if (i % 4 == 0) {
+      sink.flush();
+    }
+  }
+  done = true;
+  reader.join();
+
+  EXPECT_EQ(torn, 0);
+}
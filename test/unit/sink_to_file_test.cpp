@@ -8,6 +8,7 @@
 #include <gtest/gtest.h>
 
 #include "soralog/impl/sink_to_file.hpp"
+#include "soralog/impl/thread_pool_executor.hpp"
 
 using namespace soralog;
 using namespace testing;
@@ -58,7 +59,7 @@ class SinkToFileTest : public ::testing::Test {
     return std::make_shared<FakeLogger>(std::move(sink));
   }
 
- private:
+ protected:
   std::filesystem::path path_;
 };
 
@@ -75,3 +76,281 @@ TEST_F(SinkToFileTest, Logging) {
   }
   logger->flush();
 }
+
+/**
+ * @given Sink to file with pool of rendering threads
+ * @when Push many events and flush them by big batch
+ * @then Records are written in original order of events
+ */
+TEST_F(SinkToFileTest, ParallelRenderingKeepsOrder) {
+  constexpr size_t count = 1000;
+  {
+    SinkToFile sink("file",
+                    Level::TRACE,
+                    path_,
+                    Sink::ThreadInfoType::NONE,  // ignore thread info
+                    1024,                        // capacity: 1024 events
+                    64,                          // max message length: 64 byte
+                    1u << 20,                    // buffers size: 1 Mb
+                    10000,                       // latency: 10 sec
+                    true,                        // with sequence
+                    4);                          // render threads
+    for (size_t i = 1; i <= count; ++i) {
+      sink.push("logger", Level::INFO, "message {}", i);
+    }
+    sink.flush();
+  }
+
+  std::ifstream in(path_);
+  std::string line;
+  size_t expected = 0;
+  while (std::getline(in, line)) {
+    ++expected;
+    EXPECT_NE(line.find(fmt::format("#0.{:<6}", expected)), std::string::npos)
+        << line;
+    EXPECT_NE(line.find(fmt::format("message {}", expected)),
+              std::string::npos)
+        << line;
+  }
+  EXPECT_EQ(expected, count);
+}
+
+/**
+ * @given Sink to file with rendering in parallel, created while executor
+ * is set
+ * @when Push many events and flush them by big batch
+ * @then Sink has neither worker nor rendering threads; records are written in
+ * original order of events
+ */
+TEST_F(SinkToFileTest, ParallelRenderingByExecutor) {
+  constexpr size_t count = 1000;
+  auto executor = std::make_shared<ThreadPoolExecutor>("test", 2);
+  std::filesystem::directory_iterator tasks("/proc/self/task");
+  const auto threads = std::distance(begin(tasks), end(tasks));
+  {
+    std::unique_ptr<SinkToFile> sink;
+    {
+      Executor::Scope scope(executor);
+      sink = std::make_unique<SinkToFile>(
+          "file",
+          Level::TRACE,
+          path_,
+          Sink::ThreadInfoType::NONE,  // ignore thread info
+          1024,                        // capacity: 1024 events
+          64,                          // max message length: 64 byte
+          1u << 20,                    // buffers size: 1 Mb
+          10000,                       // latency: 10 sec
+          true,                        // with sequence
+          4);                          // render threads
+    }
+    tasks = std::filesystem::directory_iterator("/proc/self/task");
+    EXPECT_EQ(std::distance(begin(tasks), end(tasks)), threads);
+
+    for (size_t i = 1; i <= count; ++i) {
+      sink->push("logger", Level::INFO, "message {}", i);
+    }
+    sink->flush();
+  }
+
+  std::ifstream in(path_);
+  std::string line;
+  size_t expected = 0;
+  while (std::getline(in, line)) {
+    ++expected;
+    EXPECT_NE(line.find(fmt::format("message {}", expected)),
+              std::string::npos)
+        << line;
+  }
+  EXPECT_EQ(expected, count);
+}
+
+/**
+ * @given Sink to file
+ * @when Push short messages and long ones, which are written in place
+ * @then Records are written whole and in original order
+ */
+TEST_F(SinkToFileTest, LongMessagesInPlace) {
+  constexpr size_t count = 100;
+  auto message = [](size_t i) {
+    return std::string(i % 2 ? SinkToFile::min_in_place_message_size + i : i,
+                       static_cast<char>('a' + i % 26));
+  };
+  {
+    SinkToFile sink("file",
+                    Level::TRACE,
+                    path_,
+                    Sink::ThreadInfoType::NONE,  // ignore thread info
+                    64,                          // capacity: 64 events
+                    1024,                        // max message length: 1 Kb
+                    1u << 20,                    // buffers size: 1 Mb
+                    10000);                      // latency: 10 sec
+    for (size_t i = 1; i <= count; ++i) {
+      sink.push("logger", Level::INFO, "{}", message(i));
+    }
+    sink.flush();
+  }
+
+  std::ifstream in(path_);
+  std::string line;
+  size_t expected = 0;
+  while (std::getline(in, line)) {
+    ++expected;
+    const auto suffix = "  logger  " + message(expected);
+    ASSERT_GE(line.size(), suffix.size());
+    EXPECT_EQ(line.substr(line.size() - suffix.size()), suffix);
+  }
+  EXPECT_EQ(expected, count);
+}
+
+/**
+ * @given Sink to file with writeback of page cache and preallocation
+ * @when Push events of many times more size than steps of them
+ * @then All records are written, size of file is size of records only
+ */
+TEST_F(SinkToFileTest, PageCacheManagement) {
+  constexpr size_t count = 1000;
+  {
+    SinkToFile sink("file",
+                    Level::TRACE,
+                    path_,
+                    Sink::ThreadInfoType::NONE,  // ignore thread info
+                    64,                          // capacity: 64 events
+                    1024,                        // max message length: 1 Kb
+                    1u << 20,                    // buffers size: 1 Mb
+                    10000,                       // latency: 10 sec
+                    false,                       // without sequence
+                    0,                           // without render threads
+                    1,                           // single shard
+                    8192,                        // writeback: 8 Kb
+                    65536);                      // preallocate: 64 Kb
+    for (size_t i = 1; i <= count; ++i) {
+      sink.push("logger", Level::INFO, "message {:0>100}", i);
+      if (i % 50 == 0) {
+        sink.flush();
+      }
+    }
+  }
+
+  std::ifstream in(path_);
+  std::string line;
+  size_t expected = 0;
+  size_t size = 0;
+  while (std::getline(in, line)) {
+    ++expected;
+    size += line.size() + 1;
+    EXPECT_NE(line.find(fmt::format("message {:0>100}", expected)),
+              std::string::npos)
+        << line;
+  }
+  EXPECT_EQ(expected, count);
+  EXPECT_EQ(std::filesystem::file_size(path_), size);
+}
+
+/**
+ * @given Sink to file with direct writing (or its fallback, if filesystem
+ * doesn't support it)
+ * @when Push events by several batches, then append more by another sink
+ * @then All records are written in order, size of file is size of records
+ */
+TEST_F(SinkToFileTest, DirectIO) {
+  constexpr size_t count = 3000;
+  for (size_t part = 0; part < 2; ++part) {
+    SinkToFile sink("file",
+                    Level::TRACE,
+                    path_,
+                    Sink::ThreadInfoType::NONE,  // ignore thread info
+                    256,                         // capacity: 256 events
+                    1024,                        // max message length: 1 Kb
+                    1u << 20,                    // buffers size: 1 Mb
+                    10000,                       // latency: 10 sec
+                    false,                       // without sequence
+                    0,                           // without render threads
+                    1,                           // single shard
+                    0,                           // without writeback
+                    0,                           // without preallocation
+                    true);                       // direct writing
+    for (size_t i = part * count / 2 + 1; i <= (part + 1) * count / 2; ++i) {
+      sink.push("logger", Level::INFO, "message {:0>{}}", i, i % 500);
+      if (i % 100 == 0) {
+        sink.flush();
+      }
+    }
+  }
+
+  std::ifstream in(path_);
+  std::string line;
+  size_t expected = 0;
+  size_t size = 0;
+  while (std::getline(in, line)) {
+    ++expected;
+    size += line.size() + 1;
+    const auto message =
+        fmt::format("message {:0>{}}", expected, expected % 500);
+    ASSERT_GE(line.size(), message.size());
+    EXPECT_EQ(line.substr(line.size() - message.size()), message);
+  }
+  EXPECT_EQ(expected, count);
+  EXPECT_EQ(std::filesystem::file_size(path_), size);
+}
+
+/**
+ * @given Sink to file with direct writing (or its fallback) and preallocation
+ * @when Push events by several batches
+ * @then After each batch size of file is size of records, and space is
+ * reserved beyond end of file; all records are written in order
+ */
+TEST_F(SinkToFileTest, DirectIOWithPreallocation) {
+  constexpr size_t count = 1000;
+  constexpr size_t preallocate_size = 65536;
+  {
+    SinkToFile sink("file",
+                    Level::TRACE,
+                    path_,
+                    Sink::ThreadInfoType::NONE,  // ignore thread info
+                    256,                         // capacity: 256 events
+                    1024,                        // max message length: 1 Kb
+                    1u << 20,                    // buffers size: 1 Mb
+                    10000,                       // latency: 10 sec
+                    false,                       // without sequence
+                    0,                           // without render threads
+                    1,                           // single shard
+                    0,                           // without writeback
+                    preallocate_size,            // preallocate: 64 Kb
+                    true);                       // direct writing
+    size_t size = 0;
+    for (size_t i = 1; i <= count; ++i) {
+      sink.push("logger", Level::INFO, "message {:0>{}}", i, i % 300);
+      if (i % 100 == 0) {
+        sink.flush();
+
+        std::ifstream in(path_);
+        std::string line;
+        size = 0;
+        while (std::getline(in, line)) {
+          size += line.size() + 1;
+        }
+        ASSERT_EQ(std::filesystem::file_size(path_), size);
+
+        struct stat st {};
+        ASSERT_EQ(::stat(path_.c_str(), &st), 0);
+        EXPECT_GE(static_cast<size_t>(st.st_blocks) * 512,
+                  size + preallocate_size);
+      }
+    }
+  }
+
+  std::ifstream in(path_);
+  std::string line;
+  size_t expected = 0;
+  size_t size = 0;
+  while (std::getline(in, line)) {
+    ++expected;
+    size += line.size() + 1;
+    const auto message =
+        fmt::format("message {:0>{}}", expected, expected % 300);
+    ASSERT_GE(line.size(), message.size());
+    EXPECT_EQ(line.substr(line.size() - message.size()), message);
+  }
+  EXPECT_EQ(expected, count);
+  EXPECT_EQ(std::filesystem::file_size(path_), size);
+}
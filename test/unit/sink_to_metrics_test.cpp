@@ -0,0 +1,242 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "soralog/impl/multisink.hpp"
+#include "soralog/impl/sink_to_metrics.hpp"
+#include "soralog/impl/thread_pool_executor.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+namespace {
+  uint64_t countOf(const std::vector<SinkToMetrics::Counter> &counters,
+                   std::string_view logger,
+                   Level level,
+                   std::string_view site) {
+    for (const auto &counter : counters) {
+      if (counter.logger == logger and counter.level == level
+          and counter.site == site) {
+        return counter.count;
+      }
+    }
+    return 0;
+  }
+}  // namespace
+
+/**
+ * @given Metrics sink
+ * @when Events of several loggers, levels and sites are pushed concurrently
+ * @then Each key is counted exactly, events above level are ignored
+ */
+TEST(SinkToMetricsTest, CountsByKey) {
+  SinkToMetrics sink("metrics", Level::DEBUG);
+
+  constexpr size_t threads_number = 4;
+  constexpr size_t count = 10000;
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threads_number; ++t) {
+    threads.emplace_back([&] {
+      for (size_t i = 0; i < count; ++i) {
+        sink.push("net", Level::ERROR, "Connection lost: {}", i);
+        sink.push("net", Level::INFO, "Connected to {}", i);
+        sink.push("db", Level::ERROR, "Connection lost: {}", i);
+        sink.push("db", Level::TRACE, "Ignored {}", i);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto counters = sink.counters();
+  EXPECT_EQ(counters.size(), 3);
+  EXPECT_EQ(
+      countOf(counters, "net", Level::ERROR, "Connection lost: {}"),
+      threads_number * count);
+  EXPECT_EQ(countOf(counters, "net", Level::INFO, "Connected to {}"),
+            threads_number * count);
+  EXPECT_EQ(countOf(counters, "db", Level::ERROR, "Connection lost: {}"),
+            threads_number * count);
+  EXPECT_EQ(sink.overflowed(), 0);
+
+  auto text = sink.render();
+  EXPECT_NE(text.find("# TYPE soralog_events_total counter"),
+            std::string::npos);
+  EXPECT_NE(text.find(R"(soralog_events_total{sink="metrics",logger="net",)"
+                      R"(level="info",site="Connected to {}"} 40000)"),
+            std::string::npos)
+      << text;
+}
+
+/**
+ * @given Metrics sink
+ * @when Events are pushed by string literal, precompiled format and formats
+ * made in runtime
+ * @then Literal and precompiled formats are sites, while all formats made in
+ * runtime are counted by one site
+ */
+TEST(SinkToMetricsTest, DynamicFormatsShareSite) {
+  SinkToMetrics sink("metrics", Level::TRACE);
+  for (int i = 0; i < 10; ++i) {
+    auto format = fmt::format("Request #{} is done in {{}} ms", i);
+    sink.push("logger", Level::INFO, format, i);
+    sink.push("logger", Level::INFO, std::string_view(format), i);
+    sink.push("logger", Level::INFO, "Request is done in {} ms", i);
+    sink.push("logger", Level::INFO, FMT_COMPILE("Request #{} is done"), i);
+  }
+
+  auto counters = sink.counters();
+  EXPECT_EQ(counters.size(), 3);
+  EXPECT_EQ(countOf(counters,
+                    "logger",
+                    Level::INFO,
+                    EventCounters::dynamic_site),
+            20);
+  EXPECT_EQ(
+      countOf(counters, "logger", Level::INFO, "Request is done in {} ms"), 10);
+  EXPECT_EQ(countOf(counters, "logger", Level::INFO, "Request #{} is done"),
+            10);
+}
+
+/**
+ * @given Metrics sink with table of 2 counters
+ * @when Events of 3 keys are pushed
+ * @then Events which don't fit are counted as overflowed
+ */
+TEST(SinkToMetricsTest, Overflow) {
+  SinkToMetrics sink("metrics", Level::TRACE, {}, {}, 2);
+  sink.push("a", Level::INFO, "a");
+  sink.push("b", Level::INFO, "b");
+  sink.push("c", Level::INFO, "c");
+  sink.push("c", Level::INFO, "c");
+  EXPECT_EQ(sink.counters().size(), 2);
+  EXPECT_EQ(sink.overflowed(), 2);
+}
+
+/**
+ * @given Broadcasting multisink with metrics sink and regular sink
+ * @when Events are pushed
+ * @then Metrics sink counts them without occupying shared buffer
+ */
+TEST(SinkToMetricsTest, Multisink) {
+  auto metrics = std::make_shared<SinkToMetrics>("metrics", Level::TRACE);
+  auto other = std::make_shared<SinkToMetrics>("other", Level::TRACE);
+  Multisink multisink("multi",
+                      Level::TRACE,
+                      {metrics, other},
+                      Multisink::LagPolicy::BLOCK,
+                      4);
+  EXPECT_TRUE(multisink.isDetached(0));
+  for (int i = 0; i < 100; ++i) {
+    multisink.push("logger", Level::INFO, "message {}", i);
+  }
+  EXPECT_EQ(countOf(metrics->counters(), "logger", Level::INFO, "message {}"),
+            100);
+  EXPECT_EQ(countOf(other->counters(), "logger", Level::INFO, "message {}"),
+            100);
+}
+
+/**
+ * @given Metrics sink with path
+ * @when Sink is flushed
+ * @then Counters are dumped into file
+ */
+TEST(SinkToMetricsTest, Dump) {
+  auto path = std::filesystem::temp_directory_path() / "soralog_test.prom";
+  {
+    SinkToMetrics sink("metrics", Level::TRACE, path, 0);
+    sink.push("logger", Level::WARN, "Low disk space");
+    sink.flush();
+  }
+  std::ifstream in(path);
+  std::stringstream ss;
+  ss << in.rdbuf();
+  EXPECT_NE(ss.str().find(R"(level="warning",site="Low disk space"} 1)"),
+            std::string::npos)
+      << ss.str();
+  std::filesystem::remove(path);
+}
+
+/**
+ * @given Metrics sink with path and period, created while executor is set
+ * @when Event is pushed and period passes
+ * @then Sink has no own thread; counters are dumped by task of executor
+ */
+TEST(SinkToMetricsTest, DumpByExecutor) {
+  auto path = std::filesystem::temp_directory_path() / "soralog_test.prom";
+  std::filesystem::remove(path);
+  auto executor = std::make_shared<ThreadPoolExecutor>("test");
+  std::filesystem::directory_iterator tasks("/proc/self/task");
+  const auto threads = std::distance(begin(tasks), end(tasks));
+
+  std::string dump;
+  {
+    std::unique_ptr<SinkToMetrics> sink;
+    {
+      Executor::Scope scope(executor);
+      sink = std::make_unique<SinkToMetrics>(
+          "metrics", Level::TRACE, path, 10);  // period: 10 ms
+    }
+    tasks = std::filesystem::directory_iterator("/proc/self/task");
+    EXPECT_EQ(std::distance(begin(tasks), end(tasks)), threads);
+
+    sink->push("logger", Level::WARN, "Low disk space");
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (dump.find("Low disk space") == std::string::npos
+           and std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(5ms);
+      std::ifstream in(path);
+      std::stringstream ss;
+      ss << in.rdbuf();
+      dump = ss.str();
+    }
+  }
+  EXPECT_NE(dump.find(R"(level="warning",site="Low disk space"} 1)"),
+            std::string::npos)
+      << dump;
+  std::filesystem::remove(path);
+}
+
+/**
+ * @given Metrics sink with path and short period
+ * @when Counters are dumped, file is removed, and time passes without events
+ * @then Unchanged counters are not dumped again, until the next event or
+ * rotation
+ */
+TEST(SinkToMetricsTest, SkipUnchangedDump) {
+  auto path = std::filesystem::temp_directory_path() / "soralog_test.prom";
+  std::filesystem::remove(path);
+  {
+    SinkToMetrics sink("metrics", Level::TRACE, path, 10);  // period: 10 ms
+    sink.push("logger", Level::WARN, "Low disk space");
+    sink.flush();
+    ASSERT_TRUE(std::filesystem::exists(path));
+
+    std::filesystem::remove(path);
+    std::this_thread::sleep_for(50ms);
+    sink.flush();
+    EXPECT_FALSE(std::filesystem::exists(path));
+
+    sink.rotate();
+    EXPECT_TRUE(std::filesystem::exists(path));
+
+    std::filesystem::remove(path);
+    sink.push("logger", Level::WARN, "Low disk space");
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (not std::filesystem::exists(path)
+           and std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(5ms);
+    }
+    EXPECT_TRUE(std::filesystem::exists(path));
+  }
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,371 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <sstream>
+
+#include "soralog/impl/sink_to_network.hpp"
+#include "soralog/impl/thread_pool_executor.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+class SinkToNetworkTest : public ::testing::Test {
+ public:
+  void TearDown() override {
+    if (server_ != -1) {
+      close(server_);
+    }
+    if (connection_ != -1) {
+      close(connection_);
+    }
+    if (spool_path_) {
+      std::filesystem::remove(*spool_path_);
+    }
+  }
+
+  /**
+   * Opens server socket on loopback interface
+   * @returns port
+   */
+  uint16_t listen(int type, uint16_t port = 0) {
+    server_ = socket(AF_INET, type, 0);
+    int on = 1;
+    setsockopt(server_, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    EXPECT_EQ(bind(server_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)),
+              0);
+    socklen_t len = sizeof(addr);
+    getsockname(server_, reinterpret_cast<sockaddr *>(&addr), &len);
+    if (type == SOCK_STREAM) {
+      EXPECT_EQ(::listen(server_, 1), 0);
+    }
+    timeval timeout{2, 0};
+    setsockopt(server_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    return ntohs(addr.sin_port);
+  }
+
+  /**
+   * Reads TCP frames until {@param count} lines are got
+   * @returns received lines
+   */
+  std::vector<std::string> receiveFrames(size_t count) {
+    if (connection_ == -1) {
+      connection_ = accept(server_, nullptr, nullptr);
+      EXPECT_NE(connection_, -1);
+      timeval timeout{2, 0};
+      setsockopt(
+          connection_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    }
+    std::vector<std::string> lines;
+    while (lines.size() < count) {
+      std::array<unsigned char, 4> header{};
+      if (not receive(header.data(), header.size())) {
+        break;
+      }
+      size_t size = (header[0] << 24) | (header[1] << 16) | (header[2] << 8)
+                  | header[3];
+      std::string payload(size, '\0');
+      if (not receive(payload.data(), size)) {
+        break;
+      }
+      EXPECT_EQ(payload.back(), '\n');
+      split(payload, lines);
+    }
+    return lines;
+  }
+
+  /**
+   * Reads datagrams until {@param count} lines are got
+   * @returns received lines
+   */
+  std::vector<std::string> receiveDatagrams(size_t count,
+                                            size_t max_datagram_size) {
+    std::vector<std::string> lines;
+    while (lines.size() < count) {
+      std::string datagram(65536, '\0');
+      auto size = recv(server_, datagram.data(), datagram.size(), 0);
+      if (size <= 0) {
+        break;
+      }
+      EXPECT_LE(size, max_datagram_size);
+      datagram.resize(size);
+      EXPECT_EQ(datagram.back(), '\n');
+      split(datagram, lines);
+    }
+    return lines;
+  }
+
+  static void split(const std::string &data, std::vector<std::string> &lines) {
+    std::istringstream stream(data);
+    std::string line;
+    while (std::getline(stream, line)) {
+      lines.emplace_back(std::move(line));
+    }
+  }
+
+  bool receive(void *data, size_t size) {
+    auto *ptr = static_cast<char *>(data);
+    while (size != 0) {
+      auto res = recv(connection_, ptr, size, 0);
+      if (res <= 0) {
+        return false;
+      }
+      ptr += res;
+      size -= res;
+    }
+    return true;
+  }
+
+  /**
+   * @returns number of threads of this process
+   */
+  static size_t threadCount() {
+    std::filesystem::directory_iterator tasks("/proc/self/task");
+    return std::distance(begin(tasks), end(tasks));
+  }
+
+  static bool endsWith(const std::string &line, const std::string &suffix) {
+    return line.size() >= suffix.size()
+       and line.compare(line.size() - suffix.size(), suffix.size(), suffix)
+               == 0;
+  }
+
+  int server_ = -1;
+  int connection_ = -1;
+  std::optional<std::filesystem::path> spool_path_;
+};
+
+/**
+ * @given Sink to TCP collector
+ * @when Push messages
+ * @then Collector gets all of them in length-prefixed frames in the same order
+ */
+TEST_F(SinkToNetworkTest, TcpFrames) {
+  auto port = listen(SOCK_STREAM);
+  auto sink = std::make_shared<SinkToNetwork>("network",
+                                              Level::TRACE,
+                                              SinkToNetwork::Protocol::TCP,
+                                              "127.0.0.1",
+                                              port,
+                                              Sink::ThreadInfoType::NONE,
+                                              16,   // capacity: 16 events
+                                              64,   // max message length
+                                              256,  // buffers size: 256 b
+                                              10);  // latency: 10 ms
+
+  for (int i = 1; i <= 20; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+
+  auto lines = receiveFrames(20);
+  ASSERT_EQ(lines.size(), 20);
+  for (int i = 1; i <= 20; ++i) {
+    EXPECT_TRUE(endsWith(lines[i - 1], fmt::format("message #{}", i)))
+        << lines[i - 1];
+  }
+  EXPECT_TRUE(sink->isConnected());
+  EXPECT_EQ(sink->dropped(), 0);
+}
+
+/**
+ * @given Sink to TCP collector without latency
+ * @when Push messages right after creation, before connection is established
+ * @then Producer isn't blocked by connecting; messages are kept and sent by
+ * worker after it connects, and later ones are sent by producer at once
+ */
+TEST_F(SinkToNetworkTest, NoLatencyConnectsByWorker) {
+  auto port = listen(SOCK_STREAM);
+  auto sink = std::make_shared<SinkToNetwork>("network",
+                                              Level::TRACE,
+                                              SinkToNetwork::Protocol::TCP,
+                                              "127.0.0.1",
+                                              port,
+                                              Sink::ThreadInfoType::NONE,
+                                              16,   // capacity: 16 events
+                                              64,   // max message length
+                                              256,  // buffers size: 256 b
+                                              0);   // latency: none
+
+  for (int i = 1; i <= 5; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+  auto lines = receiveFrames(5);
+  ASSERT_EQ(lines.size(), 5);
+  EXPECT_TRUE(sink->isConnected());
+
+  sink->push("logger", Level::INFO, "message #{}", 6);
+  lines = receiveFrames(1);
+  ASSERT_EQ(lines.size(), 1);
+  EXPECT_TRUE(endsWith(lines[0], "message #6")) << lines[0];
+  EXPECT_EQ(sink->dropped(), 0);
+}
+
+/**
+ * @given Sink to UDP collector with small datagram size
+ * @when Push messages
+ * @then Collector gets them by datagrams with whole lines within size limit
+ */
+TEST_F(SinkToNetworkTest, UdpDatagrams) {
+  auto port = listen(SOCK_DGRAM);
+  auto sink = std::make_shared<SinkToNetwork>("network",
+                                              Level::TRACE,
+                                              SinkToNetwork::Protocol::UDP,
+                                              "127.0.0.1",
+                                              port,
+                                              Sink::ThreadInfoType::NONE,
+                                              16,            // capacity: 16 events
+                                              64,            // max message length
+                                              4096,          // buffers size: 4 Kb
+                                              10,            // latency: 10 ms
+                                              std::nullopt,  // pending
+                                              256);          // datagram: 256 b
+
+  for (int i = 1; i <= 20; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+
+  auto lines = receiveDatagrams(20, 256);
+  ASSERT_EQ(lines.size(), 20);
+  for (int i = 1; i <= 20; ++i) {
+    EXPECT_TRUE(endsWith(lines[i - 1], fmt::format("message #{}", i)))
+        << lines[i - 1];
+  }
+}
+
+/**
+ * @given Sink to TCP collector, which is not available yet
+ * @when Push messages, which exceed pending limit, and start collector then
+ * @then Sink connects; collector gets spooled and pending data in order
+ */
+TEST_F(SinkToNetworkTest, ReconnectAndReplaySpool) {
+  // Find free port
+  auto port = listen(SOCK_STREAM);
+  close(server_);
+  server_ = -1;
+
+  spool_path_ = std::filesystem::temp_directory_path()
+              / ("soralog_spool_" + std::to_string(getpid()));
+  std::filesystem::remove(*spool_path_);
+
+  auto sink = std::make_shared<SinkToNetwork>("network",
+                                              Level::TRACE,
+                                              SinkToNetwork::Protocol::TCP,
+                                              "127.0.0.1",
+                                              port,
+                                              Sink::ThreadInfoType::NONE,
+                                              16,            // capacity: 16 events
+                                              64,            // max message length
+                                              256,           // buffers size: 256 b
+                                              10,            // latency: 10 ms
+                                              512,           // pending: 512 b
+                                              std::nullopt,  // datagram
+                                              spool_path_);
+
+  for (int i = 1; i <= 50; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+  std::this_thread::sleep_for(50ms);
+  EXPECT_FALSE(sink->isConnected());
+  EXPECT_GT(std::filesystem::file_size(*spool_path_), 0);
+
+  listen(SOCK_STREAM, port);
+
+  auto lines = receiveFrames(50);
+  ASSERT_EQ(lines.size(), 50);
+  for (int i = 1; i <= 50; ++i) {
+    EXPECT_TRUE(endsWith(lines[i - 1], fmt::format("message #{}", i)))
+        << lines[i - 1];
+  }
+  EXPECT_TRUE(sink->isConnected());
+  EXPECT_EQ(sink->dropped(), 0);
+}
+
+/**
+ * @given Sink to TCP collector with rendering of sequence numbers
+ * @when Push messages
+ * @then Each line has sequence number of event
+ */
+TEST_F(SinkToNetworkTest, SequenceNumbers) {
+  auto port = listen(SOCK_STREAM);
+  auto sink = std::make_shared<SinkToNetwork>("network",
+                                              Level::TRACE,
+                                              SinkToNetwork::Protocol::TCP,
+                                              "127.0.0.1",
+                                              port,
+                                              Sink::ThreadInfoType::NONE,
+                                              16,            // capacity
+                                              64,            // max length
+                                              256,           // buffers size
+                                              10,            // latency
+                                              std::nullopt,  // pending
+                                              std::nullopt,  // datagram
+                                              std::nullopt,  // spool
+                                              true);         // sequence
+
+  for (int i = 1; i <= 5; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+
+  auto lines = receiveFrames(5);
+  ASSERT_EQ(lines.size(), 5);
+  for (int i = 1; i <= 5; ++i) {
+    EXPECT_NE(lines[i - 1].find(fmt::format("  #0.{:<6}  ", i)),
+              std::string::npos)
+        << lines[i - 1];
+  }
+  EXPECT_EQ(sink->lastSequence(), 5);
+}
+
+/**
+ * @given Sink to TCP collector created while executor is set
+ * @when Push messages
+ * @then Sink has no own thread; collector gets all of them sent by tasks of
+ * executor
+ */
+TEST_F(SinkToNetworkTest, Executor) {
+  auto port = listen(SOCK_STREAM);
+  auto executor = std::make_shared<ThreadPoolExecutor>("test");
+  const auto threads = threadCount();
+
+  std::shared_ptr<SinkToNetwork> sink;
+  {
+    Executor::Scope scope(executor);
+    sink = std::make_shared<SinkToNetwork>("network",
+                                           Level::TRACE,
+                                           SinkToNetwork::Protocol::TCP,
+                                           "127.0.0.1",
+                                           port,
+                                           Sink::ThreadInfoType::NONE,
+                                           16,   // capacity: 16 events
+                                           64,   // max message length
+                                           256,  // buffers size: 256 b
+                                           10);  // latency: 10 ms
+  }
+  EXPECT_EQ(threadCount(), threads);
+
+  for (int i = 1; i <= 20; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+
+  auto lines = receiveFrames(20);
+  ASSERT_EQ(lines.size(), 20);
+  for (int i = 1; i <= 20; ++i) {
+    EXPECT_TRUE(endsWith(lines[i - 1], fmt::format("message #{}", i)))
+        << lines[i - 1];
+  }
+  sink.reset();
+}
@@ -0,0 +1,351 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <array>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#include "soralog/impl/sink_to_otlp.hpp"
+#include "soralog/impl/thread_pool_executor.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+/**
+ * Minimal HTTP server standing in for OTLP collector
+ */
+class CollectorMock {
+ public:
+  explicit CollectorMock(int status) : status_(status) {
+    server_ = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bind(server_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+    socklen_t len = sizeof(addr);
+    getsockname(server_, reinterpret_cast<sockaddr *>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    listen(server_, 1);
+    thread_ = std::thread([this] { run(); });
+  }
+
+  ~CollectorMock() {
+    shutdown(server_, SHUT_RDWR);
+    close(server_);
+    thread_.join();
+  }
+
+  uint16_t port() const {
+    return port_;
+  }
+
+  std::vector<std::string> bodies() {
+    std::lock_guard lock(mutex_);
+    return bodies_;
+  }
+
+  std::vector<std::string> headers() {
+    std::lock_guard lock(mutex_);
+    return headers_;
+  }
+
+ private:
+  void run() {
+    while (true) {
+      int connection = accept(server_, nullptr, nullptr);
+      if (connection == -1) {
+        return;
+      }
+      while (serve(connection)) {
+      }
+      close(connection);
+    }
+  }
+
+  bool serve(int connection) {
+    std::string data;
+    std::array<char, 4096> chunk{};
+    size_t header_end = std::string::npos;
+    while (header_end == std::string::npos) {
+      auto res = recv(connection, chunk.data(), chunk.size(), 0);
+      if (res <= 0) {
+        return false;
+      }
+      data.append(chunk.data(), res);
+      header_end = data.find("\r\n\r\n");
+    }
+    auto header = data.substr(0, header_end);
+    auto pos = header.find("Content-Length: ");
+    size_t length = std::stoul(header.substr(pos + 16));
+    while (data.size() < header_end + 4 + length) {
+      auto res = recv(connection, chunk.data(), chunk.size(), 0);
+      if (res <= 0) {
+        return false;
+      }
+      data.append(chunk.data(), res);
+    }
+    auto body = data.substr(header_end + 4, length);
+    if (header.find("Content-Encoding: gzip") != std::string::npos) {
+      body = gunzip(body);
+    }
+    {
+      std::lock_guard lock(mutex_);
+      headers_.emplace_back(std::move(header));
+      bodies_.emplace_back(std::move(body));
+    }
+    auto response = fmt::format(
+        "HTTP/1.1 {} Status\r\nContent-Length: 2\r\n\r\n{{}}", status_);
+    send(connection, response.data(), response.size(), MSG_NOSIGNAL);
+    return true;
+  }
+
+  static std::string gunzip(const std::string &data) {
+    z_stream stream{};
+    inflateInit2(&stream, 15 + 16);
+    std::string result(1u << 20, '\0');
+    stream.next_in =
+        reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef *>(result.data());
+    stream.avail_out = result.size();
+    inflate(&stream, Z_FINISH);
+    result.resize(stream.total_out);
+    inflateEnd(&stream);
+    return result;
+  }
+
+  int status_;
+  int server_;
+  uint16_t port_;
+  std::thread thread_;
+  std::mutex mutex_;
+  std::vector<std::string> headers_;
+  std::vector<std::string> bodies_;
+};
+
+/**
+ * @given Sink to OTLP collector with gzip compression
+ * @when Push messages of different loggers and levels
+ * @then Collector gets compressed OTLP/JSON with records grouped by scopes;
+ * logger name, thread and number of event are attributes of record
+ */
+TEST(SinkToOtlpTest, ExportRecords) {
+  CollectorMock collector(200);
+  {
+    auto endpoint =
+        fmt::format("http://127.0.0.1:{}/v1/logs", collector.port());
+    SinkToOtlp sink("otlp",
+                    Level::TRACE,
+                    endpoint,
+                    Sink::ThreadInfoType::ID,
+                    16,       // capacity: 16 events
+                    64,       // max message length: 64 byte
+                    16384,    // buffers size: 16 Kb
+                    10,       // latency: 10 ms
+                    true,     // compression
+                    "test");  // service name
+
+    sink.push("first", Level::INFO, "message \"{}\"", 1);
+    sink.push("second", Level::ERROR, "message {}", 2);
+    sink.push("first", Level::CRITICAL, "message {}", 3);
+  }
+
+  auto headers = collector.headers();
+  auto bodies = collector.bodies();
+  ASSERT_FALSE(bodies.empty());
+  EXPECT_EQ(headers[0].find("POST /v1/logs HTTP/1.1"), 0);
+  EXPECT_NE(headers[0].find("Content-Type: application/json"),
+            std::string::npos);
+
+  std::string all;
+  for (auto &body : bodies) {
+    EXPECT_EQ(body.find(R"({"resourceLogs":[)"), 0) << body;
+    all += body;
+  }
+  EXPECT_NE(all.find(R"("key":"service.name","value":{"stringValue":"test"})"),
+            std::string::npos);
+  EXPECT_NE(all.find(R"("scope":{"name":"first"})"), std::string::npos);
+  EXPECT_NE(all.find(R"("scope":{"name":"second"})"), std::string::npos);
+  EXPECT_NE(all.find(R"("severityNumber":9,"severityText":"Info",)"
+                     R"("body":{"stringValue":"message \"1\""})"),
+            std::string::npos)
+      << all;
+  EXPECT_NE(all.find(R"("severityNumber":17,)"), std::string::npos);
+  EXPECT_NE(all.find(R"("severityNumber":21,)"), std::string::npos);
+  auto thread_attribute = fmt::format(
+      R"("key":"thread.id","value":{{"intValue":"{}"}})",
+      util::getThreadNumber());
+  EXPECT_NE(all.find(thread_attribute), std::string::npos);
+  EXPECT_NE(all.find(R"("attributes":[{"key":"logger.name",)"
+                     R"("value":{"stringValue":"second"}})"),
+            std::string::npos)
+      << all;
+  // Errors are numbered in urgent lane
+  for (auto [lane, sequence] : {std::pair{0, 1}, {1, 1}, {1, 2}}) {
+    EXPECT_NE(all.find(fmt::format(
+                  R"({{"key":"soralog.lane","value":{{"intValue":"{}"}}}},)"
+                  R"({{"key":"soralog.sequence","value":)"
+                  R"({{"intValue":"{}"}}}}]}})",
+                  lane,
+                  sequence)),
+              std::string::npos)
+        << all;
+  }
+}
+
+/**
+ * @given Levels of soralog
+ * @when Map them to OTLP severity numbers
+ * @then Order of severities is kept; verbose is between debug and info
+ */
+TEST(SinkToOtlpTest, SeverityOrder) {
+  const std::array levels{Level::TRACE,
+                          Level::DEBUG,
+                          Level::VERBOSE,
+                          Level::INFO,
+                          Level::WARN,
+                          Level::ERROR,
+                          Level::CRITICAL};
+  for (size_t i = 1; i < levels.size(); ++i) {
+    EXPECT_LT(SinkToOtlp::severityNumber(levels[i - 1]),
+              SinkToOtlp::severityNumber(levels[i]));
+  }
+  EXPECT_EQ(SinkToOtlp::severityNumber(Level::VERBOSE), 8);  // DEBUG4
+}
+
+/**
+ * @given Sink to OTLP collector, which rejects requests
+ * @when Push messages
+ * @then Records are counted as dropped
+ */
+TEST(SinkToOtlpTest, RejectedExport) {
+  CollectorMock collector(503);
+  SinkToOtlp sink("otlp",
+                  Level::TRACE,
+                  fmt::format("http://127.0.0.1:{}", collector.port()),
+                  Sink::ThreadInfoType::NONE,
+                  16,      // capacity: 16 events
+                  64,      // max message length: 64 byte
+                  16384,   // buffers size: 16 Kb
+                  0,       // latency: 0 ms
+                  false);  // compression
+
+  sink.push("logger", Level::INFO, "message");
+  sink.push("logger", Level::INFO, "message");
+
+  // Export is done by worker
+  auto deadline = std::chrono::steady_clock::now() + 1s;
+  while (sink.dropped() < 2 and std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(1ms);
+  }
+  EXPECT_EQ(sink.exported(), 0);
+  EXPECT_EQ(sink.dropped(), 2);
+  ASSERT_EQ(collector.bodies().size(), 2);
+  EXPECT_EQ(collector.headers()[0].find("Content-Encoding"), std::string::npos);
+}
+
+/**
+ * @given Sink to OTLP collector without latency, which doesn't respond
+ * @when Push critical message (i.e. flush by producer)
+ * @then Producer doesn't wait for collector
+ */
+TEST(SinkToOtlpTest, ProducerDoesNotWaitForExport) {
+  // Connections are accepted by backlog, but requests are never answered
+  int server = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  bind(server, reinterpret_cast<sockaddr *>(&addr), sizeof(addr));
+  socklen_t len = sizeof(addr);
+  getsockname(server, reinterpret_cast<sockaddr *>(&addr), &len);
+  listen(server, 1);
+
+  {
+    SinkToOtlp sink("otlp",
+                    Level::TRACE,
+                    fmt::format("http://127.0.0.1:{}", ntohs(addr.sin_port)),
+                    Sink::ThreadInfoType::NONE,
+                    16,      // capacity: 16 events
+                    64,      // max message length: 64 byte
+                    16384,   // buffers size: 16 Kb
+                    0,       // latency: 0 ms
+                    false);  // compression
+
+    auto start = std::chrono::steady_clock::now();
+    sink.push("logger", Level::CRITICAL, "message");
+    sink.flush();
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+
+    // Pending request fails at once
+    close(server);
+  }
+}
+
+/**
+ * @given Sink to OTLP collector created while executor is set
+ * @when Push message
+ * @then Sink has no own thread; record is exported by task of executor
+ */
+TEST(SinkToOtlpTest, Executor) {
+  CollectorMock collector(200);
+  auto executor = std::make_shared<ThreadPoolExecutor>("test");
+  std::filesystem::directory_iterator tasks("/proc/self/task");
+  const auto threads = std::distance(begin(tasks), end(tasks));
+  {
+    std::unique_ptr<SinkToOtlp> sink;
+    {
+      Executor::Scope scope(executor);
+      sink = std::make_unique<SinkToOtlp>(
+          "otlp",
+          Level::TRACE,
+          fmt::format("http://127.0.0.1:{}", collector.port()),
+          Sink::ThreadInfoType::NONE,
+          16,      // capacity: 16 events
+          64,      // max message length: 64 byte
+          16384,   // buffers size: 16 Kb
+          10,      // latency: 10 ms
+          false);  // compression
+    }
+    tasks = std::filesystem::directory_iterator("/proc/self/task");
+    EXPECT_EQ(std::distance(begin(tasks), end(tasks)), threads);
+
+    sink->push("logger", Level::INFO, "message");
+    auto deadline = std::chrono::steady_clock::now() + 1s;
+    while (sink->exported() == 0
+           and std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(sink->exported(), 1);
+  }
+
+  auto bodies = collector.bodies();
+  ASSERT_EQ(bodies.size(), 1);
+  EXPECT_NE(bodies[0].find(R"("body":{"stringValue":"message"})"),
+            std::string::npos)
+      << bodies[0];
+}
+
+/**
+ * @given Malformed endpoint
+ * @when Create sink
+ * @then Exception is thrown
+ */
+TEST(SinkToOtlpTest, WrongEndpoint) {
+  EXPECT_THROW(SinkToOtlp("otlp", Level::TRACE, "https://127.0.0.1"),
+               std::invalid_argument);
+  EXPECT_THROW(SinkToOtlp("otlp", Level::TRACE, "http://127.0.0.1:port"),
+               std::invalid_argument);
+}
@@ -0,0 +1,344 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <array>
+#include <map>
+
+#include "soralog/impl/sink_to_shared_memory.hpp"
+
+using namespace soralog;
+using namespace testing;
+using namespace std::chrono_literals;
+
+class SinkToSharedMemoryTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    segment_ = "soralog_test_" + std::to_string(getpid());
+    SharedMemoryRing::unlink(segment_);
+  }
+  void TearDown() override {
+    SharedMemoryRing::unlink(segment_);
+  }
+
+  std::shared_ptr<SinkToSharedMemory> createSink(
+      std::chrono::milliseconds latency, size_t segment_capacity) {
+    return std::make_shared<SinkToSharedMemory>(
+        "shm",
+        Level::TRACE,
+        segment_,
+        Sink::ThreadInfoType::ID,  // thread number
+        4,                         // capacity: 4 events
+        64,                        // max message length: 64 byte
+        16384,                     // buffers size: 16 Kb
+        latency.count(),
+        segment_capacity);
+  }
+
+  std::string segment_;
+};
+
+/**
+ * @given Sink to shared memory segment
+ * @when Push messages and flush sink
+ * @then Consumer attached to segment gets all records in the same order
+ */
+TEST_F(SinkToSharedMemoryTest, PassRecordsToConsumer) {
+  auto sink = createSink(0ms, 16);
+  ASSERT_TRUE(sink->ring());
+
+  SharedMemoryRing consumer(segment_);
+  EXPECT_EQ(consumer.capacity(), 16);
+  EXPECT_EQ(consumer.maxMessageLength(), 64);
+
+  for (int i = 1; i <= 10; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+  sink->flush();
+
+  for (int i = 1; i <= 10; ++i) {
+    auto record = consumer.get();
+    ASSERT_TRUE(record);
+    EXPECT_EQ(record->level, Level::INFO);
+    EXPECT_EQ(record->loggerName(), "logger");
+    EXPECT_EQ(record->thread_number, util::getThreadNumber());
+    EXPECT_EQ(record->sequence, i);
+    EXPECT_EQ(record.message(), fmt::format("message #{}", i));
+  }
+  EXPECT_FALSE(consumer.get());
+  EXPECT_EQ(consumer.dropped(), 0);
+}
+
+/**
+ * @given Sink to shared memory segment without consumer
+ * @when Push more messages than segment can hold
+ * @then Exceeding records are dropped and counted, logging is not blocked,
+ * numbers of dropped records are skipped in sequence
+ */
+TEST_F(SinkToSharedMemoryTest, DropWhenFull) {
+  auto sink = createSink(0ms, 8);
+  ASSERT_TRUE(sink->ring());
+
+  for (int i = 1; i <= 20; ++i) {
+    sink->push("logger", Level::INFO, "message #{}", i);
+  }
+  sink->flush();
+
+  EXPECT_EQ(sink->ring()->size(), 8);
+  EXPECT_EQ(sink->ring()->dropped(), 12);
+  EXPECT_EQ(sink->lastSequence(), 20);
+
+  SharedMemoryRing consumer(segment_);
+  for (int i = 1; i <= 8; ++i) {
+    auto record = consumer.get();
+    ASSERT_TRUE(record);
+    EXPECT_EQ(record->sequence, i);
+    EXPECT_EQ(record.message(), fmt::format("message #{}", i));
+  }
+  EXPECT_FALSE(consumer.get());
+
+  // Dropped records are seen as gap in sequence
+  sink->push("logger", Level::INFO, "message #{}", 21);
+  sink->flush();
+  auto record = consumer.get();
+  ASSERT_TRUE(record);
+  EXPECT_EQ(record->sequence, 21);
+}
+
+/**
+ * @given Sink to shared memory segment configured with large latency
+ * @when Push events of different levels without flush
+ * @then Each record is in segment as soon as push returns, in order
+ */
+TEST_F(SinkToSharedMemoryTest, PublishedByPush) {
+  auto sink = createSink(1000ms, 16);
+  ASSERT_TRUE(sink->ring());
+
+  SharedMemoryRing consumer(segment_);
+  const std::array levels{Level::DEBUG, Level::ERROR, Level::INFO};
+  for (size_t i = 0; i < levels.size(); ++i) {
+    sink->push("logger", levels[i], "message #{}", i + 1);
+    auto record = consumer.get();
+    ASSERT_TRUE(record);
+    EXPECT_EQ(record->sequence, i + 1);
+    EXPECT_EQ(record->level, levels[i]);
+    EXPECT_EQ(record.message(), fmt::format("message #{}", i + 1));
+  }
+  EXPECT_FALSE(consumer.get());
+}
+
+/**
+ * @given Process with sink to shared memory segment
+ * @when Process crashes right after push, without flush and destructors
+ * @then Records stay in segment and could be read afterward
+ */
+TEST_F(SinkToSharedMemoryTest, RecordsOutliveCrash) {
+  auto child = fork();
+  ASSERT_NE(child, -1);
+  if (child == 0) {
+    auto sink = createSink(1000ms, 16);
+    sink->push("logger", Level::INFO, "message");
+    sink->push("logger", Level::WARN, "last words");
+    _exit(sink->ring() ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), EXIT_SUCCESS);
+
+  SharedMemoryRing consumer(segment_);
+  EXPECT_TRUE(consumer.get());
+  auto record = consumer.get();
+  ASSERT_TRUE(record);
+  EXPECT_EQ(record->level, Level::WARN);
+  EXPECT_EQ(record.message(), "last words");
+}
+
+/**
+ * @given Two processes with sinks to the same segment
+ * @when Both processes push messages
+ * @then Consumer gets records of both processes tagged by their pids
+ */
+TEST_F(SinkToSharedMemoryTest, MultipleProcesses) {
+  auto sink = createSink(0ms, 64);
+  ASSERT_TRUE(sink->ring());
+
+  auto child = fork();
+  ASSERT_NE(child, -1);
+  if (child == 0) {
+    auto child_sink = createSink(0ms, 64);
+    for (int i = 1; i <= 10; ++i) {
+      child_sink->push("child", Level::INFO, "message #{}", i);
+    }
+    child_sink->flush();
+    _exit(child_sink->ring() ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  for (int i = 1; i <= 10; ++i) {
+    sink->push("parent", Level::INFO, "message #{}", i);
+  }
+  sink->flush();
+
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), EXIT_SUCCESS);
+
+  SharedMemoryRing consumer(segment_);
+  std::map<uint32_t, int> counters;
+  while (auto record = consumer.get()) {
+    auto &counter = counters[record->pid];
+    ++counter;
+    EXPECT_EQ(record->loggerName(),
+              record->pid == static_cast<uint32_t>(getpid()) ? "parent"
+                                                             : "child");
+    EXPECT_EQ(record.message(), fmt::format("message #{}", counter));
+  }
+  EXPECT_EQ(counters.size(), 2);
+  EXPECT_EQ(counters[getpid()], 10);
+  EXPECT_EQ(counters[child], 10);
+
+  // Nothing is stalled
+  EXPECT_FALSE(consumer.skipAbandoned());
+  EXPECT_FALSE(consumer.stalledBy(0ms));
+  EXPECT_EQ(consumer.abandoned(), 0);
+}
+
+/**
+ * @given Ring with slot captured by live producer, which is slow to publish
+ * @when Consumer finds nothing to get and checks for abandoned slot
+ * @then Slot isn't skipped, but stall is reported; record published later is
+ * got as usual
+ */
+TEST_F(SinkToSharedMemoryTest, StalledByLiveProducer) {
+  SharedMemoryRing producer(segment_, 16, 64);
+  auto claim = producer.claim();
+  ASSERT_TRUE(claim);
+
+  SharedMemoryRing consumer(segment_);
+  EXPECT_FALSE(consumer.get());
+  EXPECT_FALSE(consumer.skipAbandoned());
+  EXPECT_FALSE(consumer.stalledBy(1h));
+  EXPECT_EQ(consumer.stalledBy(0ms), static_cast<uint32_t>(getpid()));
+  EXPECT_EQ(consumer.abandoned(), 0);
+
+  claim.record->sequence = 1;
+  claim.record->message_size = 0;
+  EXPECT_TRUE(producer.publish(claim));
+  auto record = consumer.get();
+  ASSERT_TRUE(record);
+  EXPECT_EQ(record->sequence, 1);
+  EXPECT_FALSE(consumer.skipAbandoned());
+  EXPECT_FALSE(consumer.stalledBy(0ms));
+}
+
+/**
+ * @given Ring with slot captured by producer, which crashed before publishing
+ * of record, and record published after that slot
+ * @when Consumer finds nothing to get and checks for abandoned slot
+ * @then Slot is skipped and counted, so the next record is got
+ */
+TEST_F(SinkToSharedMemoryTest, SkipAbandonedByCrashedProducer) {
+  auto child = fork();
+  ASSERT_NE(child, -1);
+  if (child == 0) {
+    SharedMemoryRing producer(segment_, 16, 64);
+    auto abandoned = producer.claim();
+    auto claim = producer.claim();
+    if (not abandoned or not claim) {
+      _exit(EXIT_FAILURE);
+    }
+    claim.record->sequence = 2;
+    claim.record->message_size = 0;
+    _exit(producer.publish(claim) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  ASSERT_EQ(WEXITSTATUS(status), EXIT_SUCCESS);
+
+  SharedMemoryRing consumer(segment_);
+  EXPECT_FALSE(consumer.get());
+  EXPECT_TRUE(consumer.skipAbandoned());
+  EXPECT_EQ(consumer.abandoned(), 1);
+  auto record = consumer.get();
+  ASSERT_TRUE(record);
+  EXPECT_EQ(record->sequence, 2);
+}
+
+/**
+ * @given Ring with slot captured by live producer in other process
+ * @when Producer is killed before publishing of record, and other producer
+ * publishes record after that slot
+ * @then Slot isn't skipped while producer is alive; after its death slot is
+ * skipped and counted, so record of other producer is got
+ */
+TEST_F(SinkToSharedMemoryTest, SkipSlotOfKilledProducer) {
+  std::array<int, 2> pipe_fds{};
+  ASSERT_EQ(pipe(pipe_fds.data()), 0);
+
+  auto child = fork();
+  ASSERT_NE(child, -1);
+  if (child == 0) {
+    SharedMemoryRing producer(segment_, 16, 64);
+    auto claim = producer.claim();
+    char ready = claim ? 1 : 0;
+    [[maybe_unused]] auto written = write(pipe_fds[1], &ready, 1);
+    // Waits to be killed; exits by itself, if test fails before that
+    sleep(60);
+    _exit(EXIT_FAILURE);
+  }
+
+  char ready = 0;
+  ASSERT_EQ(read(pipe_fds[0], &ready, 1), 1);
+  close(pipe_fds[0]);
+  close(pipe_fds[1]);
+  ASSERT_EQ(ready, 1);
+
+  SharedMemoryRing consumer(segment_);
+  EXPECT_FALSE(consumer.get());
+  EXPECT_FALSE(consumer.skipAbandoned());
+  EXPECT_EQ(consumer.stalledBy(0ms), static_cast<uint32_t>(child));
+
+  ASSERT_EQ(kill(child, SIGKILL), 0);
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFSIGNALED(status));
+
+  SharedMemoryRing producer(segment_);
+  auto claim = producer.claim();
+  ASSERT_TRUE(claim);
+  claim.record->sequence = 2;
+  claim.record->message_size = 0;
+  ASSERT_TRUE(producer.publish(claim));
+
+  EXPECT_FALSE(consumer.get());
+  EXPECT_TRUE(consumer.skipAbandoned());
+  EXPECT_EQ(consumer.abandoned(), 1);
+  auto record = consumer.get();
+  ASSERT_TRUE(record);
+  EXPECT_EQ(record->pid, static_cast<uint32_t>(getpid()));
+  EXPECT_EQ(record->sequence, 2);
+}
+
+/**
+ * @given Existing segment
+ * @when Open it with other geometry
+ * @then Exception is thrown
+ */
+TEST_F(SinkToSharedMemoryTest, GeometryMismatch) {
+  SharedMemoryRing ring(segment_, 16, 64);
+  EXPECT_THROW(SharedMemoryRing(segment_, 32, 64), std::runtime_error);
+  EXPECT_NO_THROW(SharedMemoryRing(segment_, 16, 64));
+}
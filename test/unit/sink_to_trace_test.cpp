@@ -0,0 +1,180 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "soralog/impl/sink_to_trace.hpp"
+#include "soralog/scope_timer.hpp"
+
+using namespace soralog;
+using namespace testing;
+
+class SinkToTraceTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    std::string path(
+        (std::filesystem::temp_directory_path() / "soralog_test_XXXXXX")
+            .c_str());
+    if (mkstemp(path.data()) == -1) {
+      FAIL() << "Can't create output file for test";
+    }
+    path_ = std::filesystem::path(path);
+    rotated_path_ = path_;
+    rotated_path_ += ".1";
+  }
+  void TearDown() override {
+    std::remove(path_.native().data());
+    std::remove(rotated_path_.native().data());
+  }
+
+  static std::string read(const std::filesystem::path &path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+  }
+
+ protected:
+  std::filesystem::path path_;
+  std::filesystem::path rotated_path_;
+};
+
+/**
+ * @given Sink to trace file
+ * @when Push span markers, event of scope timer and usual events, one of
+ * which looks like span marker
+ * @then Events of span kind are written as begin, end and complete trace
+ * events of JSON array, others as instant events
+ */
+TEST_F(SinkToTraceTest, TraceEvents) {
+  {
+    SinkToTrace sink("trace", Level::TRACE, path_);
+    sink.push("logger",
+              Level::DEBUG,
+              spanFormat(SpanKind::BEGIN, FMT_COMPILE("{}{}")),
+              span_begin_prefix,
+              "request");
+    sink.push("logger",
+              Level::DEBUG,
+              spanFormat(SpanKind::COMPLETE,
+                         FMT_COMPILE("{} took {:.3f} ms"),
+                         std::chrono::microseconds(1500),
+                         7),
+              "parsing",
+              1.5);
+    sink.push("logger", Level::INFO, R"(say "hi"{})", '\n');
+    sink.push("logger", Level::INFO, "{}{}", span_end_prefix, "text");
+    sink.push("logger",
+              Level::DEBUG,
+              spanFormat(SpanKind::END, FMT_COMPILE("{}{}")),
+              span_end_prefix,
+              "request");
+  }
+
+  auto trace = read(path_);
+  EXPECT_EQ(trace.substr(0, 2), "[\n");
+  EXPECT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+
+  EXPECT_NE(trace.find(R"("name":"thread_name","ph":"M")"), std::string::npos);
+  EXPECT_NE(trace.find(R"("name":"request","ph":"B")"), std::string::npos);
+  EXPECT_NE(trace.find(R"("name":"request","ph":"E")"), std::string::npos);
+  EXPECT_NE(trace.find(R"("name":"parsing","ph":"X")"), std::string::npos);
+  EXPECT_NE(trace.find(R"("dur":1500.000)"), std::string::npos);
+  EXPECT_NE(trace.find(R"("name":"say \"hi\"\n","ph":"i")"),
+            std::string::npos)
+      << trace;
+  EXPECT_NE(trace.find(R"("name":"<<< text","ph":"i")"), std::string::npos);
+  EXPECT_NE(trace.find(R"("cat":"logger")"), std::string::npos);
+
+  // One record per line, separated by comma
+  size_t records = 0;
+  std::istringstream lines(trace.substr(2, trace.size() - 5));
+  std::string line;
+  while (std::getline(lines, line)) {
+    ++records;
+    EXPECT_EQ(line.front(), '{') << line;
+  }
+  EXPECT_EQ(records, 6);  // thread name + 5 events
+}
+
+/**
+ * @given Sink to trace file with written events
+ * @when File is moved and sink is rotated
+ * @then Both previous and new files are complete JSON arrays
+ */
+TEST_F(SinkToTraceTest, Rotate) {
+  {
+    SinkToTrace sink("trace", Level::TRACE, path_);
+    sink.push("logger", Level::INFO, "before");
+    sink.flush();
+
+    std::filesystem::rename(path_, rotated_path_);
+    sink.rotate();
+    sink.flush();
+
+    sink.push("logger", Level::INFO, "after");
+  }
+
+  auto before = read(rotated_path_);
+  EXPECT_EQ(before.substr(0, 2), "[\n");
+  EXPECT_EQ(before.substr(before.size() - 3), "\n]\n");
+  EXPECT_NE(before.find(R"("name":"before")"), std::string::npos);
+  EXPECT_EQ(before.find(R"("name":"after")"), std::string::npos);
+
+  auto after = read(path_);
+  EXPECT_EQ(after.substr(0, 2), "[\n");
+  EXPECT_EQ(after.substr(after.size() - 3), "\n]\n");
+  EXPECT_NE(after.find(R"("name":"after")"), std::string::npos);
+  // Track is named again in new file
+  EXPECT_NE(after.find(R"("name":"thread_name")"), std::string::npos);
+}
+
+/**
+ * @given Trace file written by previous sink
+ * @when New sink is opened at the same file, and it's rotated without moving
+ * of file
+ * @then Records of all of them are kept in one complete JSON array
+ */
+TEST_F(SinkToTraceTest, ContinueExistingFile) {
+  {
+    SinkToTrace sink("trace", Level::TRACE, path_);
+    sink.push("logger", Level::INFO, "first");
+  }
+  {
+    SinkToTrace sink("trace", Level::TRACE, path_);
+    sink.push("logger", Level::INFO, "second");
+    sink.flush();
+    sink.rotate();
+    sink.push("logger", Level::INFO, "third");
+  }
+
+  auto trace = read(path_);
+  EXPECT_EQ(trace.substr(0, 2), "[\n");
+  EXPECT_EQ(trace.substr(trace.size() - 3), "\n]\n");
+  EXPECT_EQ(trace.find('[', 1), std::string::npos) << trace;
+  EXPECT_EQ(trace.find(']'), trace.size() - 2) << trace;
+
+  auto first = trace.find(R"("name":"first")");
+  auto second = trace.find(R"("name":"second")");
+  auto third = trace.find(R"("name":"third")");
+  ASSERT_NE(first, std::string::npos) << trace;
+  ASSERT_NE(second, std::string::npos) << trace;
+  ASSERT_NE(third, std::string::npos) << trace;
+  EXPECT_LT(first, second);
+  EXPECT_LT(second, third);
+
+  // One record per line, separated by comma
+  std::istringstream lines(trace.substr(2, trace.size() - 5));
+  std::string line;
+  while (std::getline(lines, line)) {
+    EXPECT_EQ(line.front(), '{') << line;
+    EXPECT_TRUE(line.back() == ',' or lines.peek() == EOF) << line;
+  }
+}
@@ -0,0 +1,99 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Benchmark of rendering of event message.
+ * Event is constructed in place in storage with room for message, as queue
+ * of sink does, by the same message of precompiled format (as SL_* macros
+ * make), of runtime format (as SL_*_DF macros make), and of literal without
+ * arguments. Average time per event is printed for each kind of format.
+ *
+ * Usage: soralog_format_bench [<iterations>]
+ *  iterations  number of events of each kind (default: 3000000)
+ *
+ * Build it in Release mode to get meaningful numbers.
+ */
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string_view>
+
+#include <fmt/compile.h>
+#include <fmt/format.h>
+
+#include <soralog/event.hpp>
+#include <soralog/sink.hpp>
+
+namespace {
+
+  using soralog::Event;
+  using soralog::Level;
+  using ThreadInfoType = soralog::Sink::ThreadInfoType;
+
+  constexpr size_t max_message_length = 256;
+
+  // Storage of event with room for its message, like slot of queue
+  alignas(Event) std::array<char, sizeof(Event) + max_message_length> storage;
+
+  // Result of each event is accumulated, so rendering isn't optimized out
+  size_t checksum = 0;
+
+  template <typename Format, typename... Args>
+  void bench(std::string_view title,
+             size_t iterations,
+             const Format &format,
+             const Args &...args) {
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+      auto *event = new (storage.data()) Event("bench",
+                                               ThreadInfoType::NONE,
+                                               Level::INFO,
+                                               format,
+                                               max_message_length,
+                                               args...);
+      checksum += event->message().size() + event->message().back();
+      event->~Event();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const auto ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    std::cout << fmt::format("{:<10} {:>8.1f} ns/event\n",
+                             title,
+                             ns / static_cast<double>(iterations));
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t iterations = 3'000'000;
+  if (argc > 1) {
+    iterations = std::strtoull(argv[1], nullptr, 10);
+  }
+  if (iterations == 0) {
+    std::cerr << "Usage: " << argv[0] << " [<iterations>]\n";
+    return EXIT_FAILURE;
+  }
+
+  bench("compiled",
+        iterations,
+        FMT_COMPILE("Request {} from {} is done in {:.3f} ms"),
+        "GET /index.html",
+        "127.0.0.1",
+        1.5);
+  bench("runtime",
+        iterations,
+        std::string_view("Request {} from {} is done in {:.3f} ms"),
+        "GET /index.html",
+        "127.0.0.1",
+        1.5);
+  bench("literal", iterations, FMT_COMPILE("Connection closed"));
+
+  std::cout << "checksum: " << checksum << '\n';
+  return EXIT_SUCCESS;
+}
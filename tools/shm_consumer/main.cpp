@@ -0,0 +1,434 @@
+/**
+ * Copyright Soramitsu Co., 2021-2023
+ * Copyright Quadrivium Co., 2023
+ * All Rights Reserved
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Reference consumer of SinkToSharedMemory.
+ * It gets records from ring in shared memory segment and writes them as text
+ * lines (in the same layout like SinkToFile does) into file or stdout.
+ * Any I/O, compression or shipping might be done here, out of logging process.
+ *
+ * Several processes might use the same segment. In that case consumer works
+ * as collector: it writes single file, where records of all processes are
+ * merged in order of time. Records of concurrent producers are published
+ * slightly out of order, so they are kept in reorder window for some time
+ * before they are written.
+ *
+ * Each record has sequence number of event in its sink. Consumer tracks them
+ * for each process and reports gaps, so it's known exactly which events were
+ * lost (dropped by full ring or abandoned). Records of concurrent threads
+ * might be published slightly out of order, so number is reported as lost
+ * only when many records after it are got, or when consumer is stopped.
+ *
+ * Usage: soralog_shm_consumer [-p] [-s] [-w <window>] [-t <timeout>]
+ *                             <segment> [<path>]
+ *  -p  print id of process for each record
+ *  -s  print sequence number for each record
+ *  -w  reorder window in milliseconds; 0 disables reordering, so records
+ *      are written as soon as they are got (default: 100)
+ *  -t  how long captured but unpublished slot of live process is waited for,
+ *      before stall of ring is reported (default: 1000); slot of disappeared
+ *      process is skipped at once
+ *
+ *  SIGHUP reopens output file (for external rotation);
+ *  SIGINT and SIGTERM stop consumer after draining of ring.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <unistd.h>
+
+#include <soralog/shared_memory_ring.hpp>
+
+namespace {
+
+  using namespace std::chrono_literals;
+
+  // Buffered data is written when exceeds this size
+  constexpr size_t max_buffer_size = 1u << 20;
+
+  // Consumer polls ring with growing delay while it is empty
+  constexpr auto min_idle_delay = 1ms;
+  constexpr auto max_idle_delay = 50ms;
+
+  volatile std::sig_atomic_t need_to_stop = 0;
+  volatile std::sig_atomic_t need_to_reopen = 0;
+
+  void onSignal(int signal) {
+    if (signal == SIGHUP) {
+      need_to_reopen = 1;
+    } else {
+      need_to_stop = 1;
+    }
+  }
+
+  struct Options {
+    bool with_pid = false;
+    bool with_sequence = false;
+    std::chrono::milliseconds window = 100ms;
+    std::chrono::milliseconds stall_timeout = 1000ms;
+    const char *segment = nullptr;
+    const char *path = nullptr;
+  };
+
+  /**
+   * Rendered record waiting in reorder window
+   */
+  struct Line {
+    int64_t timestamp;
+    uint64_t arrival;
+    std::string text;
+
+    bool operator>(const Line &other) const {
+      return std::tie(timestamp, arrival)
+           > std::tie(other.timestamp, other.arrival);
+    }
+  };
+
+  /**
+   * Tracks sequence numbers of records of one process
+   */
+  class SequenceTracker {
+   public:
+    /// Number is considered as lost, if so many greater ones are got
+    static constexpr size_t max_reordered = 1024;
+
+    /**
+     * Accounts {@param sequence}; gaps which are known for sure are passed
+     * to {@param report} as first and last lost numbers
+     */
+    template <typename Report>
+    void add(uint64_t sequence, const Report &report) {
+      if (next_ == 0) {
+        next_ = sequence + 1;
+        return;
+      }
+      if (sequence < next_) {
+        // Sequence restarts if process with the same id is new one;
+        // otherwise it's late record preceding the first one got
+        if (next_ - sequence > max_reordered) {
+          next_ = sequence + 1;
+          ahead_.clear();
+        }
+        return;
+      }
+      if (sequence != next_) {
+        ahead_.insert(sequence);
+        if (ahead_.size() > max_reordered) {
+          skipGap(report);
+        }
+        return;
+      }
+      ++next_;
+      advance();
+    }
+
+    /**
+     * Reports all remaining gaps to {@param report}
+     */
+    template <typename Report>
+    void finish(const Report &report) {
+      while (not ahead_.empty()) {
+        skipGap(report);
+      }
+    }
+
+   private:
+    void advance() {
+      while (not ahead_.empty() and *ahead_.begin() == next_) {
+        ahead_.erase(ahead_.begin());
+        ++next_;
+      }
+    }
+
+    template <typename Report>
+    void skipGap(const Report &report) {
+      report(next_, *ahead_.begin() - 1);
+      next_ = *ahead_.begin();
+      advance();
+    }
+
+    // The least number which is not got yet; 0 if nothing is got
+    uint64_t next_ = 0;
+    // Got numbers greater than next_
+    std::set<uint64_t> ahead_;
+  };
+
+  template <typename Buffer>
+  void render(Buffer &buffer,
+              const soralog::SharedMemoryRing::RecordRef &record,
+              const Options &options) {
+    auto out = std::back_inserter(buffer);
+
+    const auto time = record->time().time_since_epoch();
+    const auto sec = std::chrono::duration_cast<std::chrono::seconds>(time);
+    const auto usec =
+        std::chrono::duration_cast<std::chrono::microseconds>(time - sec);
+    const auto tm = fmt::localtime(static_cast<std::time_t>(sec.count()));
+    fmt::format_to(out,
+                   "{:0>2}.{:0>2}.{:0>2} {:0>2}:{:0>2}:{:0>2}.{:0>6}  ",
+                   tm.tm_year % 100,
+                   tm.tm_mon + 1,
+                   tm.tm_mday,
+                   tm.tm_hour,
+                   tm.tm_min,
+                   tm.tm_sec,
+                   usec.count());
+
+    if (options.with_pid) {
+      fmt::format_to(out, "P:{:<7}  ", record->pid);
+    }
+
+    if (options.with_sequence) {
+      fmt::format_to(out, "#{:<8}  ", record->sequence);
+    }
+
+    if (not record->threadName().empty()) {
+      fmt::format_to(out, "{:<15}  ", record->threadName());
+    } else if (record->thread_number != 0) {
+      fmt::format_to(out, "T:{:<6}  ", record->thread_number);
+    }
+
+    auto level = std::min(record->level, soralog::Level::IGNORE);
+    fmt::format_to(out,
+                   "{:<8}  {}  {}\n",
+                   soralog::levelToStr(level),
+                   record->loggerName(),
+                   record.message());
+  }
+
+  FILE *openOutput(const char *path) {
+    if (path == nullptr) {
+      return stdout;
+    }
+    auto *file = std::fopen(path, "a");
+    if (file == nullptr) {
+      std::cerr << "Can't open output file '" << path
+                << "': " << std::strerror(errno) << '\n';
+    }
+    return file;
+  }
+
+  bool parseOptions(int argc, char **argv, Options &options) {
+    int opt = 0;
+    while ((opt = ::getopt(argc, argv, "psw:t:")) != -1) {
+      switch (opt) {
+        case 'p':
+          options.with_pid = true;
+          break;
+        case 's':
+          options.with_sequence = true;
+          break;
+        case 'w':
+          options.window = std::chrono::milliseconds(std::atoi(optarg));
+          break;
+        case 't':
+          options.stall_timeout = std::chrono::milliseconds(std::atoi(optarg));
+          break;
+        default:
+          return false;
+      }
+    }
+    if (argc - optind < 1 or argc - optind > 2) {
+      return false;
+    }
+    options.segment = argv[optind];
+    options.path = argc - optind > 1 ? argv[optind + 1] : nullptr;
+    return true;
+  }
+
+  /**
+   * Attaches to segment. Waits for its appearance, because collector might
+   * be started before any logging process
+   */
+  std::unique_ptr<soralog::SharedMemoryRing> attach(const char *segment) {
+    bool reported = false;
+    while (need_to_stop == 0) {
+      try {
+        return std::make_unique<soralog::SharedMemoryRing>(segment);
+      } catch (const std::system_error &exception) {
+        if (exception.code() != std::errc::no_such_file_or_directory) {
+          std::cerr << exception.what() << '\n';
+          return nullptr;
+        }
+        if (not reported) {
+          std::cerr << "Waiting for segment '" << segment << "'...\n";
+          reported = true;
+        }
+      } catch (const std::exception &exception) {
+        std::cerr << exception.what() << '\n';
+        return nullptr;
+      }
+      std::this_thread::sleep_for(100ms);
+    }
+    return nullptr;
+  }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  Options options;
+  if (not parseOptions(argc, argv, options)) {
+    std::cerr << "Usage: " << argv[0]
+              << " [-p] [-s] [-w <window>] [-t <timeout>] <segment> [<path>]\n";
+    return EXIT_FAILURE;
+  }
+
+  std::signal(SIGINT, onSignal);
+  std::signal(SIGTERM, onSignal);
+  std::signal(SIGHUP, onSignal);
+
+  auto ring = attach(options.segment);
+  if (not ring) {
+    return need_to_stop != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+  }
+
+  auto *out = openOutput(options.path);
+  if (out == nullptr) {
+    return EXIT_FAILURE;
+  }
+
+  const bool reorder = options.window != 0ms;
+  std::priority_queue<Line, std::vector<Line>, std::greater<>> window;
+  uint64_t arrival = 0;
+
+  fmt::memory_buffer buffer;
+  std::map<uint32_t, SequenceTracker> sequences;
+  uint32_t pid = 0;
+  auto report_lost = [&](uint64_t first, uint64_t last) {
+    fmt::format_to(std::back_inserter(buffer),
+                   "*** {} records of process {} were lost: #{}..#{}\n",
+                   last - first + 1,
+                   pid,
+                   first,
+                   last);
+  };
+
+  auto dropped = ring->dropped();
+  auto abandoned = ring->abandoned();
+  auto idle_delay = min_idle_delay;
+  bool stall_reported = false;
+
+  while (true) {
+    size_t count = 0;
+    while (true) {
+      auto record = ring->get();
+      if (not record) {
+        // Slot might be stalled by disappeared process
+        if (ring->skipAbandoned()) {
+          stall_reported = false;
+          continue;
+        }
+        // Slot of live process can't be skipped, just report it once
+        auto owner = ring->stalledBy(options.stall_timeout);
+        if (owner and not stall_reported) {
+          fmt::format_to(std::back_inserter(buffer),
+                         "*** Ring is stalled: process {} doesn't publish "
+                         "captured record\n",
+                         *owner);
+          stall_reported = true;
+        }
+        break;
+      }
+      ++count;
+      stall_reported = false;
+
+      pid = record->pid;
+      sequences[pid].add(record->sequence, report_lost);
+
+      if (reorder) {
+        Line line{record->timestamp, arrival++, {}};
+        render(line.text, record, options);
+        window.emplace(std::move(line));
+      } else {
+        render(buffer, record, options);
+        if (buffer.size() >= max_buffer_size) {
+          std::fwrite(buffer.data(), 1, buffer.size(), out);
+          buffer.clear();
+        }
+      }
+    }
+
+    // Lines older than window are not expected to be preceded by new ones
+    const auto edge = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          (std::chrono::system_clock::now() - options.window)
+                              .time_since_epoch())
+                          .count();
+    while (not window.empty()
+           and (window.top().timestamp <= edge or need_to_stop != 0)) {
+      const auto &text = window.top().text;
+      buffer.append(text.data(), text.data() + text.size());
+      window.pop();
+    }
+
+    if (auto current = ring->dropped(); current != dropped) {
+      fmt::format_to(std::back_inserter(buffer),
+                     "*** {} records were dropped: ring is full\n",
+                     current - dropped);
+      dropped = current;
+    }
+    if (auto current = ring->abandoned(); current != abandoned) {
+      fmt::format_to(std::back_inserter(buffer),
+                     "*** {} records were lost: producer has disappeared\n",
+                     current - abandoned);
+      abandoned = current;
+    }
+
+    if (buffer.size() != 0) {
+      std::fwrite(buffer.data(), 1, buffer.size(), out);
+      buffer.clear();
+      std::fflush(out);
+    }
+
+    if (need_to_reopen != 0 and options.path != nullptr) {
+      need_to_reopen = 0;
+      if (auto *file = openOutput(options.path)) {
+        std::fclose(out);
+        out = file;
+      }
+    }
+
+    if (count != 0) {
+      idle_delay = min_idle_delay;
+      continue;
+    }
+    if (need_to_stop != 0 and window.empty()) {
+      for (auto &[process, tracker] : sequences) {
+        pid = process;
+        tracker.finish(report_lost);
+      }
+      if (buffer.size() != 0) {
+        std::fwrite(buffer.data(), 1, buffer.size(), out);
+      }
+      break;
+    }
+    std::this_thread::sleep_for(idle_delay);
+    idle_delay = std::min<std::chrono::milliseconds>(idle_delay * 2,
+                                                      max_idle_delay);
+  }
+
+  if (out != stdout) {
+    std::fclose(out);
+  }
+  return EXIT_SUCCESS;
+}